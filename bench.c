@@ -0,0 +1,216 @@
+#include "bench.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Peak memory queries (raylib is not included here, its names clash with windows.h)
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+// Order statistics of one series of timings
+typedef struct {
+    float minimum;
+    float average;
+    float p50;
+    float p90;
+    float p99;
+    float maximum;
+} BenchStats;
+
+// Function to get the settings of a plain --bench run
+BenchSettings GetDefaultBenchSettings(void) {
+    BenchSettings settings = {0};
+    settings.enabled = false;
+    settings.frames = BENCH_DEFAULT_FRAMES;
+    settings.warmupFrames = BENCH_WARMUP_FRAMES;
+    settings.units = BENCH_DEFAULT_UNITS;
+    settings.outputPath = BENCH_DEFAULT_OUTPUT;
+    settings.hidden = false;
+    return settings;
+}
+
+// Function to allocate the per-frame timing arrays
+Benchmark LoadBenchmark(BenchSettings settings) {
+    Benchmark bench = {0};
+    if (settings.frames < 1) settings.frames = 1;
+    bench.settings = settings;
+
+    bench.frameTimes = (float *)malloc(sizeof(float) * settings.frames);
+    bench.zoneTimes = (float *)malloc(sizeof(float) * settings.frames * PROFILE_ZONE_COUNT);
+    if (bench.frameTimes == NULL || bench.zoneTimes == NULL) {
+        printf("Failed to allocate benchmark for %d frames\n", settings.frames);
+        free(bench.frameTimes);
+        free(bench.zoneTimes);
+        bench.frameTimes = NULL;
+        bench.zoneTimes = NULL;
+        bench.settings.frames = 0;
+    }
+
+    return bench;
+}
+
+// Function to free the timing arrays
+void UnloadBenchmark(Benchmark *bench) {
+    free(bench->frameTimes);
+    free(bench->zoneTimes);
+    bench->frameTimes = NULL;
+    bench->zoneTimes = NULL;
+}
+
+// Function to record the profiler's last frame
+void RecordBenchmarkFrame(Benchmark *bench) {
+    if (IsBenchmarkRecording(bench) && bench->recorded < bench->settings.frames) {
+        bench->frameTimes[bench->recorded] = GetProfileFrameTime();
+        for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+            bench->zoneTimes[bench->recorded * PROFILE_ZONE_COUNT + zone] = GetProfileZoneTime((ProfileZone)zone);
+        }
+        bench->recorded++;
+    }
+    bench->frame++;
+}
+
+// Function to check whether frames are recorded yet
+bool IsBenchmarkRecording(const Benchmark *bench) {
+    return bench->frame >= bench->settings.warmupFrames;
+}
+
+// Function to check whether every frame was recorded
+bool IsBenchmarkDone(const Benchmark *bench) {
+    return bench->recorded >= bench->settings.frames;
+}
+
+static int CompareFloats(const void *a, const void *b) {
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Function to compute statistics of count values taken every stride floats
+static BenchStats GetBenchStats(const float *values, int count, int stride) {
+    BenchStats stats = {0};
+    if (count == 0) return stats;
+
+    float *sorted = (float *)malloc(sizeof(float) * count);
+    if (sorted == NULL) return stats;
+
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        sorted[i] = values[(size_t)i * stride];
+        sum += sorted[i];
+    }
+    qsort(sorted, count, sizeof(float), CompareFloats);
+
+    stats.minimum = sorted[0];
+    stats.average = (float)(sum / count);
+    stats.p50 = sorted[(int)(0.50f * (count - 1) + 0.5f)];
+    stats.p90 = sorted[(int)(0.90f * (count - 1) + 0.5f)];
+    stats.p99 = sorted[(int)(0.99f * (count - 1) + 0.5f)];
+    stats.maximum = sorted[count - 1];
+
+    free(sorted);
+    return stats;
+}
+
+// Function to write statistics as a JSON object
+static void WriteBenchStats(FILE *file, BenchStats stats) {
+    fprintf(file, "{\"min\": %.3f, \"avg\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}",
+            stats.minimum, stats.average, stats.p50, stats.p90, stats.p99, stats.maximum);
+}
+
+// Function to turn a zone name into a JSON key ("Draw 3D" -> "draw_3d")
+static void GetBenchZoneKey(ProfileZone zone, char *key, int size) {
+    const char *name = GetProfileZoneName(zone);
+    int length = 0;
+
+    for (; name[length] != '\0' && length < size - 1; length++) {
+        key[length] = (name[length] == ' ') ? '_' : (char)tolower((unsigned char)name[length]);
+    }
+    key[length] = '\0';
+}
+
+// Function to write a string as a JSON string literal
+static void WriteBenchString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (; *text != '\0'; text++) {
+        if (*text == '"' || *text == '\\') fputc('\\', file);
+        if ((unsigned char)*text >= 0x20) fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+// Function to get the peak resident memory of the process in kilobytes (-1 when unknown)
+static long long GetPeakMemoryKB(void) {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return (long long)(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+    return (long long)usage.ru_maxrss / 1024;  // Bytes on macOS
+#else
+    return (long long)usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Function to write the report
+bool SaveBenchmarkReport(const Benchmark *bench, const BenchReport *report) {
+    FILE *file = fopen(bench->settings.outputPath, "w");
+    if (file == NULL) {
+        printf("Failed to write benchmark report: %s\n", bench->settings.outputPath);
+        return false;
+    }
+
+    int count = bench->recorded;
+    double totalMs = 0.0;
+    for (int i = 0; i < count; i++) totalMs += bench->frameTimes[i];
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"model\": ");
+    WriteBenchString(file, report->modelPath);
+    fprintf(file, ",\n");
+    fprintf(file, "  \"frames\": %d,\n", count);
+    fprintf(file, "  \"warmup_frames\": %d,\n", bench->settings.warmupFrames);
+    fprintf(file, "  \"timestep_ms\": %.3f,\n", BENCH_TIMESTEP * 1000.0f);
+    fprintf(file, "  \"units\": %d,\n", report->unitCount);
+    fprintf(file, "  \"worker_threads\": %d,\n", report->threadCount);
+    fprintf(file, "  \"meshes\": %d,\n", report->meshCount);
+    fprintf(file, "  \"triangles\": %d,\n", report->triangleCount);
+    fprintf(file, "  \"total_seconds\": %.3f,\n", totalMs / 1000.0);
+    fprintf(file, "  \"average_fps\": %.1f,\n", (totalMs > 0.0) ? count * 1000.0 / totalMs : 0.0);
+
+    fprintf(file, "  \"frame_ms\": ");
+    WriteBenchStats(file, GetBenchStats(bench->frameTimes, count, 1));
+    fprintf(file, ",\n");
+
+    // Worker zones are summed over all job threads, like in the profiler overlay
+    fprintf(file, "  \"zones_ms\": {\n");
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        char key[32];
+        GetBenchZoneKey((ProfileZone)zone, key, sizeof(key));
+        fprintf(file, "    \"%s\": ", key);
+        WriteBenchStats(file, GetBenchStats(bench->zoneTimes + zone, count, PROFILE_ZONE_COUNT));
+        fprintf(file, (zone + 1 < PROFILE_ZONE_COUNT) ? ",\n" : "\n");
+    }
+    fprintf(file, "  },\n");
+
+    long long totalRays = report->avoidanceRays + report->groundRays + report->pickingRays;
+    fprintf(file, "  \"ray_queries\": {\"avoidance\": %lld, \"ground\": %lld, \"picking\": %lld, \"total\": %lld, \"per_frame\": %.1f},\n",
+            report->avoidanceRays, report->groundRays, report->pickingRays, totalRays,
+            (count > 0) ? (double)totalRays / count : 0.0);
+    fprintf(file, "  \"peak_memory_kb\": %lld\n", GetPeakMemoryKB());
+    fprintf(file, "}\n");
+
+    bool ok = (fclose(file) == 0);
+    if (ok) printf("Saved benchmark report: %s (%d frames)\n", bench->settings.outputPath, count);
+
+    return ok;
+}
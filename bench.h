@@ -0,0 +1,69 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+
+// Benchmark settings
+#define BENCH_DEFAULT_FRAMES 1000          // Recorded frames, after the warm-up
+#define BENCH_DEFAULT_UNITS 1000
+#define BENCH_DEFAULT_OUTPUT "bench.json"
+#define BENCH_WARMUP_FRAMES 60             // Run but not recorded (LOD upload, first draws), replays record every frame
+#define BENCH_TIMESTEP (1.0f / 60.0f)      // Simulation step of every frame, independent of the frame time
+#define BENCH_RANDOM_SEED 1234
+
+// Benchmark scenario, all in frames from the start of the run
+#define BENCH_CAMERA_ORBIT_FRAMES 600      // One full turn of the camera around the model
+#define BENCH_CAMERA_ZOOM_FRAMES 400       // One zoom in and out cycle
+#define BENCH_CAMERA_ZOOM_RANGE 0.5f       // Distance varies by this fraction of the start distance
+#define BENCH_COMMAND_INTERVAL 120         // Every unit is sent to a new point this often
+#define BENCH_COMMAND_POINTS 5             // Screen points the commands cycle through
+
+// Command line options of a benchmark run
+typedef struct {
+    bool enabled;
+    int frames;
+    int warmupFrames;          // Run before the recorded ones
+    int units;
+    const char *outputPath;
+    bool hidden;               // Run with a hidden window
+} BenchSettings;
+
+// Frame timings recorded during a run
+typedef struct {
+    BenchSettings settings;
+    int frame;                 // Frames run so far, including the warm-up
+    int recorded;
+    float *frameTimes;         // Milliseconds, one per recorded frame
+    float *zoneTimes;          // PROFILE_ZONE_COUNT per recorded frame
+} Benchmark;
+
+// Scene and query totals written next to the timings
+typedef struct {
+    const char *modelPath;
+    int unitCount;
+    int threadCount;
+    int meshCount;
+    int triangleCount;
+    long long avoidanceRays;   // Counted over the recorded frames only
+    long long groundRays;
+    long long pickingRays;
+} BenchReport;
+
+// Default settings, before the command line is read
+BenchSettings GetDefaultBenchSettings(void);
+
+// Allocate the timing arrays of a run
+Benchmark LoadBenchmark(BenchSettings settings);
+void UnloadBenchmark(Benchmark *bench);
+
+// Count a finished frame, its profiler zones are recorded once the warm-up is over
+void RecordBenchmarkFrame(Benchmark *bench);
+
+// Whether the warm-up is over and frames are being recorded
+bool IsBenchmarkRecording(const Benchmark *bench);
+bool IsBenchmarkDone(const Benchmark *bench);
+
+// Write frame time percentiles, per-zone times, ray counts and peak memory as JSON
+bool SaveBenchmarkReport(const Benchmark *bench, const BenchReport *report);
+
+#endif // BENCH_H
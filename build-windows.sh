@@ -4,6 +4,7 @@
 MINGW64="x86_64-w64-mingw32-gcc"
 RAYLIB_VERSION="5.5"
 RAYLIB_DIR="lib/windows/raylib-${RAYLIB_VERSION}_win64_mingw-w64"
+SOURCES="main.c collision.c raykernel.c heightfield.c spatialgrid.c unitpool.c jobs.c unitrender.c frustum.c modelloader.c scenecache.c meshlod.c profiler.c bench.c flowfield.c meshbatch.c meshopt.c gltfdecode.c texturestream.c frameinput.c tilescene.c"
 
 # Download RayLib if needed
 if [ ! -d "$RAYLIB_DIR" ]; then
@@ -17,11 +18,11 @@ fi
 
 # Build
 echo "Building Windows executable..."
-$MINGW64 main.c -o gltf-viewer.exe \
+$MINGW64 $SOURCES -o gltf-viewer.exe \
     -Wall -Wextra -O2 -std=c99 \
     -I${RAYLIB_DIR}/include \
     -L${RAYLIB_DIR}/lib \
-    -lraylib -lopengl32 -lgdi32 -lwinmm \
+    -lraylib -lopengl32 -lgdi32 -lwinmm -lpthread \
     -static
 
 if [ -f "gltf-viewer.exe" ]; then
@@ -0,0 +1,932 @@
+#include "collision.h"
+#include "raykernel.h"
+#include <raymath.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+
+// Per-triangle data used only while building the BVH
+typedef struct {
+    Vector3 min;
+    Vector3 max;
+    Vector3 centroid;
+} BuildTriangle;
+
+// State shared by the recursive BVH build
+typedef struct {
+    BVHNode *nodes;
+    int nodeCount;
+    int *order;                // Model-wide triangle indices, permuted into leaf order
+    BuildTriangle *tris;
+} BVHBuilder;
+
+// Function to read the three vertices of a mesh triangle (indexed or non-indexed)
+static void GetMeshTriangle(Mesh mesh, int t, Vector3 *v0, Vector3 *v1, Vector3 *v2) {
+    int idx0 = t * 3 + 0;
+    int idx1 = t * 3 + 1;
+    int idx2 = t * 3 + 2;
+
+    if (mesh.indices != NULL) {
+        idx0 = mesh.indices[idx0];
+        idx1 = mesh.indices[idx1];
+        idx2 = mesh.indices[idx2];
+    }
+
+    *v0 = (Vector3){ mesh.vertices[idx0 * 3 + 0], mesh.vertices[idx0 * 3 + 1], mesh.vertices[idx0 * 3 + 2] };
+    *v1 = (Vector3){ mesh.vertices[idx1 * 3 + 0], mesh.vertices[idx1 * 3 + 1], mesh.vertices[idx1 * 3 + 2] };
+    *v2 = (Vector3){ mesh.vertices[idx2 * 3 + 0], mesh.vertices[idx2 * 3 + 1], mesh.vertices[idx2 * 3 + 2] };
+}
+
+static float GetVectorAxis(Vector3 v, int axis) {
+    return (axis == 0) ? v.x : (axis == 1) ? v.y : v.z;
+}
+
+// Half surface area of a box, the SAH only needs relative values
+static float GetBoxHalfArea(Vector3 min, Vector3 max) {
+    Vector3 e = Vector3Subtract(max, min);
+    if (e.x < 0 || e.y < 0 || e.z < 0) return 0.0f;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+static void SwapBuildEntries(BVHBuilder *b, int i, int j) {
+    int index = b->order[i];
+    b->order[i] = b->order[j];
+    b->order[j] = index;
+
+    BuildTriangle tri = b->tris[i];
+    b->tris[i] = b->tris[j];
+    b->tris[j] = tri;
+}
+
+// Function to place the k-th smallest centroid (on an axis) at index k (quickselect)
+static void SelectMedian(BVHBuilder *b, int first, int last, int k, int axis) {
+    while (first < last) {
+        float pivot = GetVectorAxis(b->tris[(first + last) / 2].centroid, axis);
+        int i = first;
+        int j = last;
+
+        while (i <= j) {
+            while (GetVectorAxis(b->tris[i].centroid, axis) < pivot) i++;
+            while (GetVectorAxis(b->tris[j].centroid, axis) > pivot) j--;
+            if (i <= j) {
+                SwapBuildEntries(b, i, j);
+                i++;
+                j--;
+            }
+        }
+
+        if (k <= j) last = j;
+        else if (k >= i) first = i;
+        else return;
+    }
+}
+
+// Function to recursively build a subtree, returns the node index
+static int BuildBVHNode(BVHBuilder *b, int first, int count, int depth) {
+    int nodeIndex = b->nodeCount++;
+    BVHNode *node = &b->nodes[nodeIndex];
+
+    // Bounds of the triangles and of their centroids
+    Vector3 boundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vector3 boundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    Vector3 centroidMin = boundsMin;
+    Vector3 centroidMax = boundsMax;
+
+    for (int i = first; i < first + count; i++) {
+        boundsMin = Vector3Min(boundsMin, b->tris[i].min);
+        boundsMax = Vector3Max(boundsMax, b->tris[i].max);
+        centroidMin = Vector3Min(centroidMin, b->tris[i].centroid);
+        centroidMax = Vector3Max(centroidMax, b->tris[i].centroid);
+    }
+
+    // Pad the stored box so rays running exactly along a face (flat ground edges) are not culled
+    float extent = fmaxf(Vector3Length(boundsMin), Vector3Length(boundsMax));
+    float pad = BVH_BOUNDS_EPSILON * fmaxf(extent, 1.0f);
+    node->min[0] = boundsMin.x - pad; node->min[1] = boundsMin.y - pad; node->min[2] = boundsMin.z - pad;
+    node->max[0] = boundsMax.x + pad; node->max[1] = boundsMax.y + pad; node->max[2] = boundsMax.z + pad;
+    node->rightOrFirst = first;
+    node->count = count;
+
+    if (count <= 2) return nodeIndex;
+
+    // Evaluate binned SAH splits on every axis
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    int bestSplit = 0;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float cmin = GetVectorAxis(centroidMin, axis);
+        float cmax = GetVectorAxis(centroidMax, axis);
+        if (cmax - cmin <= 0.0f) continue;
+
+        int binCount[BVH_SAH_BINS] = {0};
+        Vector3 binMin[BVH_SAH_BINS];
+        Vector3 binMax[BVH_SAH_BINS];
+        for (int i = 0; i < BVH_SAH_BINS; i++) {
+            binMin[i] = (Vector3){ FLT_MAX, FLT_MAX, FLT_MAX };
+            binMax[i] = (Vector3){ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        }
+
+        float scale = BVH_SAH_BINS / (cmax - cmin);
+        for (int i = first; i < first + count; i++) {
+            int bin = (int)((GetVectorAxis(b->tris[i].centroid, axis) - cmin) * scale);
+            if (bin >= BVH_SAH_BINS) bin = BVH_SAH_BINS - 1;
+            binCount[bin]++;
+            binMin[bin] = Vector3Min(binMin[bin], b->tris[i].min);
+            binMax[bin] = Vector3Max(binMax[bin], b->tris[i].max);
+        }
+
+        // Sweep from the right to get the cost of every right partition
+        float rightArea[BVH_SAH_BINS];
+        int rightCount[BVH_SAH_BINS];
+        Vector3 sweepMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Vector3 sweepMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        int sweepCount = 0;
+        for (int i = BVH_SAH_BINS - 1; i > 0; i--) {
+            sweepMin = Vector3Min(sweepMin, binMin[i]);
+            sweepMax = Vector3Max(sweepMax, binMax[i]);
+            sweepCount += binCount[i];
+            rightArea[i] = GetBoxHalfArea(sweepMin, sweepMax);
+            rightCount[i] = sweepCount;
+        }
+
+        // Sweep from the left and combine
+        sweepMin = (Vector3){ FLT_MAX, FLT_MAX, FLT_MAX };
+        sweepMax = (Vector3){ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        sweepCount = 0;
+        for (int i = 0; i < BVH_SAH_BINS - 1; i++) {
+            sweepMin = Vector3Min(sweepMin, binMin[i]);
+            sweepMax = Vector3Max(sweepMax, binMax[i]);
+            sweepCount += binCount[i];
+            if (sweepCount == 0 || rightCount[i + 1] == 0) continue;
+
+            float cost = GetBoxHalfArea(sweepMin, sweepMax) * sweepCount + rightArea[i + 1] * rightCount[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i + 1;
+            }
+        }
+    }
+
+    // Compare against the cost of keeping everything in a leaf
+    float parentArea = GetBoxHalfArea(boundsMin, boundsMax);
+    float leafCost = (float)count;
+    float splitCost = (parentArea > 0.0f) ? 1.0f + bestCost / parentArea : FLT_MAX;
+
+    if (bestAxis < 0 && count <= BVH_MAX_LEAF_TRIANGLES) return nodeIndex;
+    if (splitCost >= leafCost && count <= BVH_MAX_LEAF_TRIANGLES) return nodeIndex;
+
+    int mid;
+    if (bestAxis >= 0 && depth < BVH_MAX_SAH_DEPTH) {
+        // Partition around the chosen bin boundary
+        float cmin = GetVectorAxis(centroidMin, bestAxis);
+        float scale = BVH_SAH_BINS / (GetVectorAxis(centroidMax, bestAxis) - cmin);
+        int i = first;
+        int j = first + count - 1;
+
+        while (i <= j) {
+            int bin = (int)((GetVectorAxis(b->tris[i].centroid, bestAxis) - cmin) * scale);
+            if (bin >= BVH_SAH_BINS) bin = BVH_SAH_BINS - 1;
+
+            if (bin < bestSplit) {
+                i++;
+            } else {
+                SwapBuildEntries(b, i, j);
+                j--;
+            }
+        }
+        mid = i;
+    } else {
+        // Too deep or all centroids coincide: median split on the widest centroid axis
+        Vector3 extent = Vector3Subtract(centroidMax, centroidMin);
+        int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z) ? 1 : 2;
+        mid = first + count / 2;
+        SelectMedian(b, first, first + count - 1, mid, axis);
+    }
+
+    if (mid == first || mid == first + count) mid = first + count / 2;
+
+    // Left child directly follows this node, right child index is stored
+    BuildBVHNode(b, first, mid - first, depth + 1);
+    int right = BuildBVHNode(b, mid, first + count - mid, depth + 1);
+
+    node = &b->nodes[nodeIndex];
+    node->rightOrFirst = right;
+    node->count = 0;
+
+    return nodeIndex;
+}
+
+// Function to get the number of triangles each soup array holds, including kernel padding
+static size_t GetPaddedSoupCount(int count) {
+    size_t padded = ((size_t)count + RAYKERNEL_MAX_WIDTH - 1) / RAYKERNEL_MAX_WIDTH * RAYKERNEL_MAX_WIDTH;
+    return (padded == 0) ? RAYKERNEL_MAX_WIDTH : padded;
+}
+
+// Function to get the size of the single allocation backing a soup
+size_t GetTriangleSoupBufferSize(int count) {
+    size_t padded = GetPaddedSoupCount(count);
+    return (sizeof(float) * 9 + sizeof(int) * 2) * padded;
+}
+
+// Function to allocate a soup with every array carved from one buffer
+// Each array is padded with zero (degenerate) triangles for full-width kernel loads
+bool AllocTriangleSoup(TriangleSoup *soup, int count) {
+    size_t padded = GetPaddedSoupCount(count);
+
+    size_t floatBytes = sizeof(float) * padded;
+    size_t intBytes = sizeof(int) * padded;
+    unsigned char *buffer = (unsigned char *)calloc(1, GetTriangleSoupBufferSize(count));
+
+    memset(soup, 0, sizeof(*soup));
+    if (buffer == NULL) return false;
+
+    float **floatArrays[9] = {
+        &soup->v0x, &soup->v0y, &soup->v0z,
+        &soup->e1x, &soup->e1y, &soup->e1z,
+        &soup->e2x, &soup->e2y, &soup->e2z
+    };
+    for (int i = 0; i < 9; i++) *floatArrays[i] = (float *)(buffer + floatBytes * i);
+
+    soup->meshIndex = (int *)(buffer + floatBytes * 9);
+    soup->triangleIndex = (int *)(buffer + floatBytes * 9 + intBytes);
+    soup->count = count;
+    soup->buffer = buffer;
+
+    return true;
+}
+
+static void UnloadTriangleSoup(TriangleSoup *soup) {
+    free(soup->buffer);
+    memset(soup, 0, sizeof(*soup));
+}
+
+static void SetSoupTriangle(TriangleSoup *soup, int i, Vector3 v0, Vector3 v1, Vector3 v2, int meshIndex, int triangleIndex) {
+    soup->v0x[i] = v0.x; soup->v0y[i] = v0.y; soup->v0z[i] = v0.z;
+    soup->e1x[i] = v1.x - v0.x; soup->e1y[i] = v1.y - v0.y; soup->e1z[i] = v1.z - v0.z;
+    soup->e2x[i] = v2.x - v0.x; soup->e2y[i] = v2.y - v0.y; soup->e2z[i] = v2.z - v0.z;
+    soup->meshIndex[i] = meshIndex;
+    soup->triangleIndex[i] = triangleIndex;
+}
+
+// Function to compute per-mesh metadata in world space
+ModelInfo LoadModelInfo(Model model) {
+    ModelInfo info = {0};
+
+    info.meshes = (MeshInfo *)calloc((model.meshCount > 0) ? model.meshCount : 1, sizeof(MeshInfo));
+    if (info.meshes == NULL) return info;
+    info.meshCount = model.meshCount;
+
+    bool hasBounds = false;
+    for (int i = 0; i < model.meshCount; i++) {
+        Mesh mesh = model.meshes[i];
+        MeshInfo *meshInfo = &info.meshes[i];
+
+        meshInfo->vertexCount = mesh.vertexCount;
+        meshInfo->triangleOffset = info.totalTriangles;
+        info.totalVertices += mesh.vertexCount;
+
+        // Meshes without CPU-side positions cannot be ray tested
+        if (mesh.vertices == NULL || mesh.vertexCount == 0) continue;
+
+        meshInfo->triangleCount = mesh.triangleCount;
+        info.totalTriangles += mesh.triangleCount;
+
+        Vector3 minVertex = Vector3Transform((Vector3){ mesh.vertices[0], mesh.vertices[1], mesh.vertices[2] }, model.transform);
+        Vector3 maxVertex = minVertex;
+        for (int v = 1; v < mesh.vertexCount; v++) {
+            Vector3 p = { mesh.vertices[v * 3 + 0], mesh.vertices[v * 3 + 1], mesh.vertices[v * 3 + 2] };
+            p = Vector3Transform(p, model.transform);
+            minVertex = Vector3Min(minVertex, p);
+            maxVertex = Vector3Max(maxVertex, p);
+        }
+        meshInfo->bounds = (BoundingBox){ minVertex, maxVertex };
+
+        if (!hasBounds) {
+            info.bounds = meshInfo->bounds;
+            hasBounds = true;
+        } else {
+            info.bounds.min = Vector3Min(info.bounds.min, minVertex);
+            info.bounds.max = Vector3Max(info.bounds.max, maxVertex);
+        }
+    }
+
+    return info;
+}
+
+// Function to release model metadata
+void UnloadModelInfo(ModelInfo *info) {
+    free(info->meshes);
+    memset(info, 0, sizeof(*info));
+}
+
+// Function to find the mesh owning a model-wide triangle index
+// Meshes without triangles share the next mesh's offset, so the last mesh starting at or before it is the owner
+static int FindTriangleMesh(const ModelInfo *info, int triangle) {
+    int low = 0;
+    int high = info->meshCount - 1;
+
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (info->meshes[mid].triangleOffset <= triangle) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+// Function to read a mesh triangle in world space
+static void GetWorldTriangle(Model model, int meshIndex, int t, Vector3 *v0, Vector3 *v1, Vector3 *v2) {
+    GetMeshTriangle(model.meshes[meshIndex], t, v0, v1, v2);
+    *v0 = Vector3Transform(*v0, model.transform);
+    *v1 = Vector3Transform(*v1, model.transform);
+    *v2 = Vector3Transform(*v2, model.transform);
+}
+
+// Function to build the acceleration structure for a model
+ModelCollision LoadModelCollision(Model model) {
+    ModelCollision collision = {0};
+    collision.transform = model.transform;
+    collision.info = LoadModelInfo(model);
+
+    int count = collision.info.totalTriangles;
+    if (count == 0) return collision;
+
+    BVHBuilder builder = {0};
+    builder.nodes = (BVHNode *)malloc(sizeof(BVHNode) * (2 * count));
+    builder.order = (int *)malloc(sizeof(int) * count);
+    builder.tris = (BuildTriangle *)malloc(sizeof(BuildTriangle) * count);
+
+    if (builder.nodes == NULL || builder.order == NULL || builder.tris == NULL ||
+        !AllocTriangleSoup(&collision.soup, count)) {
+        printf("Failed to allocate BVH for %d triangles\n", count);
+        free(builder.nodes);
+        free(builder.order);
+        free(builder.tris);
+        return collision;
+    }
+
+    // Gather triangle bounds and centroids straight from the meshes, no intermediate soup is kept
+    for (int m = 0; m < collision.info.meshCount; m++) {
+        int offset = collision.info.meshes[m].triangleOffset;
+
+        for (int t = 0; t < collision.info.meshes[m].triangleCount; t++) {
+            Vector3 v0, v1, v2;
+            GetWorldTriangle(model, m, t, &v0, &v1, &v2);
+
+            int i = offset + t;
+            builder.order[i] = i;
+            builder.tris[i].min = Vector3Min(v0, Vector3Min(v1, v2));
+            builder.tris[i].max = Vector3Max(v0, Vector3Max(v1, v2));
+            builder.tris[i].centroid = Vector3Scale(Vector3Add(v0, Vector3Add(v1, v2)), 1.0f / 3.0f);
+        }
+    }
+
+    BuildBVHNode(&builder, 0, count, 0);
+    free(builder.tris);
+
+    // Store triangles in leaf order so every leaf reads a contiguous range
+    for (int i = 0; i < count; i++) {
+        int src = builder.order[i];
+        int m = FindTriangleMesh(&collision.info, src);
+        int t = src - collision.info.meshes[m].triangleOffset;
+
+        Vector3 v0, v1, v2;
+        GetWorldTriangle(model, m, t, &v0, &v1, &v2);
+        SetSoupTriangle(&collision.soup, i, v0, v1, v2, m, t);
+    }
+    free(builder.order);
+
+    BVHNode *nodes = (BVHNode *)realloc(builder.nodes, sizeof(BVHNode) * builder.nodeCount);
+    collision.nodes = (nodes != NULL) ? nodes : builder.nodes;
+    collision.nodeCount = builder.nodeCount;
+
+    return collision;
+}
+
+// Function to rebuild collision data when the model transform changes
+bool UpdateModelCollision(ModelCollision *collision, Model model) {
+    if (memcmp(&collision->transform, &model.transform, sizeof(Matrix)) == 0) return false;
+
+    UnloadModelCollision(collision);
+    *collision = LoadModelCollision(model);
+
+    return true;
+}
+
+// Function to release the acceleration structure
+void UnloadModelCollision(ModelCollision *collision) {
+    UnloadModelInfo(&collision->info);
+    free(collision->nodes);
+    UnloadTriangleSoup(&collision->soup);
+    collision->nodes = NULL;
+    collision->nodeCount = 0;
+}
+
+// Slab test, returns the entry distance or FLT_MAX on a miss
+static float IntersectNodeBounds(const BVHNode *node, Vector3 origin, Vector3 invDir, float maxDistance) {
+    float tx1 = (node->min[0] - origin.x) * invDir.x;
+    float tx2 = (node->max[0] - origin.x) * invDir.x;
+    float tmin = fminf(tx1, tx2);
+    float tmax = fmaxf(tx1, tx2);
+
+    float ty1 = (node->min[1] - origin.y) * invDir.y;
+    float ty2 = (node->max[1] - origin.y) * invDir.y;
+    tmin = fmaxf(tmin, fminf(ty1, ty2));
+    tmax = fminf(tmax, fmaxf(ty1, ty2));
+
+    float tz1 = (node->min[2] - origin.z) * invDir.z;
+    float tz2 = (node->max[2] - origin.z) * invDir.z;
+    tmin = fmaxf(tmin, fminf(tz1, tz2));
+    tmax = fminf(tmax, fmaxf(tz1, tz2));
+
+    if (tmax < tmin || tmax < 0.0f || tmin >= maxDistance) return FLT_MAX;
+    return fmaxf(tmin, 0.0f);
+}
+
+static float GetSafeInverse(float d) {
+    if (fabsf(d) < 1e-20f) return (d < 0.0f) ? -1e30f : 1e30f;
+    return 1.0f / d;
+}
+
+// Function to fill in a hit result for a soup triangle
+static CollisionHit GetCollisionHit(const TriangleSoup *soup, int index, Ray ray, float distance) {
+    Vector3 e1 = { soup->e1x[index], soup->e1y[index], soup->e1z[index] };
+    Vector3 e2 = { soup->e2x[index], soup->e2y[index], soup->e2z[index] };
+    CollisionHit hit = {0};
+
+    hit.hit = true;
+    hit.distance = distance;
+    hit.point = Vector3Add(ray.position, Vector3Scale(ray.direction, distance));
+    hit.normal = Vector3Normalize(Vector3CrossProduct(e1, e2));
+    hit.meshIndex = soup->meshIndex[index];
+    hit.triangleIndex = soup->triangleIndex[index];
+
+    return hit;
+}
+
+// Function to cast a ray through the BVH (shared by every model query)
+CollisionHit RaycastModelCollision(const ModelCollision *collision, Ray ray, float maxDistance, CollisionQueryMode mode) {
+    CollisionHit result = {0};
+    result.meshIndex = -1;
+    result.triangleIndex = -1;
+
+    if (collision->nodeCount == 0) {
+        if (collision->soup.count > 0) return RaycastModelCollisionBruteForce(collision, ray, maxDistance, mode);
+        return result;
+    }
+
+    Vector3 invDir = {
+        GetSafeInverse(ray.direction.x),
+        GetSafeInverse(ray.direction.y),
+        GetSafeInverse(ray.direction.z)
+    };
+
+    float closest = maxDistance;
+    int hitTriangle = -1;
+    int stack[BVH_TRAVERSAL_STACK_SIZE];
+    float stackDistance[BVH_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+
+    float rootDistance = IntersectNodeBounds(&collision->nodes[0], ray.position, invDir, closest);
+    if (rootDistance == FLT_MAX) return result;
+    stack[0] = 0;
+    stackDistance[0] = rootDistance;
+    stackSize = 1;
+
+    while (stackSize > 0) {
+        stackSize--;
+
+        // Skip subtrees that start behind a hit found after they were pushed
+        if (stackDistance[stackSize] >= closest) continue;
+        const BVHNode *node = &collision->nodes[stack[stackSize]];
+
+        if (node->count > 0) {
+            // Leaf: test its contiguous range of baked triangles in one kernel call
+            float distance;
+            int hit = IntersectRayTriangles(&collision->soup, node->rightOrFirst, node->count, ray, closest, &distance);
+            if (hit >= 0) {
+                closest = distance;
+                hitTriangle = hit;
+
+                if (mode == COLLISION_QUERY_ANY_HIT) break;
+            }
+            continue;
+        }
+
+        // Interior: visit the nearer child first
+        int left = (int)(node - collision->nodes) + 1;
+        int right = node->rightOrFirst;
+        float tLeft = IntersectNodeBounds(&collision->nodes[left], ray.position, invDir, closest);
+        float tRight = IntersectNodeBounds(&collision->nodes[right], ray.position, invDir, closest);
+
+        if (tLeft > tRight) {
+            int tmpIndex = left; left = right; right = tmpIndex;
+            float tmpDist = tLeft; tLeft = tRight; tRight = tmpDist;
+        }
+
+        if (tRight != FLT_MAX) {
+            stack[stackSize] = right;
+            stackDistance[stackSize++] = tRight;
+        }
+        if (tLeft != FLT_MAX) {
+            stack[stackSize] = left;
+            stackDistance[stackSize++] = tLeft;
+        }
+    }
+
+    if (hitTriangle >= 0) result = GetCollisionHit(&collision->soup, hitTriangle, ray, closest);
+
+    return result;
+}
+
+// Function to test every baked triangle without the BVH (reference path)
+CollisionHit RaycastModelCollisionBruteForce(const ModelCollision *collision, Ray ray, float maxDistance, CollisionQueryMode mode) {
+    CollisionHit result = {0};
+    result.meshIndex = -1;
+    result.triangleIndex = -1;
+
+    float closest = maxDistance;
+    int hitTriangle = -1;
+
+    for (int first = 0; first < collision->soup.count; first += COLLISION_BRUTE_FORCE_BLOCK) {
+        int count = collision->soup.count - first;
+        if (count > COLLISION_BRUTE_FORCE_BLOCK) count = COLLISION_BRUTE_FORCE_BLOCK;
+
+        float distance;
+        int hit = IntersectRayTriangles(&collision->soup, first, count, ray, closest, &distance);
+        if (hit >= 0) {
+            closest = distance;
+            hitTriangle = hit;
+
+            if (mode == COLLISION_QUERY_ANY_HIT) break;
+        }
+    }
+
+    if (hitTriangle >= 0) result = GetCollisionHit(&collision->soup, hitTriangle, ray, closest);
+
+    return result;
+}
+
+// Function to trace a packet of closest-hit rays through the BVH together
+// Each stack entry carries a bitmask of the rays still inside that subtree (RAY_PACKET_SIZE <= 64)
+static void TraceRayPacket(const ModelCollision *collision, RayPacket *packet) {
+    Vector3 invDir[RAY_PACKET_SIZE];
+    for (int r = 0; r < packet->count; r++) {
+        invDir[r] = (Vector3){ GetSafeInverse(packet->dx[r]), GetSafeInverse(packet->dy[r]), GetSafeInverse(packet->dz[r]) };
+    }
+
+    int stack[BVH_TRAVERSAL_STACK_SIZE];
+    uint64_t stackMask[BVH_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+
+    stack[0] = 0;
+    stackMask[0] = (packet->count >= 64) ? ~(uint64_t)0 : (((uint64_t)1 << packet->count) - 1);
+    stackSize = 1;
+
+    // Compacted packet for leaves reached by only part of the rays
+    float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+    float dx[RAY_PACKET_SIZE], dy[RAY_PACKET_SIZE], dz[RAY_PACKET_SIZE];
+    float distance[RAY_PACKET_SIZE];
+    int hitTriangle[RAY_PACKET_SIZE];
+    int rayIndex[RAY_PACKET_SIZE];
+
+    while (stackSize > 0) {
+        stackSize--;
+        const BVHNode *node = &collision->nodes[stack[stackSize]];
+        uint64_t parentMask = stackMask[stackSize];
+
+        // Keep only the rays that can still hit this box
+        uint64_t mask = 0;
+        for (int r = 0; r < packet->count; r++) {
+            if (!(parentMask & ((uint64_t)1 << r))) continue;
+
+            Vector3 origin = { packet->ox[r], packet->oy[r], packet->oz[r] };
+            if (IntersectNodeBounds(node, origin, invDir[r], packet->distance[r]) != FLT_MAX) mask |= (uint64_t)1 << r;
+        }
+        if (mask == 0) continue;
+
+        if (node->count == 0) {
+            stack[stackSize] = node->rightOrFirst;
+            stackMask[stackSize++] = mask;
+            stack[stackSize] = (int)(node - collision->nodes) + 1;
+            stackMask[stackSize++] = mask;
+            continue;
+        }
+
+        // Gather the active rays and run the packet kernel on the leaf
+        RayPacket active = { ox, oy, oz, dx, dy, dz, distance, hitTriangle, 0 };
+        for (int r = 0; r < packet->count; r++) {
+            if (!(mask & ((uint64_t)1 << r))) continue;
+
+            int n = active.count++;
+            ox[n] = packet->ox[r]; oy[n] = packet->oy[r]; oz[n] = packet->oz[r];
+            dx[n] = packet->dx[r]; dy[n] = packet->dy[r]; dz[n] = packet->dz[r];
+            distance[n] = packet->distance[r];
+            hitTriangle[n] = packet->hitTriangle[r];
+            rayIndex[n] = r;
+        }
+
+        IntersectRayPacketTriangles(&collision->soup, node->rightOrFirst, node->count, &active);
+
+        for (int n = 0; n < active.count; n++) {
+            packet->distance[rayIndex[n]] = distance[n];
+            packet->hitTriangle[rayIndex[n]] = hitTriangle[n];
+        }
+    }
+}
+
+// Function to trace a packet through a model's BVH, or through every triangle of a model without one
+static void TraceModelPacket(const ModelCollision *collision, RayPacket *packet) {
+    if (collision->nodeCount > 0) {
+        TraceRayPacket(collision, packet);
+        return;
+    }
+
+    for (int i = 0; i < collision->soup.count; i += COLLISION_BRUTE_FORCE_BLOCK) {
+        int count = collision->soup.count - i;
+        if (count > COLLISION_BRUTE_FORCE_BLOCK) count = COLLISION_BRUTE_FORCE_BLOCK;
+        IntersectRayPacketTriangles(&collision->soup, i, count, packet);
+    }
+}
+
+// Function to cast many closest-hit rays at once (e.g. one per unit)
+void RaycastModelCollisionPacket(const ModelCollision *collision, const Ray *rays, int rayCount, float maxDistance, CollisionHit *hits) {
+    float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+    float dx[RAY_PACKET_SIZE], dy[RAY_PACKET_SIZE], dz[RAY_PACKET_SIZE];
+    float distance[RAY_PACKET_SIZE];
+    int hitTriangle[RAY_PACKET_SIZE];
+
+    for (int first = 0; first < rayCount; first += RAY_PACKET_SIZE) {
+        RayPacket packet = { ox, oy, oz, dx, dy, dz, distance, hitTriangle, 0 };
+        packet.count = rayCount - first;
+        if (packet.count > RAY_PACKET_SIZE) packet.count = RAY_PACKET_SIZE;
+
+        for (int r = 0; r < packet.count; r++) {
+            Ray ray = rays[first + r];
+            ox[r] = ray.position.x; oy[r] = ray.position.y; oz[r] = ray.position.z;
+            dx[r] = ray.direction.x; dy[r] = ray.direction.y; dz[r] = ray.direction.z;
+            distance[r] = maxDistance;
+            hitTriangle[r] = -1;
+        }
+
+        TraceModelPacket(collision, &packet);
+
+        for (int r = 0; r < packet.count; r++) {
+            CollisionHit hit = {0};
+            hit.meshIndex = -1;
+            hit.triangleIndex = -1;
+            if (hitTriangle[r] >= 0) hit = GetCollisionHit(&collision->soup, hitTriangle[r], rays[first + r], distance[r]);
+            hits[first + r] = hit;
+        }
+    }
+}
+
+// Function to get the box the top level tests an instance with: its BVH root box, or its padded mesh bounds without one
+static void GetInstanceBounds(const ModelCollision *collision, Vector3 *min, Vector3 *max) {
+    if (collision->nodeCount > 0) {
+        const BVHNode *root = &collision->nodes[0];
+        *min = (Vector3){ root->min[0], root->min[1], root->min[2] };
+        *max = (Vector3){ root->max[0], root->max[1], root->max[2] };
+        return;
+    }
+
+    BoundingBox bounds = collision->info.bounds;
+    float extent = fmaxf(Vector3Length(bounds.min), Vector3Length(bounds.max));
+    float pad = BVH_BOUNDS_EPSILON * fmaxf(extent, 1.0f);
+    *min = (Vector3){ bounds.min.x - pad, bounds.min.y - pad, bounds.min.z - pad };
+    *max = (Vector3){ bounds.max.x + pad, bounds.max.y + pad, bounds.max.z + pad };
+}
+
+// Function to build the top-level BVH with the model BVH builder, instance boxes standing in for triangles
+CollisionScene LoadCollisionScene(const ModelCollision *const *instances, int count) {
+    CollisionScene scene = {0};
+    if (count <= 0) return scene;
+
+    BVHBuilder builder = {0};
+    scene.instances = (const ModelCollision **)malloc(sizeof(const ModelCollision *) * count);
+    builder.nodes = (BVHNode *)malloc(sizeof(BVHNode) * (2 * count));
+    builder.order = (int *)malloc(sizeof(int) * count);
+    builder.tris = (BuildTriangle *)malloc(sizeof(BuildTriangle) * count);
+
+    if (scene.instances == NULL || builder.nodes == NULL || builder.order == NULL || builder.tris == NULL) {
+        printf("Failed to allocate top-level BVH for %d instances\n", count);
+        free(scene.instances);
+        free(builder.nodes);
+        free(builder.order);
+        free(builder.tris);
+        return (CollisionScene){0};
+    }
+
+    int used = 0;
+    for (int i = 0; i < count; i++) {
+        scene.instances[i] = instances[i];
+        if (instances[i] == NULL || (instances[i]->nodeCount == 0 && instances[i]->soup.count == 0)) continue;
+
+        BuildTriangle *box = &builder.tris[used];
+        GetInstanceBounds(instances[i], &box->min, &box->max);
+        box->centroid = Vector3Scale(Vector3Add(box->min, box->max), 0.5f);
+        builder.order[used++] = i;
+    }
+    scene.instanceCount = count;
+
+    if (used > 0) BuildBVHNode(&builder, 0, used, 0);
+    free(builder.tris);
+
+    BVHNode *nodes = (BVHNode *)realloc(builder.nodes, sizeof(BVHNode) * (builder.nodeCount > 0 ? builder.nodeCount : 1));
+    scene.nodes = (nodes != NULL) ? nodes : builder.nodes;
+    scene.nodeCount = builder.nodeCount;
+    scene.order = builder.order;
+
+    return scene;
+}
+
+// Function to release the top-level BVH
+void UnloadCollisionScene(CollisionScene *scene) {
+    free(scene->instances);
+    free(scene->order);
+    free(scene->nodes);
+    *scene = (CollisionScene){0};
+}
+
+// Function to cast a ray down the top level, leaves hand it to their instances' BVHs
+CollisionHit RaycastCollisionScene(const CollisionScene *scene, Ray ray, float maxDistance, CollisionQueryMode mode) {
+    CollisionHit result = {0};
+    result.meshIndex = -1;
+    result.triangleIndex = -1;
+
+    if (scene->nodeCount == 0) return result;
+
+    Vector3 invDir = {
+        GetSafeInverse(ray.direction.x),
+        GetSafeInverse(ray.direction.y),
+        GetSafeInverse(ray.direction.z)
+    };
+
+    float closest = maxDistance;
+    int stack[BVH_TRAVERSAL_STACK_SIZE];
+    float stackDistance[BVH_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+
+    float rootDistance = IntersectNodeBounds(&scene->nodes[0], ray.position, invDir, closest);
+    if (rootDistance == FLT_MAX) return result;
+    stack[0] = 0;
+    stackDistance[0] = rootDistance;
+    stackSize = 1;
+
+    while (stackSize > 0) {
+        stackSize--;
+
+        // Skip subtrees that start behind a hit found after they were pushed
+        if (stackDistance[stackSize] >= closest) continue;
+        const BVHNode *node = &scene->nodes[stack[stackSize]];
+
+        if (node->count > 0) {
+            // Leaf: the closest hit so far limits the ray in every following instance
+            for (int k = node->rightOrFirst; k < node->rightOrFirst + node->count; k++) {
+                int instance = scene->order[k];
+                CollisionHit hit = RaycastModelCollision(scene->instances[instance], ray, closest, mode);
+                if (!hit.hit) continue;
+
+                closest = hit.distance;
+                result = hit;
+                result.instance = instance;
+                if (mode == COLLISION_QUERY_ANY_HIT) return result;
+            }
+            continue;
+        }
+
+        // Interior: visit the nearer child first
+        int left = (int)(node - scene->nodes) + 1;
+        int right = node->rightOrFirst;
+        float tLeft = IntersectNodeBounds(&scene->nodes[left], ray.position, invDir, closest);
+        float tRight = IntersectNodeBounds(&scene->nodes[right], ray.position, invDir, closest);
+
+        if (tLeft > tRight) {
+            int tmpIndex = left; left = right; right = tmpIndex;
+            float tmpDist = tLeft; tLeft = tRight; tRight = tmpDist;
+        }
+
+        if (tRight != FLT_MAX) {
+            stack[stackSize] = right;
+            stackDistance[stackSize++] = tRight;
+        }
+        if (tLeft != FLT_MAX) {
+            stack[stackSize] = left;
+            stackDistance[stackSize++] = tLeft;
+        }
+    }
+
+    return result;
+}
+
+// Function to trace a packet down the top level, every leaf instance traces the rays that reach it through its BVH
+static void TraceScenePacket(const CollisionScene *scene, RayPacket *packet, int *hitInstance) {
+    Vector3 invDir[RAY_PACKET_SIZE];
+    for (int r = 0; r < packet->count; r++) {
+        invDir[r] = (Vector3){ GetSafeInverse(packet->dx[r]), GetSafeInverse(packet->dy[r]), GetSafeInverse(packet->dz[r]) };
+    }
+
+    int stack[BVH_TRAVERSAL_STACK_SIZE];
+    uint64_t stackMask[BVH_TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+
+    stack[0] = 0;
+    stackMask[0] = (packet->count >= 64) ? ~(uint64_t)0 : (((uint64_t)1 << packet->count) - 1);
+    stackSize = 1;
+
+    // Compacted packet of the rays that reach a leaf
+    float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+    float dx[RAY_PACKET_SIZE], dy[RAY_PACKET_SIZE], dz[RAY_PACKET_SIZE];
+    float distance[RAY_PACKET_SIZE];
+    int hitTriangle[RAY_PACKET_SIZE];
+    int rayIndex[RAY_PACKET_SIZE];
+
+    while (stackSize > 0) {
+        stackSize--;
+        const BVHNode *node = &scene->nodes[stack[stackSize]];
+        uint64_t parentMask = stackMask[stackSize];
+
+        // Keep only the rays that can still hit this box
+        uint64_t mask = 0;
+        for (int r = 0; r < packet->count; r++) {
+            if (!(parentMask & ((uint64_t)1 << r))) continue;
+
+            Vector3 origin = { packet->ox[r], packet->oy[r], packet->oz[r] };
+            if (IntersectNodeBounds(node, origin, invDir[r], packet->distance[r]) != FLT_MAX) mask |= (uint64_t)1 << r;
+        }
+        if (mask == 0) continue;
+
+        if (node->count == 0) {
+            stack[stackSize] = node->rightOrFirst;
+            stackMask[stackSize++] = mask;
+            stack[stackSize] = (int)(node - scene->nodes) + 1;
+            stackMask[stackSize++] = mask;
+            continue;
+        }
+
+        for (int k = node->rightOrFirst; k < node->rightOrFirst + node->count; k++) {
+            // Triangle indices are per instance, so each one starts without a hit and only improvements are kept
+            RayPacket active = { ox, oy, oz, dx, dy, dz, distance, hitTriangle, 0 };
+            for (int r = 0; r < packet->count; r++) {
+                if (!(mask & ((uint64_t)1 << r))) continue;
+
+                int n = active.count++;
+                ox[n] = packet->ox[r]; oy[n] = packet->oy[r]; oz[n] = packet->oz[r];
+                dx[n] = packet->dx[r]; dy[n] = packet->dy[r]; dz[n] = packet->dz[r];
+                distance[n] = packet->distance[r];
+                hitTriangle[n] = -1;
+                rayIndex[n] = r;
+            }
+
+            TraceModelPacket(scene->instances[scene->order[k]], &active);
+
+            for (int n = 0; n < active.count; n++) {
+                if (hitTriangle[n] < 0) continue;
+                packet->distance[rayIndex[n]] = distance[n];
+                packet->hitTriangle[rayIndex[n]] = hitTriangle[n];
+                hitInstance[rayIndex[n]] = scene->order[k];
+            }
+        }
+    }
+}
+
+// Function to cast many closest-hit rays against every instance at once
+void RaycastCollisionScenePacket(const CollisionScene *scene, const Ray *rays, int rayCount, float maxDistance, CollisionHit *hits) {
+    float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+    float dx[RAY_PACKET_SIZE], dy[RAY_PACKET_SIZE], dz[RAY_PACKET_SIZE];
+    float distance[RAY_PACKET_SIZE];
+    int hitTriangle[RAY_PACKET_SIZE];
+    int hitInstance[RAY_PACKET_SIZE];
+
+    for (int first = 0; first < rayCount; first += RAY_PACKET_SIZE) {
+        RayPacket packet = { ox, oy, oz, dx, dy, dz, distance, hitTriangle, 0 };
+        packet.count = rayCount - first;
+        if (packet.count > RAY_PACKET_SIZE) packet.count = RAY_PACKET_SIZE;
+
+        for (int r = 0; r < packet.count; r++) {
+            Ray ray = rays[first + r];
+            ox[r] = ray.position.x; oy[r] = ray.position.y; oz[r] = ray.position.z;
+            dx[r] = ray.direction.x; dy[r] = ray.direction.y; dz[r] = ray.direction.z;
+            distance[r] = maxDistance;
+            hitTriangle[r] = -1;
+            hitInstance[r] = -1;
+        }
+
+        if (scene->nodeCount > 0) TraceScenePacket(scene, &packet, hitInstance);
+
+        for (int r = 0; r < packet.count; r++) {
+            CollisionHit hit = {0};
+            hit.meshIndex = -1;
+            hit.triangleIndex = -1;
+            if (hitInstance[r] >= 0) {
+                hit = GetCollisionHit(&scene->instances[hitInstance[r]]->soup, hitTriangle[r], rays[first + r], distance[r]);
+                hit.instance = hitInstance[r];
+            }
+            hits[first + r] = hit;
+        }
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <raylib.h>
+#include <stddef.h>
+
+// BVH build settings
+#define BVH_SAH_BINS 12
+#define BVH_MAX_LEAF_TRIANGLES 8
+#define BVH_MAX_SAH_DEPTH 40           // Deeper nodes fall back to median splits
+#define BVH_TRAVERSAL_STACK_SIZE 96
+#define BVH_BOUNDS_EPSILON 1e-5f        // Relative padding of node boxes
+
+// Ray batching settings
+#define COLLISION_BRUTE_FORCE_BLOCK 64 // Triangles per kernel call without the BVH
+#define RAY_PACKET_SIZE 64             // Rays traced together by the packet query
+
+// Query modes for the shared ray traversal
+typedef enum {
+    COLLISION_QUERY_ANY_HIT,     // Stop at the first triangle closer than maxDistance
+    COLLISION_QUERY_CLOSEST_HIT  // Find the nearest triangle along the ray
+} CollisionQueryMode;
+
+// Flattened BVH node (32 bytes, depth-first order)
+// Interior nodes: left child is the next node, rightOrFirst is the right child
+// Leaf nodes: rightOrFirst is the first soup triangle, count > 0
+typedef struct {
+    float min[3];
+    int rightOrFirst;
+    float max[3];
+    int count;
+} BVHNode;
+
+// World-space triangles in structure-of-arrays layout (v0, edge1, edge2)
+// All arrays are slices of one contiguous allocation, stored in BVH leaf order
+typedef struct {
+    float *v0x, *v0y, *v0z;
+    float *e1x, *e1y, *e1z;
+    float *e2x, *e2y, *e2z;
+    int *meshIndex;            // Source mesh of each triangle
+    int *triangleIndex;        // Triangle index within the source mesh
+    int count;
+    void *buffer;              // Backing allocation for every array above
+} TriangleSoup;
+
+// Per-mesh metadata computed once at load
+typedef struct {
+    BoundingBox bounds;        // World-space bounds of the mesh
+    int triangleCount;
+    int vertexCount;
+    int triangleOffset;        // First triangle of this mesh in model-wide numbering
+} MeshInfo;
+
+// Per-model metadata shared by the query paths and the info panel
+typedef struct {
+    MeshInfo *meshes;
+    int meshCount;
+    BoundingBox bounds;        // Union of all mesh bounds
+    int totalTriangles;
+    int totalVertices;
+} ModelInfo;
+
+// Ray acceleration structure for a loaded model
+typedef struct {
+    Matrix transform;          // Model transform the soup was baked with
+    ModelInfo info;
+    TriangleSoup soup;
+    BVHNode *nodes;
+    int nodeCount;
+} ModelCollision;
+
+// Result of a ray query against a ModelCollision
+typedef struct {
+    bool hit;
+    float distance;
+    Vector3 point;
+    Vector3 normal;
+    int meshIndex;
+    int triangleIndex;
+    int instance;              // CollisionScene instance the triangle belongs to (0 for plain model queries)
+} CollisionHit;
+
+// Top-level acceleration structure over several baked models (scene tiles), each keeping its own BVH
+// Leaves of nodes hold a range of order, which lists instance indices; rebuild it whenever an instance changes
+typedef struct {
+    const ModelCollision **instances;  // Not owned, must stay valid while the scene is used
+    int instanceCount;
+    int *order;
+    BVHNode *nodes;            // Built like a model BVH over the instance root boxes
+    int nodeCount;
+} CollisionScene;
+
+// Compute per-mesh bounds, triangle counts and offsets (one vertex scan per mesh)
+ModelInfo LoadModelInfo(Model model);
+
+// Release memory owned by the model metadata
+void UnloadModelInfo(ModelInfo *info);
+
+// Allocate a zeroed soup of count triangles in the padded single-buffer layout
+bool AllocTriangleSoup(TriangleSoup *soup, int count);
+
+// Size in bytes of soup.buffer for count triangles (the arrays are stored back to back in this order)
+size_t GetTriangleSoupBufferSize(int count);
+
+// Build the metadata and acceleration structure for a model (call once after LoadModel)
+ModelCollision LoadModelCollision(Model model);
+
+// Rebuild the baked triangles and BVH if the model transform changed, returns true on rebuild
+bool UpdateModelCollision(ModelCollision *collision, Model model);
+
+// Release memory owned by the acceleration structure
+void UnloadModelCollision(ModelCollision *collision);
+
+// Cast a ray against the model, hits beyond maxDistance are ignored
+CollisionHit RaycastModelCollision(const ModelCollision *collision, Ray ray, float maxDistance, CollisionQueryMode mode);
+
+// Same query without the BVH, testing every triangle (reference and fallback path)
+CollisionHit RaycastModelCollisionBruteForce(const ModelCollision *collision, Ray ray, float maxDistance, CollisionQueryMode mode);
+
+// Cast rayCount closest-hit rays together, writing one result per ray into hits
+void RaycastModelCollisionPacket(const ModelCollision *collision, const Ray *rays, int rayCount, float maxDistance, CollisionHit *hits);
+
+// Build the top-level structure over count baked models, those without triangles are left out
+CollisionScene LoadCollisionScene(const ModelCollision *const *instances, int count);
+
+// Release the top-level structure (the instances stay)
+void UnloadCollisionScene(CollisionScene *scene);
+
+// Cast a ray against every instance, hits beyond maxDistance are ignored
+CollisionHit RaycastCollisionScene(const CollisionScene *scene, Ray ray, float maxDistance, CollisionQueryMode mode);
+
+// Cast rayCount closest-hit rays against every instance, packets stay together down both levels
+void RaycastCollisionScenePacket(const CollisionScene *scene, const Ray *rays, int rayCount, float maxDistance, CollisionHit *hits);
+
+#endif // COLLISION_H
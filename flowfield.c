@@ -0,0 +1,325 @@
+#include "flowfield.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define FLOWFIELD_NO_DIRECTION 0xFF
+
+// Neighbour offsets, odd directions are diagonals; direction (k + 4) & 7 points back
+static const int neighborX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int neighborZ[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const float neighborDirX[8] = { 1.0f, 0.70710678f, 0.0f, -0.70710678f, -1.0f, -0.70710678f, 0.0f, 0.70710678f };
+static const float neighborDirZ[8] = { 0.0f, 0.70710678f, 1.0f, 0.70710678f, 0.0f, -0.70710678f, -1.0f, -0.70710678f };
+
+// Function to build the nav grid, each cell covering factor x factor heightfield samples
+NavGrid LoadNavGrid(const Heightfield *heightfield) {
+    NavGrid grid = {0};
+    if (heightfield->heights == NULL) return grid;
+
+    int sampleWidth = heightfield->width;
+    int sampleDepth = heightfield->depth;
+
+    // Coarsen the grid until one flow field stays small
+    int factor = 1;
+    while ((double)((sampleWidth + factor - 1) / factor) * ((sampleDepth + factor - 1) / factor) > FLOWFIELD_MAX_CELLS) {
+        factor *= 2;
+    }
+
+    // Samples sit at cell centres when factor is 1
+    grid.originX = heightfield->originX - heightfield->cellSize * 0.5f;
+    grid.originZ = heightfield->originZ - heightfield->cellSize * 0.5f;
+    grid.cellSize = heightfield->cellSize * factor;
+    grid.width = (sampleWidth + factor - 1) / factor;
+    grid.depth = (sampleDepth + factor - 1) / factor;
+
+    int cellCount = grid.width * grid.depth;
+    grid.heights = (float *)calloc(cellCount, sizeof(float));
+    grid.flags = (unsigned char *)calloc(cellCount, sizeof(unsigned char));
+
+    if (grid.heights == NULL || grid.flags == NULL) {
+        printf("Failed to allocate %dx%d nav grid\n", grid.width, grid.depth);
+        UnloadNavGrid(&grid);
+        return grid;
+    }
+
+    float maxStep = heightfield->cellSize * FLOWFIELD_MAX_SLOPE;
+
+    for (int cz = 0; cz < grid.depth; cz++) {
+        for (int cx = 0; cx < grid.width; cx++) {
+            bool walkable = true;
+            bool multiLayer = false;
+            float sum = 0.0f;
+            int surfaced = 0;
+
+            for (int sz = cz * factor; sz < (cz + 1) * factor && sz < sampleDepth; sz++) {
+                for (int sx = cx * factor; sx < (cx + 1) * factor && sx < sampleWidth; sx++) {
+                    int sample = sz * sampleWidth + sx;
+                    unsigned char flags = heightfield->flags[sample];
+                    float height = heightfield->heights[sample];
+
+                    if (!(flags & HEIGHTFIELD_SAMPLE_SURFACE)) {
+                        walkable = false;
+                        continue;
+                    }
+                    if (flags & HEIGHTFIELD_SAMPLE_MULTILAYER) multiLayer = true;
+                    sum += height;
+                    surfaced++;
+
+                    // Steps to the next samples too, so a wall on a cell border blocks the cell before it
+                    if (sx + 1 < sampleWidth && (heightfield->flags[sample + 1] & HEIGHTFIELD_SAMPLE_SURFACE) &&
+                        fabsf(heightfield->heights[sample + 1] - height) > maxStep) walkable = false;
+                    if (sz + 1 < sampleDepth && (heightfield->flags[sample + sampleWidth] & HEIGHTFIELD_SAMPLE_SURFACE) &&
+                        fabsf(heightfield->heights[sample + sampleWidth] - height) > maxStep) walkable = false;
+                }
+            }
+
+            int cell = cz * grid.width + cx;
+            grid.heights[cell] = (surfaced > 0) ? sum / surfaced : 0.0f;
+            grid.flags[cell] = (walkable ? NAV_CELL_WALKABLE : 0) | (multiLayer ? NAV_CELL_MULTILAYER : 0);
+            if (walkable) grid.walkableCells++;
+        }
+    }
+
+    return grid;
+}
+
+// Function to release nav grid memory
+void UnloadNavGrid(NavGrid *grid) {
+    free(grid->heights);
+    free(grid->flags);
+    memset(grid, 0, sizeof(*grid));
+}
+
+// Function to free every field and the build scratch
+void UnloadFlowFieldCache(FlowFieldCache *cache) {
+    for (int i = 0; i < FLOWFIELD_CACHE_SIZE; i++) {
+        free(cache->fields[i].distance);
+        free(cache->fields[i].direction);
+    }
+    free(cache->heap);
+    free(cache->heapCost);
+    memset(cache, 0, sizeof(*cache));
+}
+
+// Function to push a cell onto the open list, returns false if memory ran out
+static bool PushFlowCell(FlowFieldCache *cache, int *count, int cell, float cost) {
+    if (*count == cache->heapCapacity) {
+        int capacity = (cache->heapCapacity > 0) ? cache->heapCapacity * 2 : 1024;
+        int *heap = (int *)realloc(cache->heap, sizeof(int) * capacity);
+        if (heap != NULL) cache->heap = heap;
+        float *heapCost = (float *)realloc(cache->heapCost, sizeof(float) * capacity);
+        if (heapCost != NULL) cache->heapCost = heapCost;
+        if (heap == NULL || heapCost == NULL) return false;
+        cache->heapCapacity = capacity;
+    }
+
+    // Sift up
+    int i = (*count)++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (cache->heapCost[parent] <= cost) break;
+        cache->heap[i] = cache->heap[parent];
+        cache->heapCost[i] = cache->heapCost[parent];
+        i = parent;
+    }
+    cache->heap[i] = cell;
+    cache->heapCost[i] = cost;
+    return true;
+}
+
+// Function to take the cheapest cell off the open list
+static int PopFlowCell(FlowFieldCache *cache, int *count, float *cost) {
+    int cell = cache->heap[0];
+    *cost = cache->heapCost[0];
+
+    int last = --(*count);
+    int lastCell = cache->heap[last];
+    float lastCost = cache->heapCost[last];
+
+    // Sift the last entry down from the root
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= last) break;
+        if (child + 1 < last && cache->heapCost[child + 1] < cache->heapCost[child]) child++;
+        if (lastCost <= cache->heapCost[child]) break;
+        cache->heap[i] = cache->heap[child];
+        cache->heapCost[i] = cache->heapCost[child];
+        i = child;
+    }
+    cache->heap[i] = lastCell;
+    cache->heapCost[i] = lastCost;
+
+    return cell;
+}
+
+// Function to check whether a unit can walk from cell a to its neighbour b
+static bool IsNavEdgeOpen(const NavGrid *grid, int a, int b, float length) {
+    return (grid->flags[b] & NAV_CELL_WALKABLE) &&
+           fabsf(grid->heights[a] - grid->heights[b]) <= length * FLOWFIELD_MAX_SLOPE;
+}
+
+// Function to fill a field with Dijkstra from the goal cell outwards
+// Every cell points at the neighbour it was reached from, so following directions walks the shortest path
+static bool BuildFlowField(FlowFieldCache *cache, const NavGrid *grid, FlowField *field) {
+    int cellCount = grid->width * grid->depth;
+
+    for (int i = 0; i < cellCount; i++) {
+        field->distance[i] = FLOWFIELD_UNREACHABLE;
+        field->direction[i] = FLOWFIELD_NO_DIRECTION;
+    }
+
+    int count = 0;
+    field->distance[field->goalCell] = 0.0f;
+    if (!PushFlowCell(cache, &count, field->goalCell, 0.0f)) return false;
+
+    float diagonal = grid->cellSize * 1.41421356f;
+
+    while (count > 0) {
+        float cost;
+        int cell = PopFlowCell(cache, &count, &cost);
+        if (cost > field->distance[cell]) continue;  // Stale entry, the cell was reached cheaper since
+
+        int cx = cell % grid->width;
+        int cz = cell / grid->width;
+
+        for (int k = 0; k < 8; k++) {
+            int nx = cx + neighborX[k];
+            int nz = cz + neighborZ[k];
+            if (nx < 0 || nz < 0 || nx >= grid->width || nz >= grid->depth) continue;
+
+            int next = nz * grid->width + nx;
+            float length = (k & 1) ? diagonal : grid->cellSize;
+            if (!IsNavEdgeOpen(grid, cell, next, length)) continue;
+
+            // Diagonals may not cut past a blocked corner
+            if (k & 1) {
+                int sideA = (cz + neighborZ[k - 1]) * grid->width + cx + neighborX[k - 1];
+                int sideB = (cz + neighborZ[(k + 1) & 7]) * grid->width + cx + neighborX[(k + 1) & 7];
+                if (!IsNavEdgeOpen(grid, cell, sideA, grid->cellSize) || !IsNavEdgeOpen(grid, cell, sideB, grid->cellSize)) continue;
+            }
+
+            float nextCost = cost + length;
+            if (nextCost < field->distance[next]) {
+                field->distance[next] = nextCost;
+                field->direction[next] = (unsigned char)((k + 4) & 7);
+                if (!PushFlowCell(cache, &count, next, nextCost)) return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Function to find the cell under a world position, -1 outside the grid
+static int GetNavCell(const NavGrid *grid, float x, float z) {
+    if (grid->flags == NULL) return -1;
+
+    int cx = (int)floorf((x - grid->originX) / grid->cellSize);
+    int cz = (int)floorf((z - grid->originZ) / grid->cellSize);
+    if (cx < 0 || cz < 0 || cx >= grid->width || cz >= grid->depth) return -1;
+
+    return cz * grid->width + cx;
+}
+
+// Function to return a cached field or replace the least recently requested one
+int RequestFlowField(FlowFieldCache *cache, const NavGrid *grid, Vector3 goal) {
+    int goalCell = GetNavCell(grid, goal.x, goal.z);
+    if (goalCell < 0 || !(grid->flags[goalCell] & NAV_CELL_WALKABLE)) return FLOWFIELD_NONE;
+
+    cache->useCounter++;
+
+    FlowField *slot = &cache->fields[0];
+    for (int i = 0; i < FLOWFIELD_CACHE_SIZE; i++) {
+        FlowField *field = &cache->fields[i];
+
+        if (field->distance != NULL && field->goalCell == goalCell) {
+            field->lastUsed = cache->useCounter;
+            cache->hits++;
+            return goalCell;
+        }
+
+        // Free slots first, then the oldest request
+        if (slot->distance != NULL && (field->distance == NULL || field->lastUsed < slot->lastUsed)) {
+            slot = field;
+        }
+    }
+
+    int cellCount = grid->width * grid->depth;
+    if (slot->distance == NULL) {
+        slot->distance = (float *)malloc(sizeof(float) * cellCount);
+        slot->direction = (unsigned char *)malloc(sizeof(unsigned char) * cellCount);
+    }
+
+    slot->goalCell = goalCell;
+    slot->goal = goal;
+    slot->lastUsed = cache->useCounter;
+
+    if (slot->distance == NULL || slot->direction == NULL || !BuildFlowField(cache, grid, slot)) {
+        printf("Failed to allocate %dx%d flow field\n", grid->width, grid->depth);
+        free(slot->distance);
+        free(slot->direction);
+        slot->distance = NULL;
+        slot->direction = NULL;
+        return FLOWFIELD_NONE;
+    }
+
+    cache->builds++;
+    return goalCell;
+}
+
+// Function to look up a field without touching the LRU order
+const FlowField *FindFlowField(const FlowFieldCache *cache, int goalCell) {
+    if (goalCell == FLOWFIELD_NONE) return NULL;
+
+    for (int i = 0; i < FLOWFIELD_CACHE_SIZE; i++) {
+        if (cache->fields[i].distance != NULL && cache->fields[i].goalCell == goalCell) return &cache->fields[i];
+    }
+
+    return NULL;
+}
+
+// Function to sample the flow at a position, blending the four nearest cell centres
+bool GetFlowDirection(const FlowField *field, const NavGrid *grid, Vector3 position, Vector2 *direction, float *distance) {
+    int cell = GetNavCell(grid, position.x, position.z);
+    if (cell < 0 || (grid->flags[cell] & NAV_CELL_MULTILAYER)) return false;
+
+    unsigned char own = field->direction[cell];
+    if (own == FLOWFIELD_NO_DIRECTION) return false;
+
+    // Bilinear weights in cell-centre coordinates, so paths bend smoothly instead of in 45 degree steps
+    float gx = (position.x - grid->originX) / grid->cellSize - 0.5f;
+    float gz = (position.z - grid->originZ) / grid->cellSize - 0.5f;
+    int ix = (int)floorf(gx);
+    int iz = (int)floorf(gz);
+    float fx = gx - ix;
+    float fz = gz - iz;
+
+    float sumX = 0.0f;
+    float sumZ = 0.0f;
+    for (int corner = 0; corner < 4; corner++) {
+        int x = ix + (corner & 1);
+        int z = iz + (corner >> 1);
+        if (x < 0 || z < 0 || x >= grid->width || z >= grid->depth) continue;
+
+        unsigned char dir = field->direction[z * grid->width + x];
+        if (dir == FLOWFIELD_NO_DIRECTION) continue;
+
+        float weight = ((corner & 1) ? fx : 1.0f - fx) * ((corner >> 1) ? fz : 1.0f - fz);
+        sumX += neighborDirX[dir] * weight;
+        sumZ += neighborDirZ[dir] * weight;
+    }
+
+    // Opposing neighbours can cancel out, the cell's own direction is always valid
+    float length = sqrtf(sumX * sumX + sumZ * sumZ);
+    if (length < 0.01f) {
+        sumX = neighborDirX[own];
+        sumZ = neighborDirZ[own];
+        length = 1.0f;
+    }
+
+    *direction = (Vector2){ sumX / length, sumZ / length };
+    *distance = field->distance[cell];
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include "heightfield.h"
+
+// Flow field settings
+#define FLOWFIELD_MAX_CELLS (256 * 256)    // Nav cells cover more heightfield samples to stay under this
+#define FLOWFIELD_MAX_SLOPE 1.0f           // Height change per unit of distance a unit can walk up
+#define FLOWFIELD_CACHE_SIZE 16            // Fields kept, the least recently commanded one is replaced
+#define FLOWFIELD_NONE -1                  // No field (goal off the grid or on an unwalkable cell)
+#define FLOWFIELD_UNREACHABLE 1e30f        // Path length of cells with no path to the goal
+
+// Per-cell flags
+#define NAV_CELL_WALKABLE 0x01             // Every sample has a surface and no step is too steep
+#define NAV_CELL_MULTILAYER 0x02           // Bridges and overhangs, units there steer on their own
+
+// Walkability grid derived from the heightfield, cell (0, 0) starts at the origin
+typedef struct {
+    float originX;
+    float originZ;
+    float cellSize;
+    int width;                 // Cells along X
+    int depth;                 // Cells along Z
+    float *heights;            // Average surface height per cell
+    unsigned char *flags;      // NAV_CELL_* per cell
+    int walkableCells;
+} NavGrid;
+
+// Paths from every cell to one goal cell
+typedef struct {
+    int goalCell;              // Cache key, only meaningful while distance is allocated
+    Vector3 goal;              // World position the field was requested for
+    unsigned int lastUsed;     // Request stamp for LRU replacement
+    float *distance;           // Integration field: path length to the goal in world units, NULL in a free slot
+    unsigned char *direction;  // Neighbour to move to (0-7), 0xFF at the goal and on unreachable cells
+} FlowField;
+
+// Fields shared by every unit commanded to the same goal cell
+typedef struct {
+    FlowField fields[FLOWFIELD_CACHE_SIZE];
+    unsigned int useCounter;
+    int *heap;                 // Open list of the field build, grows as needed
+    float *heapCost;
+    int heapCapacity;
+    int builds;                // Requests that had to build a field
+    int hits;                  // Requests answered from the cache
+} FlowFieldCache;
+
+// Build the walkability grid from a heightfield (empty when the heightfield is)
+NavGrid LoadNavGrid(const Heightfield *heightfield);
+
+// Release nav grid memory
+void UnloadNavGrid(NavGrid *grid);
+
+// Free every cached field, needed whenever the nav grid changes
+void UnloadFlowFieldCache(FlowFieldCache *cache);
+
+// Get the field towards goal, building it if it is not cached; returns its goal cell or FLOWFIELD_NONE
+// Not thread safe: only call while no unit step reads the cache
+int RequestFlowField(FlowFieldCache *cache, const NavGrid *grid, Vector3 goal);
+
+// Cached field of a goal cell, NULL once it was replaced (read-only, safe from job threads)
+const FlowField *FindFlowField(const FlowFieldCache *cache, int goalCell);
+
+// Blended flow direction (XZ) and path length at a world position
+// Returns false off the grid, on unreachable or multi-layer cells and at the goal
+bool GetFlowDirection(const FlowField *field, const NavGrid *grid, Vector3 position, Vector2 *direction, float *distance);
+
+#endif // FLOWFIELD_H
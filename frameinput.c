@@ -0,0 +1,249 @@
+#include "frameinput.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Fields present in a frame record, after its mask byte and frame time
+// State fields (keys and buttons held, mouse position) are written when they changed since the last frame,
+// event fields (presses, releases, motion, wheel) when they are not zero; absent fields keep that value
+enum {
+    FRAME_RECORD_KEYS_DOWN = 1 << 0,
+    FRAME_RECORD_KEYS_PRESSED = 1 << 1,
+    FRAME_RECORD_KEYS_RELEASED = 1 << 2,
+    FRAME_RECORD_BUTTONS = 1 << 3,         // Down, pressed and released bytes together
+    FRAME_RECORD_MOUSE_POSITION = 1 << 4,
+    FRAME_RECORD_MOUSE_DELTA = 1 << 5,
+    FRAME_RECORD_MOUSE_WHEEL = 1 << 6,
+    FRAME_RECORD_SCENE_READY = 1 << 7      // No payload
+};
+
+// Largest frame record: mask, frame time and every field
+#define FRAME_RECORD_MAX_SIZE (1 + sizeof(float) + 3 * sizeof(unsigned int) * FRAME_INPUT_KEY_WORDS + 3 + 5 * sizeof(float))
+
+// Fixed-size header at the start of the file
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seed;
+    int32_t screenWidth;
+    int32_t screenHeight;
+} InputLogHeader;
+
+// Function to check whether any bit of a key bitset is set
+static bool HasKeyBits(const unsigned int *keys) {
+    for (int i = 0; i < FRAME_INPUT_KEY_WORDS; i++) {
+        if (keys[i] != 0) return true;
+    }
+    return false;
+}
+
+// Function to read every key and mouse button once
+FrameInput PollFrameInput(void) {
+    FrameInput input = {0};
+    input.frameTime = GetFrameTime();
+
+    for (int key = 0; key < FRAME_INPUT_KEY_COUNT; key++) {
+        unsigned int bit = 1u << (key % 32);
+        if (IsKeyDown(key)) input.keysDown[key / 32] |= bit;
+        if (IsKeyPressed(key)) input.keysPressed[key / 32] |= bit;
+        if (IsKeyReleased(key)) input.keysReleased[key / 32] |= bit;
+    }
+    for (int button = 0; button < FRAME_INPUT_BUTTON_COUNT; button++) {
+        unsigned char bit = (unsigned char)(1u << button);
+        if (IsMouseButtonDown(button)) input.buttonsDown |= bit;
+        if (IsMouseButtonPressed(button)) input.buttonsPressed |= bit;
+        if (IsMouseButtonReleased(button)) input.buttonsReleased |= bit;
+    }
+
+    input.mousePosition = GetMousePosition();
+    input.mouseDelta = GetMouseDelta();
+    input.mouseWheel = GetMouseWheelMove();
+    return input;
+}
+
+// Function to append bytes to a record
+static unsigned char *PutRecordBytes(unsigned char *out, const void *data, size_t size) {
+    memcpy(out, data, size);
+    return out + size;
+}
+
+// Function to encode a frame against the one before it, returns the record size
+static size_t EncodeFrameRecord(const FrameInput *input, const FrameInput *previous, unsigned char *record) {
+    unsigned char mask = 0;
+    if (memcmp(input->keysDown, previous->keysDown, sizeof(input->keysDown)) != 0) mask |= FRAME_RECORD_KEYS_DOWN;
+    if (HasKeyBits(input->keysPressed)) mask |= FRAME_RECORD_KEYS_PRESSED;
+    if (HasKeyBits(input->keysReleased)) mask |= FRAME_RECORD_KEYS_RELEASED;
+    if (input->buttonsDown != previous->buttonsDown || input->buttonsPressed != 0 || input->buttonsReleased != 0) {
+        mask |= FRAME_RECORD_BUTTONS;
+    }
+    if (input->mousePosition.x != previous->mousePosition.x || input->mousePosition.y != previous->mousePosition.y) {
+        mask |= FRAME_RECORD_MOUSE_POSITION;
+    }
+    if (input->mouseDelta.x != 0.0f || input->mouseDelta.y != 0.0f) mask |= FRAME_RECORD_MOUSE_DELTA;
+    if (input->mouseWheel != 0.0f) mask |= FRAME_RECORD_MOUSE_WHEEL;
+    if (input->sceneReady) mask |= FRAME_RECORD_SCENE_READY;
+
+    unsigned char *out = record;
+    *out++ = mask;
+    out = PutRecordBytes(out, &input->frameTime, sizeof(float));
+    if (mask & FRAME_RECORD_KEYS_DOWN) out = PutRecordBytes(out, input->keysDown, sizeof(input->keysDown));
+    if (mask & FRAME_RECORD_KEYS_PRESSED) out = PutRecordBytes(out, input->keysPressed, sizeof(input->keysPressed));
+    if (mask & FRAME_RECORD_KEYS_RELEASED) out = PutRecordBytes(out, input->keysReleased, sizeof(input->keysReleased));
+    if (mask & FRAME_RECORD_BUTTONS) {
+        *out++ = input->buttonsDown;
+        *out++ = input->buttonsPressed;
+        *out++ = input->buttonsReleased;
+    }
+    if (mask & FRAME_RECORD_MOUSE_POSITION) out = PutRecordBytes(out, &input->mousePosition, 2 * sizeof(float));
+    if (mask & FRAME_RECORD_MOUSE_DELTA) out = PutRecordBytes(out, &input->mouseDelta, 2 * sizeof(float));
+    if (mask & FRAME_RECORD_MOUSE_WHEEL) out = PutRecordBytes(out, &input->mouseWheel, sizeof(float));
+    return (size_t)(out - record);
+}
+
+// Function to take bytes from a record, false if the file ends first
+static bool GetRecordBytes(const unsigned char *data, size_t size, size_t *offset, void *out, size_t count) {
+    if (count > size - *offset) return false;
+    memcpy(out, data + *offset, count);
+    *offset += count;
+    return true;
+}
+
+// Function to decode the record at *offset, fields it leaves out come from the frame before it
+static bool DecodeFrameRecord(const unsigned char *data, size_t size, size_t *offset, const FrameInput *previous, FrameInput *input) {
+    size_t at = *offset;
+    unsigned char mask = 0;
+    FrameInput frame = {0};
+    memcpy(frame.keysDown, previous->keysDown, sizeof(frame.keysDown));
+    frame.buttonsDown = previous->buttonsDown;
+    frame.mousePosition = previous->mousePosition;
+
+    bool ok = GetRecordBytes(data, size, &at, &mask, 1) &&
+              GetRecordBytes(data, size, &at, &frame.frameTime, sizeof(float));
+    if (ok && (mask & FRAME_RECORD_KEYS_DOWN)) ok = GetRecordBytes(data, size, &at, frame.keysDown, sizeof(frame.keysDown));
+    if (ok && (mask & FRAME_RECORD_KEYS_PRESSED)) ok = GetRecordBytes(data, size, &at, frame.keysPressed, sizeof(frame.keysPressed));
+    if (ok && (mask & FRAME_RECORD_KEYS_RELEASED)) ok = GetRecordBytes(data, size, &at, frame.keysReleased, sizeof(frame.keysReleased));
+    if (ok && (mask & FRAME_RECORD_BUTTONS)) {
+        ok = GetRecordBytes(data, size, &at, &frame.buttonsDown, 1) &&
+             GetRecordBytes(data, size, &at, &frame.buttonsPressed, 1) &&
+             GetRecordBytes(data, size, &at, &frame.buttonsReleased, 1);
+    }
+    if (ok && (mask & FRAME_RECORD_MOUSE_POSITION)) ok = GetRecordBytes(data, size, &at, &frame.mousePosition, 2 * sizeof(float));
+    if (ok && (mask & FRAME_RECORD_MOUSE_DELTA)) ok = GetRecordBytes(data, size, &at, &frame.mouseDelta, 2 * sizeof(float));
+    if (ok && (mask & FRAME_RECORD_MOUSE_WHEEL)) ok = GetRecordBytes(data, size, &at, &frame.mouseWheel, sizeof(float));
+    if (!ok) return false;
+
+    frame.sceneReady = (mask & FRAME_RECORD_SCENE_READY) != 0;
+    *input = frame;
+    *offset = at;
+    return true;
+}
+
+// Function to create the log file and write its header
+bool BeginInputRecording(InputRecorder *recorder, const char *path, unsigned int seed, int screenWidth, int screenHeight) {
+    memset(recorder, 0, sizeof(*recorder));
+
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL) {
+        printf("Failed to create input log: %s\n", path);
+        return false;
+    }
+
+    InputLogHeader header = { FRAME_INPUT_LOG_MAGIC, FRAME_INPUT_LOG_VERSION, seed, screenWidth, screenHeight };
+    if (fwrite(&header, sizeof(header), 1, recorder->file) != 1) {
+        printf("Failed to write input log: %s\n", path);
+        fclose(recorder->file);
+        recorder->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Function to append one frame record
+void RecordFrameInput(InputRecorder *recorder, const FrameInput *input) {
+    if (recorder->file == NULL) return;
+
+    unsigned char record[FRAME_RECORD_MAX_SIZE];
+    size_t size = EncodeFrameRecord(input, &recorder->previous, record);
+    if (fwrite(record, 1, size, recorder->file) != size) {
+        printf("Failed to write input log, recording stopped after %d frames\n", recorder->frameCount);
+        fclose(recorder->file);
+        recorder->file = NULL;
+        return;
+    }
+
+    // Flushed regularly so a crash loses at most the last second of input
+    recorder->previous = *input;
+    recorder->frameCount++;
+    if (recorder->frameCount % FRAME_INPUT_FLUSH_FRAMES == 0) fflush(recorder->file);
+}
+
+// Function to close the log file
+void EndInputRecording(InputRecorder *recorder) {
+    if (recorder->file != NULL) {
+        fclose(recorder->file);
+        recorder->file = NULL;
+    }
+}
+
+// Function to read a log and count its complete frame records
+bool LoadInputReplay(InputReplay *replay, const char *path) {
+    memset(replay, 0, sizeof(*replay));
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Failed to open input log: %s\n", path);
+        return false;
+    }
+
+    long fileSize = -1;
+    if (fseek(file, 0, SEEK_END) == 0) fileSize = ftell(file);
+    if (fileSize < (long)sizeof(InputLogHeader) || fseek(file, 0, SEEK_SET) != 0) {
+        printf("Failed to read input log: %s\n", path);
+        fclose(file);
+        return false;
+    }
+
+    replay->size = (size_t)fileSize;
+    replay->data = (unsigned char *)malloc(replay->size);
+    bool ok = replay->data != NULL && fread(replay->data, 1, replay->size, file) == replay->size;
+    fclose(file);
+
+    InputLogHeader header = {0};
+    if (ok) memcpy(&header, replay->data, sizeof(header));
+    if (!ok || header.magic != FRAME_INPUT_LOG_MAGIC || header.version != FRAME_INPUT_LOG_VERSION) {
+        printf("Failed to load input log (not a version %d log): %s\n", FRAME_INPUT_LOG_VERSION, path);
+        UnloadInputReplay(replay);
+        return false;
+    }
+    replay->seed = header.seed;
+    replay->screenWidth = header.screenWidth;
+    replay->screenHeight = header.screenHeight;
+
+    // A record cut off at the end of the file is dropped
+    size_t offset = sizeof(InputLogHeader);
+    FrameInput previous = {0};
+    FrameInput frame;
+    while (DecodeFrameRecord(replay->data, replay->size, &offset, &previous, &frame)) {
+        previous = frame;
+        replay->frameCount++;
+    }
+
+    replay->offset = sizeof(InputLogHeader);
+    return true;
+}
+
+// Function to decode the next frame record
+bool ReadReplayFrameInput(InputReplay *replay, FrameInput *input) {
+    if (replay->frame >= replay->frameCount) return false;
+    if (!DecodeFrameRecord(replay->data, replay->size, &replay->offset, &replay->previous, input)) return false;
+
+    replay->previous = *input;
+    replay->frame++;
+    return true;
+}
+
+// Function to free the log data
+void UnloadInputReplay(InputReplay *replay) {
+    free(replay->data);
+    memset(replay, 0, sizeof(*replay));
+}
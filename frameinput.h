@@ -0,0 +1,89 @@
+#ifndef FRAMEINPUT_H
+#define FRAMEINPUT_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Frame input settings
+#define FRAME_INPUT_KEY_COUNT (KEY_KB_MENU + 1)                  // Every raylib key code
+#define FRAME_INPUT_KEY_WORDS ((FRAME_INPUT_KEY_COUNT + 31) / 32)
+#define FRAME_INPUT_BUTTON_COUNT (MOUSE_BUTTON_BACK + 1)         // Every raylib mouse button, one bit each
+#define FRAME_INPUT_LOG_MAGIC 0x49565447u                        // "GTVI" read as a little-endian int
+#define FRAME_INPUT_LOG_VERSION 1                                // Bump whenever the frame record changes
+#define FRAME_INPUT_FLUSH_FRAMES 60                              // Recorded frames kept in the stdio buffer at most
+
+// Everything the viewer reads from the keyboard and mouse in one frame, plus the frame time
+typedef struct {
+    float frameTime;                                 // GetFrameTime, in seconds
+    unsigned int keysDown[FRAME_INPUT_KEY_WORDS];    // One bit per key code
+    unsigned int keysPressed[FRAME_INPUT_KEY_WORDS];
+    unsigned int keysReleased[FRAME_INPUT_KEY_WORDS];
+    unsigned char buttonsDown;                       // One bit per mouse button
+    unsigned char buttonsPressed;
+    unsigned char buttonsReleased;
+    Vector2 mousePosition;
+    Vector2 mouseDelta;
+    float mouseWheel;
+    bool sceneReady;           // The background scene build was collected this frame, replays collect it on the same frame
+} FrameInput;
+
+// Input log being written, one record per frame
+typedef struct {
+    FILE *file;
+    FrameInput previous;       // Fields that didn't change since this frame are left out of the next record
+    int frameCount;
+} InputRecorder;
+
+// Input log being played back
+typedef struct {
+    unsigned char *data;       // Whole file
+    size_t size;
+    size_t offset;             // Start of the next frame record
+    unsigned int seed;         // SetRandomSeed of the recorded run
+    int screenWidth;           // Window size of the recorded run
+    int screenHeight;
+    int frameCount;            // Complete records, a log cut short by a crash keeps every frame before it
+    int frame;                 // Frames read so far
+    FrameInput previous;
+} InputReplay;
+
+// Read this frame's input from raylib
+FrameInput PollFrameInput(void);
+
+// Start a log at path for a run seeded with seed, returns false if the file can't be created
+bool BeginInputRecording(InputRecorder *recorder, const char *path, unsigned int seed, int screenWidth, int screenHeight);
+
+// Append a frame to the log (stops recording if the write fails)
+void RecordFrameInput(InputRecorder *recorder, const FrameInput *input);
+
+// Flush and close the log
+void EndInputRecording(InputRecorder *recorder);
+
+// Read a whole log into memory, returns false if it is missing or not an input log of this version
+bool LoadInputReplay(InputReplay *replay, const char *path);
+
+// Read the next recorded frame, returns false once every frame was read
+bool ReadReplayFrameInput(InputReplay *replay, FrameInput *input);
+
+// Release the log
+void UnloadInputReplay(InputReplay *replay);
+
+// Key and mouse button queries on a frame's input, taking raylib's KEY_* and MOUSE_BUTTON_* codes
+static inline bool GetFrameInputKey(const unsigned int *keys, int key) {
+    return key >= 0 && key < FRAME_INPUT_KEY_COUNT && ((keys[key / 32] >> (key % 32)) & 1u);
+}
+
+static inline bool GetFrameInputButton(unsigned char buttons, int button) {
+    return button >= 0 && button < FRAME_INPUT_BUTTON_COUNT && ((buttons >> button) & 1u);
+}
+
+static inline bool IsInputKeyDown(const FrameInput *input, int key) { return GetFrameInputKey(input->keysDown, key); }
+static inline bool IsInputKeyPressed(const FrameInput *input, int key) { return GetFrameInputKey(input->keysPressed, key); }
+static inline bool IsInputKeyReleased(const FrameInput *input, int key) { return GetFrameInputKey(input->keysReleased, key); }
+static inline bool IsInputButtonDown(const FrameInput *input, int button) { return GetFrameInputButton(input->buttonsDown, button); }
+static inline bool IsInputButtonPressed(const FrameInput *input, int button) { return GetFrameInputButton(input->buttonsPressed, button); }
+static inline bool IsInputButtonReleased(const FrameInput *input, int button) { return GetFrameInputButton(input->buttonsReleased, button); }
+
+#endif // FRAMEINPUT_H
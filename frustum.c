@@ -0,0 +1,125 @@
+#include "frustum.h"
+#include <rlgl.h>
+#include <raymath.h>
+#include <math.h>
+
+// Function to build the same projection BeginMode3D sets up
+Matrix GetCameraViewProjection(Camera3D camera, double aspect) {
+    Matrix projection;
+
+    if (camera.projection == CAMERA_ORTHOGRAPHIC) {
+        double top = camera.fovy / 2.0;
+        projection = MatrixOrtho(-top * aspect, top * aspect, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    } else {
+        projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    }
+
+    return MatrixMultiply(GetCameraMatrix(camera), projection);
+}
+
+// Function to scale a plane so its normal has unit length
+static Vector4 NormalizePlane(Vector4 plane) {
+    float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    if (length > 0.0f) {
+        plane.x /= length;
+        plane.y /= length;
+        plane.z /= length;
+        plane.w /= length;
+    }
+    return plane;
+}
+
+// Function to extract the frustum planes from a view-projection matrix (Gribb/Hartmann)
+static Frustum GetMatrixFrustum(Matrix m) {
+    Frustum frustum = {0};
+
+    // Rows of the matrix as it transforms column vectors
+    Vector4 row0 = { m.m0, m.m4, m.m8, m.m12 };
+    Vector4 row1 = { m.m1, m.m5, m.m9, m.m13 };
+    Vector4 row2 = { m.m2, m.m6, m.m10, m.m14 };
+    Vector4 row3 = { m.m3, m.m7, m.m11, m.m15 };
+
+    frustum.planes[FRUSTUM_LEFT] = NormalizePlane((Vector4){ row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w });
+    frustum.planes[FRUSTUM_RIGHT] = NormalizePlane((Vector4){ row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w });
+    frustum.planes[FRUSTUM_BOTTOM] = NormalizePlane((Vector4){ row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w });
+    frustum.planes[FRUSTUM_TOP] = NormalizePlane((Vector4){ row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w });
+    frustum.planes[FRUSTUM_NEAR] = NormalizePlane((Vector4){ row3.x + row2.x, row3.y + row2.y, row3.z + row2.z, row3.w + row2.w });
+    frustum.planes[FRUSTUM_FAR] = NormalizePlane((Vector4){ row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w });
+
+    // Unproject the clip-space cube corners for the bounding box
+    Matrix inverse = MatrixInvert(m);
+    frustum.bounds.min = (Vector3){ INFINITY, INFINITY, INFINITY };
+    frustum.bounds.max = (Vector3){ -INFINITY, -INFINITY, -INFINITY };
+
+    for (int corner = 0; corner < 8; corner++) {
+        float x = (corner & 1) ? 1.0f : -1.0f;
+        float y = (corner & 2) ? 1.0f : -1.0f;
+        float z = (corner & 4) ? 1.0f : -1.0f;
+
+        float w = inverse.m3 * x + inverse.m7 * y + inverse.m11 * z + inverse.m15;
+        Vector3 p = {
+            (inverse.m0 * x + inverse.m4 * y + inverse.m8 * z + inverse.m12) / w,
+            (inverse.m1 * x + inverse.m5 * y + inverse.m9 * z + inverse.m13) / w,
+            (inverse.m2 * x + inverse.m6 * y + inverse.m10 * z + inverse.m14) / w
+        };
+        frustum.bounds.min = Vector3Min(frustum.bounds.min, p);
+        frustum.bounds.max = Vector3Max(frustum.bounds.max, p);
+    }
+
+    return frustum;
+}
+
+// Function to extract the frustum BeginMode3D renders with
+Frustum GetCameraFrustum(Camera3D camera, double aspect) {
+    return GetMatrixFrustum(GetCameraViewProjection(camera, aspect));
+}
+
+// Function to extract the frustum of a screen rectangle by zooming the projection onto it
+Frustum GetScreenRectFrustum(Camera3D camera, int screenWidth, int screenHeight, Rectangle rect) {
+    Matrix m = GetCameraViewProjection(camera, (double)screenWidth / (double)screenHeight);
+
+    // Normalized device range of the rectangle, screen y grows downwards
+    double left = 2.0 * rect.x / screenWidth - 1.0;
+    double right = 2.0 * (rect.x + rect.width) / screenWidth - 1.0;
+    double top = 1.0 - 2.0 * rect.y / screenHeight;
+    double bottom = 1.0 - 2.0 * (rect.y + rect.height) / screenHeight;
+
+    // Map that range onto [-1, 1]: x' = sx * x + tx * w, so the regular plane extraction clips to it
+    float sx = (float)(2.0 / (right - left));
+    float tx = (float)(-(right + left) / (right - left));
+    float sy = (float)(2.0 / (top - bottom));
+    float ty = (float)(-(top + bottom) / (top - bottom));
+
+    m.m0 = sx * m.m0 + tx * m.m3;
+    m.m4 = sx * m.m4 + tx * m.m7;
+    m.m8 = sx * m.m8 + tx * m.m11;
+    m.m12 = sx * m.m12 + tx * m.m15;
+    m.m1 = sy * m.m1 + ty * m.m3;
+    m.m5 = sy * m.m5 + ty * m.m7;
+    m.m9 = sy * m.m9 + ty * m.m11;
+    m.m13 = sy * m.m13 + ty * m.m15;
+
+    return GetMatrixFrustum(m);
+}
+
+// Function to test the box corner furthest along each plane normal
+bool IsBoxInFrustum(const Frustum *frustum, BoundingBox box) {
+    for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+        Vector4 plane = frustum->planes[i];
+        float x = (plane.x >= 0.0f) ? box.max.x : box.min.x;
+        float y = (plane.y >= 0.0f) ? box.max.y : box.min.y;
+        float z = (plane.z >= 0.0f) ? box.max.z : box.min.z;
+
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
+// Function to test a sphere against every plane
+bool IsSphereInFrustum(const Frustum *frustum, Vector3 center, float radius) {
+    for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+        Vector4 plane = frustum->planes[i];
+        if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius) return false;
+    }
+    return true;
+}
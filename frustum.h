@@ -0,0 +1,39 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <raylib.h>
+#include <stdbool.h>
+
+// Frustum planes, in the order they are extracted
+typedef enum {
+    FRUSTUM_LEFT,
+    FRUSTUM_RIGHT,
+    FRUSTUM_BOTTOM,
+    FRUSTUM_TOP,
+    FRUSTUM_NEAR,
+    FRUSTUM_FAR,
+    FRUSTUM_PLANE_COUNT
+} FrustumPlane;
+
+// View volume of a camera as six inward-facing planes (xyz = unit normal, w = distance)
+typedef struct {
+    Vector4 planes[FRUSTUM_PLANE_COUNT];
+    BoundingBox bounds;        // World-space box around the eight frustum corners
+} Frustum;
+
+// View-projection matrix BeginMode3D uses for this camera and aspect ratio
+Matrix GetCameraViewProjection(Camera3D camera, double aspect);
+
+// Extract the frustum BeginMode3D will render with
+Frustum GetCameraFrustum(Camera3D camera, double aspect);
+
+// Extract the frustum of the part of the view inside a screen rectangle (pixels, non-empty), for box selection
+Frustum GetScreenRectFrustum(Camera3D camera, int screenWidth, int screenHeight, Rectangle rect);
+
+// Check whether a box may be visible (conservative, boxes near corners can pass)
+bool IsBoxInFrustum(const Frustum *frustum, BoundingBox box);
+
+// Check whether a sphere may be visible
+bool IsSphereInFrustum(const Frustum *frustum, Vector3 center, float radius);
+
+#endif // FRUSTUM_H
@@ -0,0 +1,964 @@
+#include "gltfdecode.h"
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// GLB container
+#define GLB_MAGIC 0x46546C67           // "glTF"
+#define GLB_CHUNK_JSON 0x4E4F534A
+#define GLB_CHUNK_BIN 0x004E4942
+#define GLB_HEADER_SIZE 12
+#define GLB_CHUNK_HEADER_SIZE 8
+
+// meshoptimizer codec constants (bitstream versions fixed by the EXT_meshopt_compression spec)
+#define MESHOPT_VERTEX_HEADER 0xa0
+#define MESHOPT_INDEX_HEADER 0xe0
+#define MESHOPT_SEQUENCE_HEADER 0xd0
+#define MESHOPT_VERTEX_BLOCK_BYTES 8192
+#define MESHOPT_VERTEX_BLOCK_MAX 256
+#define MESHOPT_BYTE_GROUP 16
+#define MESHOPT_BYTE_GROUP_LIMIT 24        // Most bytes one byte group can read
+#define MESHOPT_TAIL_MAX 32
+
+// Compressed view data layout
+typedef enum {
+    MESHOPT_MODE_ATTRIBUTES,
+    MESHOPT_MODE_TRIANGLES,
+    MESHOPT_MODE_INDICES
+} MeshoptMode;
+
+// Transform applied to decoded attributes
+typedef enum {
+    MESHOPT_FILTER_NONE,
+    MESHOPT_FILTER_OCTAHEDRAL,
+    MESHOPT_FILTER_QUATERNION,
+    MESHOPT_FILTER_EXPONENTIAL
+} MeshoptFilter;
+
+// One buffer view to decode
+typedef struct {
+    int view;                  // Index in the glTF bufferViews array
+    const char *object;        // The view's JSON object
+    const unsigned char *source;
+    int sourceSize;
+    int targetOffset;          // In the rewritten binary chunk
+    int count;
+    int stride;
+    int mode;                  // MeshoptMode
+    int filter;                // MeshoptFilter
+    int result;                // 0 once decoded, negative codec error otherwise
+    unsigned char *target;
+} CompressedView;
+
+// Material texture raylib's glTF loader reads, and the material map it goes to
+typedef struct {
+    const char *parent;        // Object inside the material holding it, NULL for the material itself
+    const char *name;
+    int map;                   // MATERIAL_MAP_*
+} GltfTextureSlot;
+
+static const GltfTextureSlot gltfTextureSlots[] = {
+    { "pbrMetallicRoughness", "baseColorTexture", MATERIAL_MAP_ALBEDO },
+    { "pbrMetallicRoughness", "metallicRoughnessTexture", MATERIAL_MAP_ROUGHNESS },
+    { NULL, "normalTexture", MATERIAL_MAP_NORMAL },
+    { NULL, "occlusionTexture", MATERIAL_MAP_OCCLUSION },
+    { NULL, "emissiveTexture", MATERIAL_MAP_EMISSION },
+};
+
+#define GLTF_TEXTURE_SLOT_COUNT ((int)(sizeof(gltfTextureSlots) / sizeof(gltfTextureSlots[0])))
+
+// Replacement of the JSON text [start, end)
+typedef struct {
+    const char *start;
+    const char *end;
+    char text[48];
+} JsonEdit;
+
+// Function to skip JSON whitespace
+static const char *SkipJsonSpace(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    return p;
+}
+
+// Function to skip a JSON string starting at its opening quote, returns the position after it or NULL
+static const char *SkipJsonString(const char *p, const char *end) {
+    for (p++; p < end; p++) {
+        if (*p == '\\') p++;
+        else if (*p == '"') return p + 1;
+    }
+    return NULL;
+}
+
+// Function to skip one JSON value, returns the position after it or NULL on malformed input
+static const char *SkipJsonValue(const char *p, const char *end) {
+    if (p >= end) return NULL;
+    if (*p == '"') return SkipJsonString(p, end);
+
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            if (*p == '"') {
+                p = SkipJsonString(p, end);
+                if (p == NULL) return NULL;
+                continue;
+            }
+            if (*p == '{' || *p == '[') depth++;
+            else if (*p == '}' || *p == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            p++;
+        }
+        return NULL;
+    }
+
+    // Number or literal
+    const char *start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') p++;
+    return (p > start) ? p : NULL;
+}
+
+// Function to check whether a JSON string value holds exactly text
+static bool IsJsonString(const char *value, const char *end, const char *text) {
+    size_t length = strlen(text);
+    return value != NULL && *value == '"' && value + length + 2 <= end &&
+           strncmp(value + 1, text, length) == 0 && value[length + 1] == '"';
+}
+
+// Function to find a member of a JSON object, returns its value or NULL (and its quoted key in *key when given)
+static const char *FindJsonMemberKey(const char *object, const char *end, const char *name, const char **key) {
+    if (object == NULL || *object != '{') return NULL;
+
+    const char *p = SkipJsonSpace(object + 1, end);
+    while (p < end && *p == '"') {
+        const char *member = p;
+        p = SkipJsonString(p, end);
+        if (p == NULL) return NULL;
+
+        p = SkipJsonSpace(p, end);
+        if (p >= end || *p != ':') return NULL;
+        p = SkipJsonSpace(p + 1, end);
+        if (IsJsonString(member, end, name)) {
+            if (key != NULL) *key = member;
+            return p;
+        }
+
+        p = SkipJsonValue(p, end);
+        if (p == NULL) return NULL;
+        p = SkipJsonSpace(p, end);
+        if (p < end && *p == ',') p = SkipJsonSpace(p + 1, end);
+    }
+    return NULL;
+}
+
+// Function to find a member of a JSON object, returns its value or NULL
+static const char *FindJsonMember(const char *object, const char *end, const char *name) {
+    return FindJsonMemberKey(object, end, name, NULL);
+}
+
+// Function to get an element of a JSON array, NULL past the end
+static const char *GetJsonElement(const char *array, const char *end, int index) {
+    if (array == NULL || *array != '[') return NULL;
+
+    const char *p = SkipJsonSpace(array + 1, end);
+    for (int i = 0; p < end && *p != ']'; i++) {
+        if (i == index) return p;
+
+        p = SkipJsonValue(p, end);
+        if (p == NULL) return NULL;
+        p = SkipJsonSpace(p, end);
+        if (p < end && *p == ',') p = SkipJsonSpace(p + 1, end);
+    }
+    return NULL;
+}
+
+// Function to read an integer member, fallback when it is missing
+// Parsed by hand up to end since the JSON chunk is not NUL-terminated, values too large saturate like strtoll
+static long long GetJsonInteger(const char *object, const char *end, const char *name, long long fallback) {
+    const char *value = FindJsonMember(object, end, name);
+    if (value == NULL || value >= end) return fallback;
+
+    bool negative = (*value == '-');
+    if (negative) value++;
+    if (value >= end || *value < '0' || *value > '9') return fallback;
+
+    long long result = 0;
+    for (; value < end && *value >= '0' && *value <= '9'; value++) {
+        int digit = *value - '0';
+        if (result > (LLONG_MAX - digit) / 10) return negative ? LLONG_MIN : LLONG_MAX;
+        result = result * 10 + digit;
+    }
+    return negative ? -result : result;
+}
+
+// Function to check whether the model lists extension in extensionsRequired
+static bool IsGltfExtensionRequired(const char *json, const char *end, const char *extension) {
+    const char *required = FindJsonMember(json, end, "extensionsRequired");
+    for (int i = 0;; i++) {
+        const char *element = GetJsonElement(required, end, i);
+        if (element == NULL) return false;
+        if (IsJsonString(element, end, extension)) return true;
+    }
+}
+
+// Function to read a meshoptimizer variable-length integer
+static unsigned int DecodeVByte(const unsigned char **data) {
+    unsigned char lead = *(*data)++;
+    if (lead < 128) return lead;
+
+    unsigned int result = lead & 127;
+    unsigned int shift = 7;
+    for (int i = 0; i < 4; i++) {
+        unsigned char group = *(*data)++;
+        result |= (unsigned int)(group & 127) << shift;
+        shift += 7;
+        if (group < 128) break;
+    }
+    return result;
+}
+
+// Function to read a zigzag delta against the last free index
+static unsigned int DecodeIndexDelta(const unsigned char **data, unsigned int last) {
+    unsigned int v = DecodeVByte(data);
+    unsigned int delta = (v >> 1) ^ (0u - (v & 1));
+    return last + delta;
+}
+
+// Function to store one decoded index
+static void WriteIndex(unsigned char *target, int stride, int index, unsigned int value) {
+    if (stride == 2) ((unsigned short *)target)[index] = (unsigned short)value;
+    else ((unsigned int *)target)[index] = value;
+}
+
+// Function to decode a triangle list encoded with meshopt_encodeIndexBuffer, returns 0 or a negative error
+static int DecodeMeshoptTriangles(unsigned char *target, int indexCount, int stride, const unsigned char *buffer, int bufferSize) {
+    if (indexCount % 3 != 0 || (stride != 2 && stride != 4)) return -1;
+    if (bufferSize < 1 + indexCount / 3 + 16) return -2;
+    if ((buffer[0] & 0xf0) != MESHOPT_INDEX_HEADER || (buffer[0] & 0x0f) > 1) return -1;
+
+    unsigned int edgeFifo[16][2];
+    unsigned int vertexFifo[16];
+    memset(edgeFifo, 0xff, sizeof(edgeFifo));
+    memset(vertexFifo, 0xff, sizeof(vertexFifo));
+    unsigned int edgeOffset = 0;
+    unsigned int vertexOffset = 0;
+    unsigned int next = 0;
+    unsigned int last = 0;
+    int fecMax = ((buffer[0] & 0x0f) >= 1) ? 13 : 15;
+
+    // Triangle codes first, then free indices; the 16-byte code table at the end bounds every read
+    const unsigned char *code = buffer + 1;
+    const unsigned char *data = code + indexCount / 3;
+    const unsigned char *dataSafeEnd = buffer + bufferSize - 16;
+    const unsigned char *codeAux = dataSafeEnd;
+
+    for (int i = 0; i < indexCount; i += 3) {
+        if (data > dataSafeEnd) return -2;
+
+        unsigned char codeTri = *code++;
+        unsigned int a, b, c;
+
+        if (codeTri < 0xf0) {
+            // Edge from the edge FIFO, third vertex new, from the vertex FIFO or a free index
+            int fe = codeTri >> 4;
+            a = edgeFifo[(edgeOffset - 1 - fe) & 15][0];
+            b = edgeFifo[(edgeOffset - 1 - fe) & 15][1];
+
+            int fec = codeTri & 15;
+            if (fec < fecMax) {
+                c = (fec == 0) ? next : vertexFifo[(vertexOffset - 1 - fec) & 15];
+                if (fec == 0) next++;
+                vertexFifo[vertexOffset] = c;
+                vertexOffset = (vertexOffset + (fec == 0)) & 15;
+            } else {
+                // 13 and 14 are -1 and +1 from the last free index
+                last = c = (fec != 15) ? last + (unsigned int)(fec - (fec ^ 3)) : DecodeIndexDelta(&data, last);
+                vertexFifo[vertexOffset] = c;
+                vertexOffset = (vertexOffset + 1) & 15;
+            }
+
+            edgeFifo[edgeOffset][0] = c; edgeFifo[edgeOffset][1] = b; edgeOffset = (edgeOffset + 1) & 15;
+            edgeFifo[edgeOffset][0] = a; edgeFifo[edgeOffset][1] = c; edgeOffset = (edgeOffset + 1) & 15;
+        } else {
+            int feb, fec;
+            bool freeA = false;
+
+            if (codeTri < 0xfe) {
+                // All three vertices from the table: next or FIFO entries
+                unsigned char aux = codeAux[codeTri & 15];
+                feb = aux >> 4;
+                fec = aux & 15;
+
+                a = next++;
+                b = (feb == 0) ? next : vertexFifo[(vertexOffset - feb) & 15];
+                if (feb == 0) next++;
+                c = (fec == 0) ? next : vertexFifo[(vertexOffset - fec) & 15];
+                if (fec == 0) next++;
+            } else {
+                // Explicit code byte, 15 means a free index; a code of 0 restarts the vertex counter
+                unsigned char aux = *data++;
+                freeA = (codeTri != 0xfe);
+                feb = aux >> 4;
+                fec = aux & 15;
+                if (aux == 0) next = 0;
+
+                a = freeA ? 0 : next++;
+                b = (feb == 0) ? next++ : vertexFifo[(vertexOffset - feb) & 15];
+                c = (fec == 0) ? next++ : vertexFifo[(vertexOffset - fec) & 15];
+
+                if (freeA) last = a = DecodeIndexDelta(&data, last);
+                if (feb == 15) last = b = DecodeIndexDelta(&data, last);
+                if (fec == 15) last = c = DecodeIndexDelta(&data, last);
+            }
+
+            vertexFifo[vertexOffset] = a;
+            vertexOffset = (vertexOffset + 1) & 15;
+            vertexFifo[vertexOffset] = b;
+            vertexOffset = (vertexOffset + ((feb == 0) | (feb == 15))) & 15;
+            vertexFifo[vertexOffset] = c;
+            vertexOffset = (vertexOffset + ((fec == 0) | (fec == 15))) & 15;
+
+            edgeFifo[edgeOffset][0] = b; edgeFifo[edgeOffset][1] = a; edgeOffset = (edgeOffset + 1) & 15;
+            edgeFifo[edgeOffset][0] = c; edgeFifo[edgeOffset][1] = b; edgeOffset = (edgeOffset + 1) & 15;
+            edgeFifo[edgeOffset][0] = a; edgeFifo[edgeOffset][1] = c; edgeOffset = (edgeOffset + 1) & 15;
+        }
+
+        WriteIndex(target, stride, i, a);
+        WriteIndex(target, stride, i + 1, b);
+        WriteIndex(target, stride, i + 2, c);
+    }
+
+    return (data == dataSafeEnd) ? 0 : -3;
+}
+
+// Function to decode an index sequence encoded with meshopt_encodeIndexSequence, returns 0 or a negative error
+static int DecodeMeshoptIndices(unsigned char *target, int indexCount, int stride, const unsigned char *buffer, int bufferSize) {
+    if (stride != 2 && stride != 4) return -1;
+    if (bufferSize < 1 + indexCount + 4) return -2;
+    if ((buffer[0] & 0xf0) != MESHOPT_SEQUENCE_HEADER || (buffer[0] & 0x0f) > 1) return -1;
+
+    // Two baselines, the low bit of each value picks one; the 4-byte tail bounds every read
+    const unsigned char *data = buffer + 1;
+    const unsigned char *dataSafeEnd = buffer + bufferSize - 4;
+    unsigned int last[2] = { 0, 0 };
+
+    for (int i = 0; i < indexCount; i++) {
+        if (data >= dataSafeEnd) return -2;
+
+        unsigned int v = DecodeVByte(&data);
+        unsigned int baseline = v & 1;
+        v >>= 1;
+
+        unsigned int index = last[baseline] + ((v >> 1) ^ (0u - (v & 1)));
+        last[baseline] = index;
+        WriteIndex(target, stride, i, index);
+    }
+
+    return (data == dataSafeEnd) ? 0 : -3;
+}
+
+// Function to decode 16 bytes stored with 0, 2, 4 or 8 bits each; values at the bit limit follow as whole bytes
+static const unsigned char *DecodeByteGroup(const unsigned char *data, unsigned char *group, int bitsLog2) {
+    if (bitsLog2 == 0) {
+        memset(group, 0, MESHOPT_BYTE_GROUP);
+        return data;
+    }
+    if (bitsLog2 == 3) {
+        memcpy(group, data, MESHOPT_BYTE_GROUP);
+        return data + MESHOPT_BYTE_GROUP;
+    }
+
+    int bits = (bitsLog2 == 1) ? 2 : 4;
+    int escape = (1 << bits) - 1;
+    const unsigned char *extra = data + MESHOPT_BYTE_GROUP * bits / 8;
+    for (int i = 0; i < MESHOPT_BYTE_GROUP; i++) {
+        int shift = 8 - bits - (i * bits) % 8;
+        int value = (data[i * bits / 8] >> shift) & escape;
+        group[i] = (value == escape) ? *extra++ : (unsigned char)value;
+    }
+    return extra;
+}
+
+// Function to decode one byte of every vertex in a block, returns NULL if the data runs out
+static const unsigned char *DecodeByteStream(const unsigned char *data, const unsigned char *dataEnd, unsigned char *bytes, int byteCount) {
+    // Two header bits per group select its bit width
+    int headerSize = (byteCount / MESHOPT_BYTE_GROUP + 3) / 4;
+    if (dataEnd - data < headerSize) return NULL;
+
+    const unsigned char *header = data;
+    data += headerSize;
+    for (int i = 0; i < byteCount; i += MESHOPT_BYTE_GROUP) {
+        if (dataEnd - data < MESHOPT_BYTE_GROUP_LIMIT) return NULL;
+
+        int group = i / MESHOPT_BYTE_GROUP;
+        int bitsLog2 = (header[group / 4] >> ((group % 4) * 2)) & 3;
+        data = DecodeByteGroup(data, bytes + i, bitsLog2);
+    }
+    return data;
+}
+
+// Function to decode a vertex buffer encoded with meshopt_encodeVertexBuffer, returns 0 or a negative error
+static int DecodeMeshoptVertices(unsigned char *target, int vertexCount, int stride, const unsigned char *buffer, int bufferSize) {
+    if (stride <= 0 || stride > 256 || stride % 4 != 0) return -1;
+    if (bufferSize < 1 + stride) return -2;
+    if (buffer[0] != MESHOPT_VERTEX_HEADER) return -1;
+
+    const unsigned char *data = buffer + 1;
+    const unsigned char *dataEnd = buffer + bufferSize;
+
+    // Bytes are delta coded against the previous vertex, the first one of the buffer against the tail
+    unsigned char lastVertex[256];
+    memcpy(lastVertex, dataEnd - stride, stride);
+
+    int blockSize = (MESHOPT_VERTEX_BLOCK_BYTES / stride) & ~(MESHOPT_BYTE_GROUP - 1);
+    if (blockSize > MESHOPT_VERTEX_BLOCK_MAX) blockSize = MESHOPT_VERTEX_BLOCK_MAX;
+
+    unsigned char bytes[MESHOPT_VERTEX_BLOCK_MAX];
+    for (int first = 0; first < vertexCount; first += blockSize) {
+        int count = (vertexCount - first < blockSize) ? vertexCount - first : blockSize;
+        int alignedCount = (count + MESHOPT_BYTE_GROUP - 1) & ~(MESHOPT_BYTE_GROUP - 1);
+        unsigned char *block = target + (size_t)first * stride;
+
+        for (int k = 0; k < stride; k++) {
+            data = DecodeByteStream(data, dataEnd, bytes, alignedCount);
+            if (data == NULL) return -2;
+
+            unsigned char previous = lastVertex[k];
+            for (int i = 0; i < count; i++) {
+                unsigned char zigzag = bytes[i];
+                unsigned char value = (unsigned char)((0u - (zigzag & 1)) ^ (zigzag >> 1)) + previous;
+                block[i * stride + k] = value;
+                previous = value;
+            }
+        }
+
+        memcpy(lastVertex, block + (size_t)(count - 1) * stride, stride);
+    }
+
+    int tailSize = (stride < MESHOPT_TAIL_MAX) ? MESHOPT_TAIL_MAX : stride;
+    return (dataEnd - data == tailSize) ? 0 : -3;
+}
+
+// Function to turn octahedral-encoded normals (8 or 16-bit) back into unit vectors of the same width
+static void DecodeOctahedralFilter(unsigned char *target, int count, int stride) {
+    float limit = (stride == 4) ? 127.0f : 32767.0f;
+
+    for (int i = 0; i < count; i++) {
+        float v[3];
+        for (int k = 0; k < 3; k++) {
+            v[k] = (stride == 4) ? (float)((signed char *)target)[i * 4 + k] : (float)((short *)target)[i * 4 + k];
+        }
+
+        // z encodes 1 at the same precision, fold the lower hemisphere back
+        float z = v[2] - fabsf(v[0]) - fabsf(v[1]);
+        float t = (z >= 0.0f) ? 0.0f : z;
+        float x = v[0] + ((v[0] >= 0.0f) ? t : -t);
+        float y = v[1] + ((v[1] >= 0.0f) ? t : -t);
+
+        float length = sqrtf(x * x + y * y + z * z);
+        float scale = (length > 0.0f) ? limit / length : 0.0f;
+        float n[3] = { x * scale, y * scale, z * scale };
+        for (int k = 0; k < 3; k++) {
+            int value = (int)(n[k] + ((n[k] >= 0.0f) ? 0.5f : -0.5f));
+            if (stride == 4) ((signed char *)target)[i * 4 + k] = (signed char)value;
+            else ((short *)target)[i * 4 + k] = (short)value;
+        }
+    }
+}
+
+// Function to rebuild quaternions stored as three components and the index of the dropped largest one
+static void DecodeQuaternionFilter(short *target, int count) {
+    for (int i = 0; i < count; i++) {
+        short *q = target + i * 4;
+        float scale = 0.70710678f / (float)(q[3] | 3);
+        float x = q[0] * scale;
+        float y = q[1] * scale;
+        float z = q[2] * scale;
+        float ww = 1.0f - x * x - y * y - z * z;
+        float w = sqrtf((ww >= 0.0f) ? ww : 0.0f);
+        int dropped = q[3] & 3;
+
+        short xq = (short)(int)(x * 32767.0f + ((x >= 0.0f) ? 0.5f : -0.5f));
+        short yq = (short)(int)(y * 32767.0f + ((y >= 0.0f) ? 0.5f : -0.5f));
+        short zq = (short)(int)(z * 32767.0f + ((z >= 0.0f) ? 0.5f : -0.5f));
+        short wq = (short)(int)(w * 32767.0f + 0.5f);
+        q[(dropped + 1) & 3] = xq;
+        q[(dropped + 2) & 3] = yq;
+        q[(dropped + 3) & 3] = zq;
+        q[dropped] = wq;
+    }
+}
+
+// Function to expand 24-bit mantissa / 8-bit exponent pairs into floats
+static void DecodeExponentialFilter(unsigned int *target, int count) {
+    for (int i = 0; i < count; i++) {
+        unsigned int v = target[i];
+        int mantissa = (int)(v << 8) >> 8;
+        int exponent = (int)v >> 24;
+
+        union { float f; unsigned int u; } bits = { 0.0f };
+        bits.u = (unsigned int)(exponent + 127) << 23;
+        bits.f *= (float)mantissa;
+        target[i] = bits.u;
+    }
+}
+
+// Function to decode and filter one view
+static int DecodeCompressedView(CompressedView *view) {
+    int result;
+    if (view->mode == MESHOPT_MODE_TRIANGLES) {
+        return DecodeMeshoptTriangles(view->target, view->count, view->stride, view->source, view->sourceSize);
+    }
+    if (view->mode == MESHOPT_MODE_INDICES) {
+        return DecodeMeshoptIndices(view->target, view->count, view->stride, view->source, view->sourceSize);
+    }
+
+    result = DecodeMeshoptVertices(view->target, view->count, view->stride, view->source, view->sourceSize);
+    if (result != 0) return result;
+
+    if (view->filter == MESHOPT_FILTER_OCTAHEDRAL) {
+        if (view->stride != 4 && view->stride != 8) return -1;
+        DecodeOctahedralFilter(view->target, view->count, view->stride);
+    } else if (view->filter == MESHOPT_FILTER_QUATERNION) {
+        if (view->stride != 8) return -1;
+        DecodeQuaternionFilter((short *)view->target, view->count);
+    } else if (view->filter == MESHOPT_FILTER_EXPONENTIAL) {
+        DecodeExponentialFilter((unsigned int *)view->target, view->count * view->stride / 4);
+    }
+    return 0;
+}
+
+// Function run by the job system over a range of views
+static void DecodeCompressedViewRange(void *userData, int first, int count) {
+    CompressedView *views = (CompressedView *)userData;
+    for (int i = first; i < first + count; i++) {
+        views[i].result = DecodeCompressedView(&views[i]);
+    }
+}
+
+static int CompareJsonEdits(const void *a, const void *b) {
+    const JsonEdit *ea = (const JsonEdit *)a;
+    const JsonEdit *eb = (const JsonEdit *)b;
+    return (ea->start > eb->start) - (ea->start < eb->start);
+}
+
+// Function to read a little-endian 32-bit word
+static unsigned int ReadU32(const unsigned char *p) {
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+// Function to write a little-endian 32-bit word
+static void WriteU32(unsigned char *p, unsigned int value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+// Function to check for a GLB container
+static bool IsGlb(const unsigned char *file, int fileSize) {
+    return fileSize >= GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE && ReadU32(file) == GLB_MAGIC;
+}
+
+// Function to locate the JSON root object and the binary chunk of a GLB, bin stays NULL without one
+static bool FindGlbChunks(const unsigned char *file, int fileSize, const char **json, const char **jsonEnd,
+                          const unsigned char **bin, int *binSize) {
+    unsigned int jsonLength = ReadU32(file + GLB_HEADER_SIZE);
+    if (ReadU32(file + GLB_HEADER_SIZE + 4) != GLB_CHUNK_JSON || jsonLength > (unsigned int)(fileSize - GLB_HEADER_SIZE - GLB_CHUNK_HEADER_SIZE)) {
+        return false;
+    }
+
+    const char *start = (const char *)file + GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE;
+    *jsonEnd = start + jsonLength;
+    *json = SkipJsonSpace(start, *jsonEnd);
+    if (*json >= *jsonEnd || **json != '{') return false;
+
+    // The binary chunk follows the JSON chunk
+    *bin = NULL;
+    *binSize = 0;
+    int binChunk = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + (int)jsonLength;
+    if (binChunk + GLB_CHUNK_HEADER_SIZE <= fileSize && ReadU32(file + binChunk + 4) == GLB_CHUNK_BIN) {
+        unsigned int length = ReadU32(file + binChunk);
+        if (length <= (unsigned int)(fileSize - binChunk - GLB_CHUNK_HEADER_SIZE)) {
+            *bin = file + binChunk + GLB_CHUNK_HEADER_SIZE;
+            *binSize = (int)length;
+        }
+    }
+    return true;
+}
+
+// Function to parse the compressed views, returns the count or -1 on invalid files; targets are laid out after binSize
+static int CollectCompressedViews(const char *json, const char *end, const unsigned char *bin, int binSize,
+                                  CompressedView **viewsOut, int *decodedSize) {
+    const char *buffers = FindJsonMember(json, end, "buffers");
+    const char *bufferViews = FindJsonMember(json, end, "bufferViews");
+    int bufferCount = 0;
+    while (GetJsonElement(buffers, end, bufferCount) != NULL) bufferCount++;
+    int viewCount = 0;
+    while (GetJsonElement(bufferViews, end, viewCount) != NULL) viewCount++;
+
+    // Buffers that only exist as compression fallbacks get their decoded contents appended to the binary chunk
+    long long *fallbackBase = (long long *)malloc(sizeof(long long) * (bufferCount + 1));
+    long long *fallbackSize = (long long *)malloc(sizeof(long long) * (bufferCount + 1));
+    CompressedView *views = (CompressedView *)calloc(viewCount + 1, sizeof(CompressedView));
+    if (fallbackBase == NULL || fallbackSize == NULL || views == NULL) {
+        printf("Failed to allocate compressed glTF views\n");
+        free(fallbackBase);
+        free(fallbackSize);
+        free(views);
+        return -1;
+    }
+
+    long long size = (binSize + GLTF_DECODE_ALIGNMENT - 1) / GLTF_DECODE_ALIGNMENT * GLTF_DECODE_ALIGNMENT;
+    for (int b = 0; b < bufferCount; b++) {
+        const char *buffer = GetJsonElement(buffers, end, b);
+        const char *extension = FindJsonMember(FindJsonMember(buffer, end, "extensions"), end, "EXT_meshopt_compression");
+        const char *fallback = FindJsonMember(extension, end, "fallback");
+
+        fallbackBase[b] = -1;
+        fallbackSize[b] = 0;
+        if (fallback != NULL && end - fallback >= 4 && memcmp(fallback, "true", 4) == 0 && FindJsonMember(buffer, end, "uri") == NULL) {
+            fallbackBase[b] = size;
+            fallbackSize[b] = GetJsonInteger(buffer, end, "byteLength", 0);
+            if (fallbackSize[b] < 0 || fallbackSize[b] > 0x7FFFFFFF) fallbackSize[b] = 0x7FFFFFFF;
+            size += (fallbackSize[b] + GLTF_DECODE_ALIGNMENT - 1) / GLTF_DECODE_ALIGNMENT * GLTF_DECODE_ALIGNMENT;
+        }
+    }
+
+    int count = 0;
+    bool valid = size <= 0x7FFFFFFF - GLB_HEADER_SIZE;
+    for (int v = 0; v < viewCount && valid; v++) {
+        const char *object = GetJsonElement(bufferViews, end, v);
+        const char *extension = FindJsonMember(FindJsonMember(object, end, "extensions"), end, "EXT_meshopt_compression");
+        if (extension == NULL) continue;
+
+        // Views whose own buffer holds real data were stored uncompressed as well, raylib reads those directly
+        long long buffer = GetJsonInteger(object, end, "buffer", -1);
+        if (buffer < 0 || buffer >= bufferCount) valid = false;
+        if (!valid || fallbackBase[buffer] < 0) continue;
+
+        CompressedView *view = &views[count];
+        long long sourceOffset = GetJsonInteger(extension, end, "byteOffset", 0);
+        long long sourceSize = GetJsonInteger(extension, end, "byteLength", -1);
+        long long stride = GetJsonInteger(extension, end, "byteStride", -1);
+        long long elements = GetJsonInteger(extension, end, "count", -1);
+        long long targetOffset = GetJsonInteger(object, end, "byteOffset", 0);
+        long long targetSize = GetJsonInteger(object, end, "byteLength", -1);
+        const char *mode = FindJsonMember(extension, end, "mode");
+        const char *filter = FindJsonMember(extension, end, "filter");
+
+        // Only the GLB binary chunk can hold compressed data here
+        valid = GetJsonInteger(extension, end, "buffer", -1) == 0 && FindJsonMember(GetJsonElement(buffers, end, 0), end, "uri") == NULL &&
+                sourceOffset >= 0 && sourceSize > 0 && sourceOffset + sourceSize <= binSize &&
+                stride > 0 && stride <= 256 && elements >= 0 && elements * stride <= targetSize && targetOffset >= 0 &&
+                targetOffset + targetSize <= fallbackSize[buffer];
+        if (!valid) break;
+
+        view->view = v;
+        view->object = object;
+        view->source = bin + sourceOffset;
+        view->sourceSize = (int)sourceSize;
+        view->targetOffset = (int)(fallbackBase[buffer] + targetOffset);
+        view->count = (int)elements;
+        view->stride = (int)stride;
+        view->mode = IsJsonString(mode, end, "TRIANGLES") ? MESHOPT_MODE_TRIANGLES :
+                     IsJsonString(mode, end, "INDICES") ? MESHOPT_MODE_INDICES : MESHOPT_MODE_ATTRIBUTES;
+        view->filter = IsJsonString(filter, end, "OCTAHEDRAL") ? MESHOPT_FILTER_OCTAHEDRAL :
+                       IsJsonString(filter, end, "QUATERNION") ? MESHOPT_FILTER_QUATERNION :
+                       IsJsonString(filter, end, "EXPONENTIAL") ? MESHOPT_FILTER_EXPONENTIAL : MESHOPT_FILTER_NONE;
+        if (!IsJsonString(mode, end, "ATTRIBUTES") && view->mode == MESHOPT_MODE_ATTRIBUTES) valid = false;
+        count++;
+    }
+    free(fallbackBase);
+    free(fallbackSize);
+
+    if (!valid) {
+        printf("Failed to decode glTF: invalid EXT_meshopt_compression buffer view\n");
+        free(views);
+        return -1;
+    }
+
+    *viewsOut = views;
+    *decodedSize = (int)size;
+    return count;
+}
+
+// Function to point every decoded view, and the binary buffer's length, at the rewritten chunk
+static char *RewriteGltfJson(const char *json, const char *end, const CompressedView *views, int viewCount, int binSize, int *jsonSize) {
+    JsonEdit *edits = (JsonEdit *)malloc(sizeof(JsonEdit) * (2 * viewCount + 1));
+    if (edits == NULL) return NULL;
+
+    int editCount = 0;
+    const char *buffer0 = GetJsonElement(FindJsonMember(json, end, "buffers"), end, 0);
+    const char *length = FindJsonMember(buffer0, end, "byteLength");
+    if (length != NULL) {
+        edits[editCount].start = length;
+        edits[editCount].end = SkipJsonValue(length, end);
+        snprintf(edits[editCount].text, sizeof(edits[editCount].text), "%d", binSize);
+        editCount++;
+    }
+
+    for (int i = 0; i < viewCount; i++) {
+        const char *buffer = FindJsonMember(views[i].object, end, "buffer");
+        edits[editCount].start = buffer;
+        edits[editCount].end = SkipJsonValue(buffer, end);
+        snprintf(edits[editCount].text, sizeof(edits[editCount].text), "0");
+        editCount++;
+
+        // byteOffset defaults to 0 and may be missing, then it goes in right after the opening brace
+        const char *offset = FindJsonMember(views[i].object, end, "byteOffset");
+        edits[editCount].start = (offset != NULL) ? offset : views[i].object + 1;
+        edits[editCount].end = (offset != NULL) ? SkipJsonValue(offset, end) : views[i].object + 1;
+        snprintf(edits[editCount].text, sizeof(edits[editCount].text), (offset != NULL) ? "%d" : "\"byteOffset\":%d,", views[i].targetOffset);
+        editCount++;
+    }
+    qsort(edits, editCount, sizeof(JsonEdit), CompareJsonEdits);
+
+    size_t size = (size_t)(end - json);
+    for (int i = 0; i < editCount; i++) size += strlen(edits[i].text);
+
+    char *rewritten = (char *)malloc(size + 1);
+    if (rewritten == NULL) {
+        free(edits);
+        return NULL;
+    }
+
+    char *out = rewritten;
+    const char *p = json;
+    for (int i = 0; i < editCount; i++) {
+        memcpy(out, p, (size_t)(edits[i].start - p));
+        out += edits[i].start - p;
+        size_t textLength = strlen(edits[i].text);
+        memcpy(out, edits[i].text, textLength);
+        out += textLength;
+        p = edits[i].end;
+    }
+    memcpy(out, p, (size_t)(end - p));
+    out += end - p;
+
+    free(edits);
+    *jsonSize = (int)(out - rewritten);
+    return rewritten;
+}
+
+// Function to decode a compressed GLB
+bool DecodeCompressedGltf(unsigned char **data, int *size, JobSystem *jobs) {
+    const unsigned char *file = *data;
+    int fileSize = *size;
+
+    // .gltf files are JSON text whose buffers live elsewhere
+    if (!IsGlb(file, fileSize)) {
+        const char *text = (const char *)file;
+        const char *end = text + fileSize;
+        const char *root = SkipJsonSpace(text, end);
+        if (root < end && *root == '{' && IsGltfExtensionRequired(root, end, "KHR_draco_mesh_compression")) {
+            printf("Failed to load model: KHR_draco_mesh_compression is not supported, re-export with EXT_meshopt_compression\n");
+            return false;
+        }
+        if (root < end && *root == '{' && IsGltfExtensionRequired(root, end, "EXT_meshopt_compression")) {
+            printf("Failed to load model: EXT_meshopt_compression is only decoded in .glb files\n");
+            return false;
+        }
+        return true;
+    }
+
+    const char *json = NULL;
+    const char *jsonEnd = NULL;
+    const unsigned char *bin = NULL;
+    int binSize = 0;
+    if (!FindGlbChunks(file, fileSize, &json, &jsonEnd, &bin, &binSize)) {
+        return true;  // Not ours to judge, raylib reports malformed files
+    }
+
+    if (IsGltfExtensionRequired(json, jsonEnd, "KHR_draco_mesh_compression")) {
+        printf("Failed to load model: KHR_draco_mesh_compression is not supported, re-export with EXT_meshopt_compression\n");
+        return false;
+    }
+
+    CompressedView *views = NULL;
+    int decodedSize = 0;
+    int viewCount = CollectCompressedViews(json, jsonEnd, bin, binSize, &views, &decodedSize);
+    if (viewCount < 0) return false;
+    if (viewCount == 0) {
+        free(views);
+        return true;
+    }
+
+    // New binary chunk: the old one, then every fallback buffer filled in by the decoders
+    unsigned char *decoded = (unsigned char *)calloc(decodedSize, 1);
+    if (decoded == NULL) {
+        printf("Failed to allocate %d bytes for decoded glTF buffers\n", decodedSize);
+        free(views);
+        return false;
+    }
+    memcpy(decoded, bin, binSize);
+    for (int i = 0; i < viewCount; i++) views[i].target = decoded + views[i].targetOffset;
+
+    RunParallelFor(jobs, viewCount, 1, DecodeCompressedViewRange, views);
+
+    size_t compressedBytes = 0;
+    for (int i = 0; i < viewCount; i++) {
+        if (views[i].result != 0) {
+            printf("Failed to decode glTF buffer view %d (meshopt error %d)\n", views[i].view, views[i].result);
+            free(decoded);
+            free(views);
+            return false;
+        }
+        compressedBytes += (size_t)views[i].sourceSize;
+    }
+
+    int jsonSize = 0;
+    char *rewritten = RewriteGltfJson(json, jsonEnd, views, viewCount, decodedSize, &jsonSize);
+    int paddedJson = (jsonSize + 3) & ~3;
+    size_t total = (size_t)GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + paddedJson + GLB_CHUNK_HEADER_SIZE + decodedSize;
+    unsigned char *glb = (rewritten != NULL && total <= 0x7FFFFFFF) ? (unsigned char *)malloc(total) : NULL;
+    if (glb == NULL) {
+        printf("Failed to allocate the decoded glTF file\n");
+        free(rewritten);
+        free(decoded);
+        free(views);
+        return false;
+    }
+
+    // decodedSize is a multiple of GLTF_DECODE_ALIGNMENT, so the binary chunk needs no padding
+    WriteU32(glb, GLB_MAGIC);
+    WriteU32(glb + 4, 2);
+    WriteU32(glb + 8, (unsigned int)total);
+    WriteU32(glb + GLB_HEADER_SIZE, (unsigned int)paddedJson);
+    WriteU32(glb + GLB_HEADER_SIZE + 4, GLB_CHUNK_JSON);
+    memcpy(glb + GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE, rewritten, jsonSize);
+    memset(glb + GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + jsonSize, ' ', paddedJson - jsonSize);
+    unsigned char *binHeader = glb + GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + paddedJson;
+    WriteU32(binHeader, (unsigned int)decodedSize);
+    WriteU32(binHeader + 4, GLB_CHUNK_BIN);
+    memcpy(binHeader + GLB_CHUNK_HEADER_SIZE, decoded, decodedSize);
+
+    printf("Decoded %d compressed buffer views: %.1f MB -> %.1f MB\n", viewCount,
+           compressedBytes / (1024.0 * 1024.0), (decodedSize - binSize) / (1024.0 * 1024.0));
+
+    free(rewritten);
+    free(decoded);
+    free(views);
+    free(*data);
+    *data = glb;
+    *size = (int)total;
+    return true;
+}
+
+// Function to copy the KTX2 image of a glTF image object into the stream, returns its texture index or -1
+static int AddGltfKtx2Image(const char *json, const char *end, const unsigned char *bin, int binSize, const char *path,
+                            const char *image, unsigned int formats, TextureStream *stream) {
+    const unsigned char *ktx2 = NULL;
+    size_t ktx2Size = 0;
+    unsigned char *fileData = NULL;
+
+    long long view = GetJsonInteger(image, end, "bufferView", -1);
+    const char *uri = FindJsonMember(image, end, "uri");
+    if (view >= 0) {
+        const char *object = GetJsonElement(FindJsonMember(json, end, "bufferViews"), end, (int)view);
+        long long offset = GetJsonInteger(object, end, "byteOffset", 0);
+        long long length = GetJsonInteger(object, end, "byteLength", -1);
+
+        // Only the GLB binary chunk is in memory here
+        if (object == NULL || bin == NULL || GetJsonInteger(object, end, "buffer", -1) != 0 ||
+            offset < 0 || length <= 0 || offset + length > binSize) {
+            return -1;
+        }
+        ktx2 = bin + offset;
+        ktx2Size = (size_t)length;
+    } else if (uri != NULL && *uri == '"' && (end - uri < 6 || memcmp(uri + 1, "data:", 5) != 0)) {
+        // Relative to the model file, like raylib resolves the PNG/JPEG images
+        const char *uriEnd = SkipJsonString(uri, end);
+        if (uriEnd == NULL) return -1;
+        size_t uriLength = (size_t)(uriEnd - uri) - 2;
+        const char *slash = strrchr(path, '/');
+        const char *backslash = strrchr(path, '\\');
+        if (backslash > slash) slash = backslash;
+        size_t directoryLength = (slash != NULL) ? (size_t)(slash - path) + 1 : 0;
+
+        char *imagePath = (char *)malloc(directoryLength + uriLength + 1);
+        if (imagePath == NULL) return -1;
+        memcpy(imagePath, path, directoryLength);
+        memcpy(imagePath + directoryLength, uri + 1, uriLength);
+        imagePath[directoryLength + uriLength] = '\0';
+
+        int dataSize = 0;
+        fileData = LoadFileData(imagePath, &dataSize);
+        free(imagePath);
+        ktx2 = fileData;
+        ktx2Size = (fileData != NULL) ? (size_t)dataSize : 0;
+    }
+
+    Ktx2Info info;
+    int index = -1;
+    if (ktx2 != NULL && ParseKtx2(ktx2, ktx2Size, &info) && (formats & (1u << info.format)) != 0) {
+        index = AddStreamedTexture(stream, ktx2, ktx2Size);
+    }
+    UnloadFileData(fileData);
+    return index;
+}
+
+// Function to collect the KTX2 material textures of a glTF file
+void ExtractGltfKtx2Textures(unsigned char *data, int size, const char *path, unsigned int formats, TextureStream *stream) {
+    const char *json = (const char *)data;
+    const char *end = json + size;
+    const unsigned char *bin = NULL;
+    int binSize = 0;
+    if (IsGlb(data, size)) {
+        if (!FindGlbChunks(data, size, &json, &end, &bin, &binSize)) return;
+    } else {
+        json = SkipJsonSpace(json, end);
+        if (json >= end || *json != '{') return;
+    }
+
+    const char *materials = FindJsonMember(json, end, "materials");
+    const char *textures = FindJsonMember(json, end, "textures");
+    const char *images = FindJsonMember(json, end, "images");
+    int textureCount = 0;
+    while (GetJsonElement(textures, end, textureCount) != NULL) textureCount++;
+    if (textureCount == 0 || formats == 0) return;
+
+    // Stream texture of every glTF texture, -1 when raylib decodes it, -2 until looked at
+    int *streamed = (int *)malloc(sizeof(int) * textureCount);
+    if (streamed == NULL) return;
+    for (int t = 0; t < textureCount; t++) streamed[t] = -2;
+
+    int fallbacks = 0;
+    for (int m = 0;; m++) {
+        const char *material = GetJsonElement(materials, end, m);
+        if (material == NULL) break;
+
+        for (int s = 0; s < GLTF_TEXTURE_SLOT_COUNT; s++) {
+            const GltfTextureSlot *slot = &gltfTextureSlots[s];
+            const char *owner = (slot->parent != NULL) ? FindJsonMember(material, end, slot->parent) : material;
+            long long t = GetJsonInteger(FindJsonMember(owner, end, slot->name), end, "index", -1);
+            if (t < 0 || t >= textureCount) continue;
+
+            if (streamed[t] == -2) {
+                const char *texture = GetJsonElement(textures, end, (int)t);
+                const char *basisu = FindJsonMember(FindJsonMember(texture, end, "extensions"), end, "KHR_texture_basisu");
+                long long source = GetJsonInteger(basisu, end, "source", -1);
+                const char *image = (source >= 0) ? GetJsonElement(images, end, (int)source) : NULL;
+
+                streamed[t] = (image != NULL) ? AddGltfKtx2Image(json, end, bin, binSize, path, image, formats, stream) : -1;
+                if (image != NULL && streamed[t] < 0) fallbacks++;
+
+                // Renaming the PNG/JPEG "source" key in place (same length) makes raylib's loader skip that image
+                const char *key = NULL;
+                if (streamed[t] >= 0 && FindJsonMemberKey(texture, end, "source", &key) != NULL) {
+                    memcpy((char *)key + 1, "unused", 6);
+                }
+            }
+            if (streamed[t] >= 0) BindStreamedTexture(stream, streamed[t], m + 1, slot->map);
+        }
+    }
+    free(streamed);
+
+    if (stream->textureCount > 0 || fallbacks > 0) {
+        size_t bytes = 0;
+        for (int i = 0; i < stream->textureCount; i++) bytes += stream->textures[i].size;
+        printf("KTX2 textures: %d streamed (%.1f MB), %d use their PNG/JPEG fallback (Basis Universal or not supported by the driver)\n",
+               stream->textureCount, bytes / (1024.0 * 1024.0), fallbacks);
+    }
+}
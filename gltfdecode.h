@@ -0,0 +1,22 @@
+#ifndef GLTFDECODE_H
+#define GLTFDECODE_H
+
+#include <stdbool.h>
+#include "jobs.h"
+#include "texturestream.h"
+
+// Compressed glTF settings
+#define GLTF_DECODE_ALIGNMENT 16           // Start of every decoded buffer in the rewritten binary chunk
+
+// Decode the EXT_meshopt_compression buffer views of a GLB into plain ones raylib's loader can read
+// Views are decoded in parallel on jobs; *data and *size are replaced by the rewritten file, files without
+// compressed views are left as they are. Returns false (leaving the file untouched) if it can't be loaded,
+// which includes models that require KHR_draco_mesh_compression
+bool DecodeCompressedGltf(unsigned char **data, int *size, JobSystem *jobs);
+
+// Collect the KHR_texture_basisu KTX2 images of material textures whose format is in formats (GetSupportedTextureFormats)
+// Their PNG/JPEG fallback is disabled in place so raylib doesn't decode it; images without a GPU format the driver takes,
+// which includes every Basis Universal one, keep the fallback. KTX2 files of .gltf models are found next to path
+void ExtractGltfKtx2Textures(unsigned char *data, int size, const char *path, unsigned int formats, TextureStream *stream);
+
+#endif // GLTFDECODE_H
@@ -0,0 +1,146 @@
+#include "heightfield.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Function to check whether a sample has another walkable surface below its top
+static bool HasLowerLayer(const ModelCollision *collision, float x, float z, float topY) {
+    float rayY = topY - 0.001f;
+
+    for (int layer = 0; layer < HEIGHTFIELD_MAX_LAYERS; layer++) {
+        Ray ray = { (Vector3){ x, rayY, z }, (Vector3){ 0, -1, 0 } };
+        CollisionHit hit = RaycastModelCollision(collision, ray, 10000.0f, COLLISION_QUERY_CLOSEST_HIT);
+        if (!hit.hit) return false;
+
+        // Undersides (bottoms of slabs, roofs, bridges) are not walkable layers
+        if (hit.normal.y > 0.0f && topY - hit.point.y > HEIGHTFIELD_LAYER_GAP) return true;
+
+        rayY = hit.point.y - 0.001f;
+    }
+
+    // Too many stacked surfaces to classify, treat as multi-layer
+    return true;
+}
+
+// Function to build the heightfield by casting one downward ray per sample
+Heightfield LoadHeightfield(const ModelCollision *collision, float cellSize) {
+    Heightfield heightfield = {0};
+    BoundingBox bounds = collision->info.bounds;
+
+    if (collision->soup.count == 0 || cellSize <= 0.0f) return heightfield;
+
+    float extentX = bounds.max.x - bounds.min.x;
+    float extentZ = bounds.max.z - bounds.min.z;
+
+    // Coarsen the grid if the requested resolution would be too large
+    while ((double)(ceilf(extentX / cellSize) + 1) * (ceilf(extentZ / cellSize) + 1) > HEIGHTFIELD_MAX_SAMPLES) {
+        cellSize *= 2.0f;
+    }
+
+    heightfield.originX = bounds.min.x;
+    heightfield.originZ = bounds.min.z;
+    heightfield.cellSize = cellSize;
+    heightfield.width = (int)ceilf(extentX / cellSize) + 1;
+    heightfield.depth = (int)ceilf(extentZ / cellSize) + 1;
+
+    int sampleCount = heightfield.width * heightfield.depth;
+    heightfield.heights = (float *)calloc(sampleCount, sizeof(float));
+    heightfield.flags = (unsigned char *)calloc(sampleCount, sizeof(unsigned char));
+
+    Ray *rays = (Ray *)malloc(sizeof(Ray) * heightfield.width);
+    CollisionHit *hits = (CollisionHit *)malloc(sizeof(CollisionHit) * heightfield.width);
+
+    if (heightfield.heights == NULL || heightfield.flags == NULL || rays == NULL || hits == NULL) {
+        printf("Failed to allocate %dx%d heightfield\n", heightfield.width, heightfield.depth);
+        free(rays);
+        free(hits);
+        UnloadHeightfield(&heightfield);
+        return heightfield;
+    }
+
+    float startY = bounds.max.y + 1.0f;
+
+    for (int z = 0; z < heightfield.depth; z++) {
+        // Clamp the last row and column so rounding never puts a sample outside the bounds
+        float worldZ = fminf(heightfield.originZ + z * cellSize, bounds.max.z);
+
+        // One coherent packet of downward rays per grid row
+        for (int x = 0; x < heightfield.width; x++) {
+            rays[x].position = (Vector3){ fminf(heightfield.originX + x * cellSize, bounds.max.x), startY, worldZ };
+            rays[x].direction = (Vector3){ 0, -1, 0 };
+        }
+        RaycastModelCollisionPacket(collision, rays, heightfield.width, 10000.0f, hits);
+
+        for (int x = 0; x < heightfield.width; x++) {
+            int index = z * heightfield.width + x;
+            if (!hits[x].hit) continue;
+
+            heightfield.heights[index] = hits[x].point.y;
+            heightfield.flags[index] = HEIGHTFIELD_SAMPLE_SURFACE;
+
+            if (hits[x].normal.y <= 0.0f || HasLowerLayer(collision, rays[x].position.x, worldZ, hits[x].point.y)) {
+                heightfield.flags[index] |= HEIGHTFIELD_SAMPLE_MULTILAYER;
+                heightfield.multiLayerSamples++;
+            }
+        }
+    }
+
+    free(rays);
+    free(hits);
+
+    return heightfield;
+}
+
+// Function to release heightfield memory
+void UnloadHeightfield(Heightfield *heightfield) {
+    free(heightfield->heights);
+    free(heightfield->flags);
+    memset(heightfield, 0, sizeof(*heightfield));
+}
+
+// Function to look up the interpolated ground height at a world XZ position
+HeightfieldResult GetHeightfieldHeight(const Heightfield *heightfield, float x, float z, float rayOriginY, float *height) {
+    if (heightfield->heights == NULL) return HEIGHTFIELD_FALLBACK;
+
+    float gx = (x - heightfield->originX) / heightfield->cellSize;
+    float gz = (z - heightfield->originZ) / heightfield->cellSize;
+
+    // The grid covers the model bounds, nothing can be hit outside it
+    if (gx < 0.0f || gz < 0.0f || gx > heightfield->width - 1 || gz > heightfield->depth - 1) return HEIGHTFIELD_NO_SURFACE;
+
+    int ix = (int)gx;
+    int iz = (int)gz;
+    if (ix > heightfield->width - 2) ix = heightfield->width - 2;
+    if (iz > heightfield->depth - 2) iz = heightfield->depth - 2;
+    if (ix < 0 || iz < 0) return HEIGHTFIELD_FALLBACK;  // Degenerate 1-sample axis
+
+    int i00 = iz * heightfield->width + ix;
+    int i10 = i00 + 1;
+    int i01 = i00 + heightfield->width;
+    int i11 = i01 + 1;
+
+    unsigned char f00 = heightfield->flags[i00], f10 = heightfield->flags[i10];
+    unsigned char f01 = heightfield->flags[i01], f11 = heightfield->flags[i11];
+    unsigned char any = f00 | f10 | f01 | f11;
+    unsigned char all = f00 & f10 & f01 & f11;
+
+    if (!(any & HEIGHTFIELD_SAMPLE_SURFACE)) return HEIGHTFIELD_NO_SURFACE;
+    if (!(all & HEIGHTFIELD_SAMPLE_SURFACE) || (any & HEIGHTFIELD_SAMPLE_MULTILAYER)) return HEIGHTFIELD_FALLBACK;
+
+    float h00 = heightfield->heights[i00], h10 = heightfield->heights[i10];
+    float h01 = heightfield->heights[i01], h11 = heightfield->heights[i11];
+    float hmin = fminf(fminf(h00, h10), fminf(h01, h11));
+    float hmax = fmaxf(fmaxf(h00, h10), fmaxf(h01, h11));
+
+    // Walls and ledges inside the cell, or a surface above where the exact ray would start
+    if (hmax - hmin > HEIGHTFIELD_MAX_STEP || hmax > rayOriginY) return HEIGHTFIELD_FALLBACK;
+
+    float fx = gx - ix;
+    float fz = gz - iz;
+    float h0 = h00 + (h10 - h00) * fx;
+    float h1 = h01 + (h11 - h01) * fx;
+    *height = h0 + (h1 - h0) * fz;
+
+    return HEIGHTFIELD_HEIGHT;
+}
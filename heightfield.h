@@ -0,0 +1,46 @@
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <raylib.h>
+#include "collision.h"
+
+// Heightfield settings
+#define HEIGHTFIELD_DEFAULT_CELL_SIZE 0.25f
+#define HEIGHTFIELD_MAX_SAMPLES (2048 * 2048)  // Cell size grows to stay under this
+#define HEIGHTFIELD_LAYER_GAP 0.5f             // Vertical gap that makes a second walkable layer
+#define HEIGHTFIELD_MAX_STEP 0.25f             // Larger height changes inside a cell use the exact raycast
+#define HEIGHTFIELD_MAX_LAYERS 8               // Surfaces probed per sample when looking for layers
+
+// Per-sample flags
+#define HEIGHTFIELD_SAMPLE_SURFACE 0x01        // A surface was found below the sample
+#define HEIGHTFIELD_SAMPLE_MULTILAYER 0x02     // More than one walkable surface (bridge, overhang)
+
+// Result of a heightfield lookup
+typedef enum {
+    HEIGHTFIELD_HEIGHT,        // Interpolated surface height is valid
+    HEIGHTFIELD_NO_SURFACE,    // Nothing below this position
+    HEIGHTFIELD_FALLBACK       // Multi-layer, edge or steep cell: use the exact raycast
+} HeightfieldResult;
+
+// Precomputed top-surface heights on a regular XZ grid
+typedef struct {
+    float originX;             // World position of sample (0, 0)
+    float originZ;
+    float cellSize;
+    int width;                 // Samples along X
+    int depth;                 // Samples along Z
+    float *heights;            // Top surface height per sample
+    unsigned char *flags;      // HEIGHTFIELD_SAMPLE_* per sample
+    int multiLayerSamples;
+} Heightfield;
+
+// Build the grid by casting rays straight down through the model
+Heightfield LoadHeightfield(const ModelCollision *collision, float cellSize);
+
+// Release heightfield memory
+void UnloadHeightfield(Heightfield *heightfield);
+
+// Bilinear height lookup; rayOriginY is where an exact downward ray would start
+HeightfieldResult GetHeightfieldHeight(const Heightfield *heightfield, float x, float z, float rayOriginY, float *height);
+
+#endif // HEIGHTFIELD_H
@@ -0,0 +1,152 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf
+
+#include "jobs.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Function to query the number of online CPU cores
+int GetProcessorCount(void) {
+#if defined(_WIN32)
+    int count = pthread_num_processors_np();
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count > 0) ? count : 1;
+}
+
+// Function to run chunks of the current job, own range first, then stealing from the others
+static void RunJobRanges(JobSystem *jobs, int self) {
+    for (int k = 0; k < jobs->rangeCount; k++) {
+        JobRange *range = &jobs->ranges[(self + k) % jobs->rangeCount];
+
+        for (;;) {
+            int first = ATOMIC_FETCH_ADD(&range->next, jobs->chunkSize);
+            if (first >= range->end) break;
+
+            int count = range->end - first;
+            if (count > jobs->chunkSize) count = jobs->chunkSize;
+            jobs->function(jobs->userData, first, count);
+        }
+    }
+}
+
+// Function run by every worker thread
+static void *JobWorkerMain(void *arg) {
+    JobWorker *worker = (JobWorker *)arg;
+    JobSystem *jobs = worker->jobs;
+    unsigned int seen = 0;
+
+    pthread_mutex_lock(&jobs->mutex);
+    for (;;) {
+        while (jobs->generation == seen && !jobs->quit) {
+            pthread_cond_wait(&jobs->wake, &jobs->mutex);
+        }
+        if (jobs->quit) break;
+        seen = jobs->generation;
+
+        // The mutex published the job fields, run without holding it
+        pthread_mutex_unlock(&jobs->mutex);
+        RunJobRanges(jobs, worker->index);
+        pthread_mutex_lock(&jobs->mutex);
+
+        if (--jobs->busyWorkers == 0) pthread_cond_signal(&jobs->done);
+    }
+    pthread_mutex_unlock(&jobs->mutex);
+
+    return NULL;
+}
+
+// Function to start the worker threads
+void InitJobSystem(JobSystem *jobs, int threadCount) {
+    memset(jobs, 0, sizeof(*jobs));
+
+    if (threadCount < 0) threadCount = GetProcessorCount() - 1;
+    if (threadCount > JOBS_MAX_WORKERS) threadCount = JOBS_MAX_WORKERS;
+
+    pthread_mutex_init(&jobs->mutex, NULL);
+    pthread_cond_init(&jobs->wake, NULL);
+    pthread_cond_init(&jobs->done, NULL);
+
+    for (int i = 0; i < threadCount; i++) {
+        jobs->workers[i].jobs = jobs;
+        jobs->workers[i].index = i;
+
+        if (pthread_create(&jobs->threads[i], NULL, JobWorkerMain, &jobs->workers[i]) != 0) {
+            printf("Failed to start job worker %d, continuing with %d\n", i, i);
+            break;
+        }
+        jobs->threadCount++;
+    }
+}
+
+// Function to stop the worker threads
+void CloseJobSystem(JobSystem *jobs) {
+    WaitParallelFor(jobs);
+
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->quit = true;
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    for (int i = 0; i < jobs->threadCount; i++) {
+        pthread_join(jobs->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&jobs->done);
+    pthread_cond_destroy(&jobs->wake);
+    pthread_mutex_destroy(&jobs->mutex);
+    jobs->threadCount = 0;
+}
+
+// Function to split a job into one chunk-aligned range per thread and wake the workers
+void BeginParallelFor(JobSystem *jobs, int count, int chunkSize, JobFunction function, void *userData) {
+    WaitParallelFor(jobs);
+    if (count <= 0) return;
+    if (chunkSize <= 0) chunkSize = 1;
+
+    int rangeCount = jobs->threadCount + 1;
+    int chunks = (count + chunkSize - 1) / chunkSize;
+    int chunksPerRange = (chunks + rangeCount - 1) / rangeCount;
+
+    pthread_mutex_lock(&jobs->mutex);
+
+    jobs->function = function;
+    jobs->userData = userData;
+    jobs->chunkSize = chunkSize;
+    jobs->rangeCount = rangeCount;
+    for (int r = 0; r < rangeCount; r++) {
+        int first = r * chunksPerRange * chunkSize;
+        int end = first + chunksPerRange * chunkSize;
+        jobs->ranges[r].next = (first < count) ? first : count;
+        jobs->ranges[r].end = (end < count) ? end : count;
+    }
+
+    jobs->busyWorkers = jobs->threadCount;
+    jobs->running = true;
+    jobs->generation++;
+    pthread_cond_broadcast(&jobs->wake);
+
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+// Function to finish the current job
+void WaitParallelFor(JobSystem *jobs) {
+    if (!jobs->running) return;
+
+    // The calling thread owns the last range
+    RunJobRanges(jobs, jobs->rangeCount - 1);
+
+    pthread_mutex_lock(&jobs->mutex);
+    while (jobs->busyWorkers > 0) {
+        pthread_cond_wait(&jobs->done, &jobs->mutex);
+    }
+    jobs->running = false;
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+// Function to run a job to completion
+void RunParallelFor(JobSystem *jobs, int count, int chunkSize, JobFunction function, void *userData) {
+    BeginParallelFor(jobs, count, chunkSize, function, userData);
+    WaitParallelFor(jobs);
+}
@@ -0,0 +1,70 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+// Job system settings
+#define JOBS_MAX_WORKERS 31     // Worker threads, the calling thread also runs jobs
+#define JOBS_CACHE_LINE 64
+
+// Atomics on values shared between threads (GCC/Clang builtins, also available in MinGW)
+#define ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define ATOMIC_FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)  // Counters that order nothing else
+
+// Runs items [first, first + count) of a parallel-for
+typedef void (*JobFunction)(void *userData, int first, int count);
+
+// Share of a parallel-for owned by one thread; other threads steal from it once theirs is empty
+typedef struct {
+    int next;                  // Next unclaimed item, advanced atomically
+    int end;
+    char padding[JOBS_CACHE_LINE - 2 * sizeof(int)];  // Keep each counter on its own cache line
+} JobRange;
+
+// Data handed to each worker thread
+typedef struct {
+    void *jobs;                // Owning JobSystem
+    int index;                 // Range this worker starts on
+} JobWorker;
+
+// Fixed pool of worker threads running one parallel-for at a time
+typedef struct {
+    pthread_t threads[JOBS_MAX_WORKERS];
+    JobWorker workers[JOBS_MAX_WORKERS];
+    int threadCount;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;       // Signalled when a job starts or on shutdown
+    pthread_cond_t done;       // Signalled when the last worker leaves a job
+    unsigned int generation;   // Bumped for every job so workers see each one once
+    int busyWorkers;           // Workers that have not finished the current job
+    bool running;              // A job was started and not waited for
+    bool quit;
+
+    JobFunction function;
+    void *userData;
+    int chunkSize;
+    JobRange ranges[JOBS_MAX_WORKERS + 1];
+    int rangeCount;
+} JobSystem;
+
+// Start threadCount workers (negative picks one per extra CPU core, 0 runs jobs on the caller)
+void InitJobSystem(JobSystem *jobs, int threadCount);
+
+// Wait for the current job and stop the workers
+void CloseJobSystem(JobSystem *jobs);
+
+// Start a parallel-for over count items in chunks of chunkSize and return immediately
+void BeginParallelFor(JobSystem *jobs, int count, int chunkSize, JobFunction function, void *userData);
+
+// Help finish the current job on the calling thread, then wait for the workers
+void WaitParallelFor(JobSystem *jobs);
+
+// Parallel-for that returns once every item has run
+void RunParallelFor(JobSystem *jobs, int count, int chunkSize, JobFunction function, void *userData);
+
+// Number of CPU cores available to the process
+int GetProcessorCount(void);
+
+#endif // JOBS_H
@@ -4,6 +4,26 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+
+#include "collision.h"
+#include "heightfield.h"
+#include "spatialgrid.h"
+#include "unitpool.h"
+#include "jobs.h"
+#include "unitrender.h"
+#include "frustum.h"
+#include "modelloader.h"
+#include "scenecache.h"
+#include "meshlod.h"
+#include "profiler.h"
+#include "bench.h"
+#include "flowfield.h"
+#include "meshbatch.h"
+#include "meshopt.h"
+#include "texturestream.h"
+#include "frameinput.h"
+#include "tilescene.h"
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
@@ -23,9 +43,13 @@
 #define ISO_CAMERA_MAX_HEIGHT 50.0f
 #define ISO_CAMERA_ZOOM_SPEED 2.0f
 #define ISO_CAMERA_SMOOTHING 0.15f  // Smooth camera movement
+#define ISO_SELECTION_MIN_SIZE 2.0f  // Pixels, a click selects the units this close under the cursor
+
+// Idle mode settings
+#define IDLE_SETTLE_DISTANCE 0.001f  // Isometric smoothing left below this counts as settled
+#define IDLE_MAX_FRAME_TIME 0.1f  // Frame time cap after sleeping on events, so the first input doesn't jump the camera
 
 // Unit settings
-#define MAX_UNITS 100
 #define UNIT_SIZE 0.3f
 #define UNIT_SPEED 2.0f
 #define UNIT_TURN_SPEED 3.0f
@@ -34,6 +58,17 @@
 #define UNIT_WANDER_RADIUS 10.0f
 #define UNIT_HEIGHT_OFFSET 0.2f
 #define UNIT_ARRIVAL_DISTANCE 0.5f
+#define UNIT_SEPARATION_DISTANCE (UNIT_SIZE * 3)  // Units closer than this avoid each other
+#define UNIT_PROBE_DISTANCE (UNIT_AVOIDANCE_DISTANCE * 2)  // Look-ahead rays reach further so they answer later ticks too
+#define UNIT_PROBE_TOLERANCE 0.05f  // Sideways drift off the probed line before a unit probes again
+#define UNIT_PROBE_MIN_DOT 0.999f  // Heading change (about 2.5 degrees) before a unit probes again
+#define UNIT_PROBE_STALE_DOT 0.7f  // Units out of budget still trust a hit this close to their heading
+#define UNIT_PROBE_BUDGET 256  // Default look-ahead rays per tick over all units, 0 = unlimited
+#define UNIT_FLOW_DIRECT_DISTANCE 1.0f  // Path length past the formation slot's offset where units leave the flow field
+#define UNIT_INTEGRATE_BLOCK 8  // Floats per step of the movement integration loop
+#define UNIT_JOB_CHUNK 256  // Units per simulation job, a multiple of UNIT_BITS_PER_WORD
+#define UNIT_TICK_RATE 60.0f  // Default simulation ticks per second, independent of the frame rate
+#define UNIT_MAX_SUBSTEPS 4  // Ticks run in one frame at most, longer frames slow the simulation down
 
 // Camera view modes
 typedef enum {
@@ -63,22 +98,6 @@ typedef struct {
     Vector2 selectionEnd;
 } IsometricCamera;
 
-// Structure for units
-typedef struct {
-    Vector3 position;
-    Vector3 velocity;
-    Vector3 targetPosition;
-    Vector3 commandTarget;  // Target set by player command
-    bool hasCommand;        // Whether unit has a player command
-    float rotation;
-    float moveTimer;
-    float size;
-    Color color;
-    bool active;
-    bool selected;
-    int groupId;  // Control group ID (0 = no group, 1-9 = groups)
-} Unit;
-
 // Command marker structure
 typedef struct {
     Vector3 position;
@@ -86,20 +105,47 @@ typedef struct {
     bool active;
 } CommandMarker;
 
-// Control group structure
+// Dense indices of the units inside the view frustum
 typedef struct {
-    int unitIndices[MAX_UNITS];
-    int unitCount;
-    bool active;
-} ControlGroup;
+    int *units;
+    int count;
+    int capacity;
+} VisibleUnits;
 
-// Global unit array and command marker
-Unit units[MAX_UNITS];
-int unitCount = 0;
+// Global unit pool and command marker
+UnitPool unitPool = {0};
 CommandMarker commandMarker = {0};
 
-// Control groups (1-9)
-ControlGroup controlGroups[10] = {0};  // Index 0 unused, 1-9 for groups
+// Precomputed terrain heights for ground following (empty when disabled)
+Heightfield groundHeightfield = {0};
+
+// Walkable cells of the heightfield and the shared flow fields of move commands (empty when disabled)
+NavGrid navGrid = {0};
+FlowFieldCache flowFields = {0};
+
+// Unit positions bucketed for neighbour queries, rebuilt every frame
+SpatialGrid unitGrid = {0};
+
+// Worker threads for the unit simulation
+JobSystem unitJobs;
+
+// Instanced unit drawing (not ready when instancing is disabled or unavailable)
+UnitRenderer unitRenderer = {0};
+
+// Pre-baked digits for control group labels
+UnitLabelBatch unitLabels = {0};
+
+// Units submitted for drawing this frame
+VisibleUnits visibleUnits = {0};
+
+// Ray queries against the collision mesh, for the benchmark report
+typedef struct {
+    long long avoidance;       // Unit look-ahead rays
+    long long ground;          // Ground-following rays the heightfield could not answer
+    long long picking;         // Mouse picking
+} RayQueryCounts;
+
+RayQueryCounts rayQueryCounts = {0};
 
 // Function to initialize a unit
 void InitUnit(Unit* unit, Vector3 position) {
@@ -108,19 +154,18 @@ void InitUnit(Unit* unit, Vector3 position) {
     unit->targetPosition = position;
     unit->commandTarget = position;
     unit->hasCommand = false;
+    unit->commandField = FLOWFIELD_NONE;
     unit->rotation = GetRandomValue(0, 360) * DEG2RAD;
     unit->moveTimer = 0;
     unit->size = UNIT_SIZE;
     unit->color = WHITE;
-    unit->active = true;
     unit->selected = false;
     unit->groupId = 0;
+    unit->seed = (unsigned int)GetRandomValue(1, 0x7FFFFFFF);
 }
 
 // Function to spawn a new unit at a random position
 void SpawnUnit(Vector3 centerPos, float radius) {
-    if (unitCount >= MAX_UNITS) return;
-    
     float angle = GetRandomValue(0, 360) * DEG2RAD;
     float distance = (float)GetRandomValue(10, (int)(radius * 10)) / 10.0f;
     
@@ -130,242 +175,139 @@ void SpawnUnit(Vector3 centerPos, float radius) {
         centerPos.z + sinf(angle) * distance
     };
     
-    InitUnit(&units[unitCount], spawnPos);
-    unitCount++;
+    Unit unit;
+    InitUnit(&unit, spawnPos);
+    
+    UnitHandle handle = AddUnit(&unitPool, unit);
+    if (handle.slot < 0) {
+        printf("Failed to spawn unit: out of memory\n");
+    }
 }
 
-// Function to perform raycast collision check with actual mesh triangles
-bool CheckCollisionWithModel(Vector3 origin, Vector3 direction, Model model, float maxDistance) {
-    Ray ray = { origin, direction };
+// Function to check whether the model blocks a unit within UNIT_AVOIDANCE_DISTANCE along direction
+// The unit's last probe answers while the unit is still on its line and the answer is within its reach;
+// otherwise a new ray is cast if probesLeft allows (negative = unlimited, rays traced are added to rayQueries)
+bool ProbeUnitPath(UnitPool *pool, int index, Vector3 direction, const CollisionScene *collision, int *probesLeft, int *rayQueries) {
+    Vector3 position = pool->position[index];
+    Vector3 probeDirection = pool->probeDirection[index];
+    Vector3 offset = Vector3Subtract(position, pool->probeOrigin[index]);
+    float along = Vector3DotProduct(offset, probeDirection);
+    float drift = Vector3Length(Vector3Subtract(offset, Vector3Scale(probeDirection, along)));
+    float heading = Vector3DotProduct(direction, probeDirection);
+    
+    // Free distance left ahead of the unit, a hit stays a hit while the unit walks towards it
+    float clearance = pool->probeDistance[index] - along;
+    bool blocked = pool->probeDistance[index] < UNIT_PROBE_DISTANCE;
+    
+    if (heading >= UNIT_PROBE_MIN_DOT && along >= 0.0f && drift <= UNIT_PROBE_TOLERANCE &&
+        (blocked || clearance >= UNIT_AVOIDANCE_DISTANCE)) {
+        return clearance < UNIT_AVOIDANCE_DISTANCE;
+    }
     
-    for (int i = 0; i < model.meshCount; i++) {
-        Mesh mesh = model.meshes[i];
-        
-        // First check bounding box for optimization
-        BoundingBox bounds = GetMeshBoundingBox(mesh);
-        RayCollision boxCollision = GetRayCollisionBox(ray, bounds);
-        
-        if (boxCollision.hit && boxCollision.distance < maxDistance) {
-            // If bounding box is hit, check actual triangles
-            Matrix transform = model.transform;
-            
-            // Check if mesh has indices
-            if (mesh.indices != NULL) {
-                // Indexed mesh
-                for (int t = 0; t < mesh.triangleCount; t++) {
-                    Vector3 v0, v1, v2;
-                    
-                    // Get triangle vertices
-                    int idx0 = mesh.indices[t * 3 + 0];
-                    int idx1 = mesh.indices[t * 3 + 1];
-                    int idx2 = mesh.indices[t * 3 + 2];
-                    
-                    v0.x = mesh.vertices[idx0 * 3 + 0];
-                    v0.y = mesh.vertices[idx0 * 3 + 1];
-                    v0.z = mesh.vertices[idx0 * 3 + 2];
-                    
-                    v1.x = mesh.vertices[idx1 * 3 + 0];
-                    v1.y = mesh.vertices[idx1 * 3 + 1];
-                    v1.z = mesh.vertices[idx1 * 3 + 2];
-                    
-                    v2.x = mesh.vertices[idx2 * 3 + 0];
-                    v2.y = mesh.vertices[idx2 * 3 + 1];
-                    v2.z = mesh.vertices[idx2 * 3 + 2];
-                    
-                    // Transform vertices
-                    v0 = Vector3Transform(v0, transform);
-                    v1 = Vector3Transform(v1, transform);
-                    v2 = Vector3Transform(v2, transform);
-                    
-                    // Check collision with triangle
-                    RayCollision triCollision = GetRayCollisionTriangle(ray, v0, v1, v2);
-                    if (triCollision.hit && triCollision.distance < maxDistance) {
-                        return true;
-                    }
-                }
-            } else {
-                // Non-indexed mesh
-                for (int t = 0; t < mesh.triangleCount; t++) {
-                    Vector3 v0, v1, v2;
-                    
-                    v0.x = mesh.vertices[(t * 3 + 0) * 3 + 0];
-                    v0.y = mesh.vertices[(t * 3 + 0) * 3 + 1];
-                    v0.z = mesh.vertices[(t * 3 + 0) * 3 + 2];
-                    
-                    v1.x = mesh.vertices[(t * 3 + 1) * 3 + 0];
-                    v1.y = mesh.vertices[(t * 3 + 1) * 3 + 1];
-                    v1.z = mesh.vertices[(t * 3 + 1) * 3 + 2];
-                    
-                    v2.x = mesh.vertices[(t * 3 + 2) * 3 + 0];
-                    v2.y = mesh.vertices[(t * 3 + 2) * 3 + 1];
-                    v2.z = mesh.vertices[(t * 3 + 2) * 3 + 2];
-                    
-                    // Transform vertices
-                    v0 = Vector3Transform(v0, transform);
-                    v1 = Vector3Transform(v1, transform);
-                    v2 = Vector3Transform(v2, transform);
-                    
-                    // Check collision with triangle
-                    RayCollision triCollision = GetRayCollisionTriangle(ray, v0, v1, v2);
-                    if (triCollision.hit && triCollision.distance < maxDistance) {
-                        return true;
-                    }
-                }
-            }
-        }
+    // Out of budget this tick: keep avoiding a known hit roughly ahead, the unit probes on a later tick
+    if (*probesLeft == 0) {
+        return blocked && heading >= UNIT_PROBE_STALE_DOT && clearance < UNIT_AVOIDANCE_DISTANCE;
     }
+    if (*probesLeft > 0) (*probesLeft)--;
     
-    return false;
+    Ray ray = { position, direction };
+    CollisionHit hit = RaycastCollisionScene(collision, ray, UNIT_PROBE_DISTANCE, COLLISION_QUERY_CLOSEST_HIT);
+    (*rayQueries)++;
+    
+    pool->probeOrigin[index] = position;
+    pool->probeDirection[index] = direction;
+    pool->probeDistance[index] = hit.hit ? hit.distance : UNIT_PROBE_DISTANCE;
+    
+    return hit.hit && hit.distance < UNIT_AVOIDANCE_DISTANCE;
 }
 
 // Function to get ground height at position (for terrain following)
-float GetGroundHeight(Vector3 position, Model model) {
+float GetGroundHeight(Vector3 position, const CollisionScene *collision) {
     // Cast ray downward from above the position
     Ray ray = { 
         (Vector3){position.x, position.y + 10.0f, position.z}, 
         (Vector3){0, -1, 0} 
     };
     
-    float closestDistance = 10000.0f;
-    float groundY = 0.0f;
+    // Use the height grid where the terrain is single-layer and smooth
+    float height;
+    HeightfieldResult cached = GetHeightfieldHeight(&groundHeightfield, position.x, position.z, ray.position.y, &height);
+    if (cached == HEIGHTFIELD_HEIGHT) return height + UNIT_HEIGHT_OFFSET;
+    if (cached == HEIGHTFIELD_NO_SURFACE) return UNIT_HEIGHT_OFFSET;
     
-    for (int i = 0; i < model.meshCount; i++) {
-        Mesh mesh = model.meshes[i];
+    CollisionHit hit = RaycastCollisionScene(collision, ray, 10000.0f, COLLISION_QUERY_CLOSEST_HIT);
+    
+    // If no ground found, return default height
+    if (!hit.hit) {
+        return UNIT_HEIGHT_OFFSET;
+    }
+    
+    return hit.point.y + UNIT_HEIGHT_OFFSET;
+}
+
+// Function to get ground heights for many positions with packet ray queries, returns the rays traced
+int GetGroundHeights(const Vector3 *positions, int count, const CollisionScene *collision, float *heights) {
+    Ray rays[RAY_PACKET_SIZE];
+    CollisionHit hits[RAY_PACKET_SIZE];
+    int rayTargets[RAY_PACKET_SIZE];
+    int rayCount = 0;
+    int traced = 0;
+    
+    for (int i = 0; i < count; i++) {
+        // Same downward ray as GetGroundHeight
+        Ray ray = {
+            (Vector3){positions[i].x, positions[i].y + 10.0f, positions[i].z},
+            (Vector3){0, -1, 0}
+        };
         
-        // Check bounding box first
-        BoundingBox bounds = GetMeshBoundingBox(mesh);
-        RayCollision boxCollision = GetRayCollisionBox(ray, bounds);
+        float height;
+        HeightfieldResult cached = GetHeightfieldHeight(&groundHeightfield, ray.position.x, ray.position.z, ray.position.y, &height);
+        if (cached == HEIGHTFIELD_HEIGHT) {
+            heights[i] = height + UNIT_HEIGHT_OFFSET;
+            continue;
+        }
+        if (cached == HEIGHTFIELD_NO_SURFACE) {
+            heights[i] = UNIT_HEIGHT_OFFSET;
+            continue;
+        }
         
-        if (boxCollision.hit) {
-            Matrix transform = model.transform;
-            
-            // Check triangles
-            if (mesh.indices != NULL) {
-                for (int t = 0; t < mesh.triangleCount; t++) {
-                    Vector3 v0, v1, v2;
-                    
-                    int idx0 = mesh.indices[t * 3 + 0];
-                    int idx1 = mesh.indices[t * 3 + 1];
-                    int idx2 = mesh.indices[t * 3 + 2];
-                    
-                    v0.x = mesh.vertices[idx0 * 3 + 0];
-                    v0.y = mesh.vertices[idx0 * 3 + 1];
-                    v0.z = mesh.vertices[idx0 * 3 + 2];
-                    
-                    v1.x = mesh.vertices[idx1 * 3 + 0];
-                    v1.y = mesh.vertices[idx1 * 3 + 1];
-                    v1.z = mesh.vertices[idx1 * 3 + 2];
-                    
-                    v2.x = mesh.vertices[idx2 * 3 + 0];
-                    v2.y = mesh.vertices[idx2 * 3 + 1];
-                    v2.z = mesh.vertices[idx2 * 3 + 2];
-                    
-                    v0 = Vector3Transform(v0, transform);
-                    v1 = Vector3Transform(v1, transform);
-                    v2 = Vector3Transform(v2, transform);
-                    
-                    RayCollision triCollision = GetRayCollisionTriangle(ray, v0, v1, v2);
-                    if (triCollision.hit && triCollision.distance < closestDistance) {
-                        closestDistance = triCollision.distance;
-                        groundY = triCollision.point.y;
-                    }
-                }
-            } else {
-                for (int t = 0; t < mesh.triangleCount; t++) {
-                    Vector3 v0, v1, v2;
-                    
-                    v0.x = mesh.vertices[(t * 3 + 0) * 3 + 0];
-                    v0.y = mesh.vertices[(t * 3 + 0) * 3 + 1];
-                    v0.z = mesh.vertices[(t * 3 + 0) * 3 + 2];
-                    
-                    v1.x = mesh.vertices[(t * 3 + 1) * 3 + 0];
-                    v1.y = mesh.vertices[(t * 3 + 1) * 3 + 1];
-                    v1.z = mesh.vertices[(t * 3 + 1) * 3 + 2];
-                    
-                    v2.x = mesh.vertices[(t * 3 + 2) * 3 + 0];
-                    v2.y = mesh.vertices[(t * 3 + 2) * 3 + 1];
-                    v2.z = mesh.vertices[(t * 3 + 2) * 3 + 2];
-                    
-                    v0 = Vector3Transform(v0, transform);
-                    v1 = Vector3Transform(v1, transform);
-                    v2 = Vector3Transform(v2, transform);
-                    
-                    RayCollision triCollision = GetRayCollisionTriangle(ray, v0, v1, v2);
-                    if (triCollision.hit && triCollision.distance < closestDistance) {
-                        closestDistance = triCollision.distance;
-                        groundY = triCollision.point.y;
-                    }
-                }
+        // Queue for an exact raycast, flushing full packets
+        rays[rayCount] = ray;
+        rayTargets[rayCount++] = i;
+        
+        if (rayCount == RAY_PACKET_SIZE) {
+            RaycastCollisionScenePacket(collision, rays, rayCount, 10000.0f, hits);
+            for (int r = 0; r < rayCount; r++) {
+                heights[rayTargets[r]] = hits[r].hit ? hits[r].point.y + UNIT_HEIGHT_OFFSET : UNIT_HEIGHT_OFFSET;
             }
+            traced += rayCount;
+            rayCount = 0;
         }
     }
     
-    // If no ground found, return default height
-    if (closestDistance >= 10000.0f) {
-        return UNIT_HEIGHT_OFFSET;
+    if (rayCount > 0) {
+        RaycastCollisionScenePacket(collision, rays, rayCount, 10000.0f, hits);
+        for (int r = 0; r < rayCount; r++) {
+            heights[rayTargets[r]] = hits[r].hit ? hits[r].point.y + UNIT_HEIGHT_OFFSET : UNIT_HEIGHT_OFFSET;
+        }
+        traced += rayCount;
     }
     
-    return groundY + UNIT_HEIGHT_OFFSET;
+    return traced;
 }
 
 // Function to get ground position from screen coordinates (terrain-aware)
-Vector3 GetGroundPositionFromMouse(Vector2 mousePos, Camera3D camera, Model model) {
+Vector3 GetGroundPositionFromMouse(Vector2 mousePos, Camera3D camera, const CollisionScene *collision) {
     // Create a ray from the camera through the mouse position
     Ray ray = GetMouseRay(mousePos, camera);
     
-    float closestDistance = 10000.0f;
-    Vector3 hitPoint = {0, 0, 0};
-    bool hitFound = false;
-    
     // Check for collision with model meshes
-    for (int i = 0; i < model.meshCount; i++) {
-        Mesh mesh = model.meshes[i];
-        
-        // Check bounding box first
-        BoundingBox bounds = GetMeshBoundingBox(mesh);
-        RayCollision boxCollision = GetRayCollisionBox(ray, bounds);
-        
-        if (boxCollision.hit) {
-            Matrix transform = model.transform;
-            
-            // Check triangles
-            if (mesh.indices != NULL) {
-                for (int t = 0; t < mesh.triangleCount; t++) {
-                    Vector3 v0, v1, v2;
-                    
-                    int idx0 = mesh.indices[t * 3 + 0];
-                    int idx1 = mesh.indices[t * 3 + 1];
-                    int idx2 = mesh.indices[t * 3 + 2];
-                    
-                    v0.x = mesh.vertices[idx0 * 3 + 0];
-                    v0.y = mesh.vertices[idx0 * 3 + 1];
-                    v0.z = mesh.vertices[idx0 * 3 + 2];
-                    
-                    v1.x = mesh.vertices[idx1 * 3 + 0];
-                    v1.y = mesh.vertices[idx1 * 3 + 1];
-                    v1.z = mesh.vertices[idx1 * 3 + 2];
-                    
-                    v2.x = mesh.vertices[idx2 * 3 + 0];
-                    v2.y = mesh.vertices[idx2 * 3 + 1];
-                    v2.z = mesh.vertices[idx2 * 3 + 2];
-                    
-                    v0 = Vector3Transform(v0, transform);
-                    v1 = Vector3Transform(v1, transform);
-                    v2 = Vector3Transform(v2, transform);
-                    
-                    RayCollision triCollision = GetRayCollisionTriangle(ray, v0, v1, v2);
-                    if (triCollision.hit && triCollision.distance < closestDistance) {
-                        closestDistance = triCollision.distance;
-                        hitPoint = triCollision.point;
-                        hitFound = true;
-                    }
-                }
-            }
-        }
-    }
+    CollisionHit hit = RaycastCollisionScene(collision, ray, 10000.0f, COLLISION_QUERY_CLOSEST_HIT);
+    rayQueryCounts.picking++;
     
     // If hit terrain/model, return that position
-    if (hitFound) {
+    if (hit.hit) {
+        Vector3 hitPoint = hit.point;
         hitPoint.y += UNIT_HEIGHT_OFFSET;
         return hitPoint;
     }
@@ -386,15 +328,8 @@ Vector3 GetGroundPositionFromMouse(Vector2 mousePos, Camera3D camera, Model mode
 }
 
 // Function to command selected units to a position
-void CommandUnitsToPosition(Vector3 targetPos, Model model) {
-    int selectedCount = 0;
-    
-    // Count selected units
-    for (int i = 0; i < unitCount; i++) {
-        if (units[i].active && units[i].selected) {
-            selectedCount++;
-        }
-    }
+void CommandUnitsToPosition(Vector3 targetPos, const CollisionScene *collision) {
+    int selectedCount = CountSelectedUnits(&unitPool);
     
     if (selectedCount == 0) return;
     
@@ -403,96 +338,159 @@ void CommandUnitsToPosition(Vector3 targetPos, Model model) {
     if (cols == 0) cols = 1;
     float spacing = UNIT_SIZE * 2.5f;
     
+    Vector3 *formationTargets = (Vector3 *)malloc(sizeof(Vector3) * selectedCount);
+    float *formationHeights = (float *)malloc(sizeof(float) * selectedCount);
+    int *formationUnits = (int *)malloc(sizeof(int) * selectedCount);
+    
+    if (formationTargets == NULL || formationHeights == NULL || formationUnits == NULL) {
+        printf("Failed to allocate formation for %d units\n", selectedCount);
+        free(formationTargets);
+        free(formationHeights);
+        free(formationUnits);
+        return;
+    }
+    
     int currentUnit = 0;
-    for (int i = 0; i < unitCount; i++) {
-        if (units[i].active && units[i].selected) {
-            int row = currentUnit / cols;
-            int col = currentUnit % cols;
-            
-            Vector3 formationOffset = {
-                (col - cols/2.0f) * spacing,
-                0,
-                (row - selectedCount/cols/2.0f) * spacing
-            };
-            
-            Vector3 finalTarget = Vector3Add(targetPos, formationOffset);
-            // Adjust height based on terrain
-            finalTarget.y = GetGroundHeight(finalTarget, model);
-            
-            units[i].commandTarget = finalTarget;
-            units[i].hasCommand = true;
-            units[i].moveTimer = 0;  // Reset wander timer
-            
-            currentUnit++;
-        }
+    for (int i = FindNextUnitBit(&unitPool, unitPool.selectedBits, 0); i >= 0; i = FindNextUnitBit(&unitPool, unitPool.selectedBits, i + 1)) {
+        int row = currentUnit / cols;
+        int col = currentUnit % cols;
+        
+        Vector3 formationOffset = {
+            (col - cols/2.0f) * spacing,
+            0,
+            (row - selectedCount/cols/2.0f) * spacing
+        };
+        
+        formationTargets[currentUnit] = Vector3Add(targetPos, formationOffset);
+        formationUnits[currentUnit] = i;
+        currentUnit++;
+    }
+    
+    // Adjust heights based on terrain, all formation slots in one packet query
+    if (currentUnit > 0) {
+        rayQueryCounts.ground += GetGroundHeights(formationTargets, currentUnit, collision, formationHeights);
+    }
+    
+    // The whole formation shares one flow field towards its centre
+    int field = RequestFlowField(&flowFields, &navGrid, targetPos);
+    
+    for (int i = 0; i < currentUnit; i++) {
+        int unit = formationUnits[i];
+        
+        unitPool.commandTarget[unit] = formationTargets[i];
+        unitPool.commandTarget[unit].y = formationHeights[i];
+        unitPool.commandField[unit] = field;
+        SetUnitCommand(&unitPool, unit, true);
+        unitPool.moveTimer[unit] = 0;  // Reset wander timer
     }
     
+    free(formationTargets);
+    free(formationHeights);
+    free(formationUnits);
+    
     // Set command marker
     commandMarker.position = targetPos;
     commandMarker.timer = 1.0f;
     commandMarker.active = true;
 }
 
-// Function to update unit movement
-void UpdateUnit(Unit* unit, Model model, float deltaTime) {
-    if (!unit->active) return;
-    
+// Function to rebuild the nav grid from the ground heightfield, cached flow fields are dropped
+void RebuildNavigation(void) {
+    UnloadFlowFieldCache(&flowFields);
+    UnloadNavGrid(&navGrid);
+    navGrid = LoadNavGrid(&groundHeightfield);
+    
+    if (navGrid.flags != NULL) {
+        printf("Nav grid: %dx%d cells, cell %.2f, %d walkable\n",
+               navGrid.width, navGrid.depth, navGrid.cellSize, navGrid.walkableCells);
+    }
+}
+
+// Function to check whether a commanded unit should follow its flow field, and in which direction
+// Units leave the field once their path gets about as short as the offset of their formation slot
+static bool GetUnitFlowDirection(const UnitPool *pool, int index, Vector3 *direction) {
+    const FlowField *field = FindFlowField(&flowFields, pool->commandField[index]);
+    if (field == NULL) return false;
+    
+    Vector2 flow;
+    float pathLength;
+    if (!GetFlowDirection(field, &navGrid, pool->position[index], &flow, &pathLength)) return false;
+    
+    Vector3 slot = pool->commandTarget[index];
+    float slotOffset = Vector2Distance((Vector2){ slot.x, slot.z }, (Vector2){ field->goal.x, field->goal.z });
+    if (pathLength <= slotOffset + UNIT_FLOW_DIRECT_DISTANCE) return false;
+    
+    *direction = (Vector3){ flow.x, 0, flow.y };
+    return true;
+}
+
+// Function to rebuild the unit grid, grid items are dense unit indices
+void BuildUnitGrid(void) {
+    BuildSpatialGrid(&unitGrid, NULL, unitPool.position, unitPool.count);
+}
+
+// Function to steer one unit (targets, wandering, avoidance), returns whether it still has a command
+// Runs on job threads: reads the current state and writes only this unit's entries (see ProbeUnitPath for the ray budget)
+bool UpdateUnit(UnitPool *pool, int index, const CollisionScene *collision, float deltaTime, int *probesLeft, int *rayQueries) {
+    Vector3 position = pool->position[index];
+    float rotation = pool->rotation[index];
+    bool hasCommand = HasUnitCommand(pool, index);
     Vector3 actualTarget;
     
+    pool->velocity[index] = (Vector3){0, 0, 0};
+    
     // Determine which target to use
-    if (unit->hasCommand) {
-        actualTarget = unit->commandTarget;
+    if (hasCommand) {
+        actualTarget = pool->commandTarget[index];
         
         // Check if arrived at command target
-        float distToCommand = Vector3Distance(unit->position, unit->commandTarget);
+        float distToCommand = Vector3Distance(position, actualTarget);
         if (distToCommand < UNIT_ARRIVAL_DISTANCE) {
-            unit->hasCommand = false;  // Command completed
-            unit->moveTimer = 0;  // Start wandering again
+            hasCommand = false;  // Command completed
+            pool->moveTimer[index] = 0;  // Start wandering again
         }
     } else {
         // Wander behavior when no command
-        unit->moveTimer -= deltaTime;
+        pool->moveTimer[index] -= deltaTime;
         
-        if (unit->moveTimer <= 0) {
-            float angle = GetRandomValue(0, 360) * DEG2RAD;
-            float distance = GetRandomValue(2, 8);
+        if (pool->moveTimer[index] <= 0) {
+            float angle = GetUnitRandomValue(pool, index, 0, 360) * DEG2RAD;
+            float distance = GetUnitRandomValue(pool, index, 2, 8);
             
-            unit->targetPosition = (Vector3){
-                unit->position.x + cosf(angle) * distance,
-                unit->position.y,
-                unit->position.z + sinf(angle) * distance
+            pool->targetPosition[index] = (Vector3){
+                position.x + cosf(angle) * distance,
+                position.y,
+                position.z + sinf(angle) * distance
             };
             
-            unit->moveTimer = GetRandomValue(20, 50) / 10.0f; // 2-5 seconds
+            pool->moveTimer[index] = GetUnitRandomValue(pool, index, 20, 50) / 10.0f; // 2-5 seconds
         }
         
-        actualTarget = unit->targetPosition;
+        actualTarget = pool->targetPosition[index];
     }
     
     // Calculate direction to target
-    Vector3 direction = Vector3Subtract(actualTarget, unit->position);
+    Vector3 direction = Vector3Subtract(actualTarget, position);
     float distanceToTarget = Vector3Length(direction);
     
     if (distanceToTarget > 0.1f) {
         direction = Vector3Normalize(direction);
         
-        // Check for collision in movement direction
-        bool willCollide = CheckCollisionWithModel(unit->position, direction, model, UNIT_AVOIDANCE_DISTANCE);
+        // Commanded units on the nav grid follow the shared flow field, which already routes around
+        // the model; everyone else looks ahead with a ray
+        bool willCollide = false;
+        if (!hasCommand || !GetUnitFlowDirection(pool, index, &direction)) {
+            willCollide = ProbeUnitPath(pool, index, direction, collision, probesLeft, rayQueries);
+        }
         
-        // Check collision with other units
-        for (int i = 0; i < unitCount; i++) {
-            if (&units[i] != unit && units[i].active) {
-                float dist = Vector3Distance(unit->position, units[i].position);
-                if (dist < UNIT_SIZE * 3) {
-                    willCollide = true;
-                    break;
-                }
-            }
+        // Check collision with other units in the neighbouring grid cells
+        if (!willCollide) {
+            willCollide = HasSpatialGridNeighbor(&unitGrid, position, UNIT_SEPARATION_DISTANCE, index);
         }
         
         if (willCollide) {
             // Try to find alternative direction
-            float avoidanceAngle = GetRandomValue(-90, 90) * DEG2RAD;
+            float avoidanceAngle = GetUnitRandomValue(pool, index, -90, 90) * DEG2RAD;
             float currentAngle = atan2f(direction.z, direction.x);
             float newAngle = currentAngle + avoidanceAngle;
             
@@ -503,76 +501,275 @@ void UpdateUnit(Unit* unit, Model model, float deltaTime) {
             };
             
             // If unit has a command, try to maintain progress toward it
-            if (unit->hasCommand) {
+            if (hasCommand) {
                 // Don't change the command target, just navigate around obstacle
-                Vector3 movement = Vector3Scale(direction, UNIT_SPEED * deltaTime * 0.5f);
-                unit->position = Vector3Add(unit->position, movement);
+                pool->velocity[index] = Vector3Scale(direction, UNIT_SPEED * 0.5f);
             } else {
                 // Set new random target for wandering
-                unit->targetPosition = Vector3Add(unit->position, Vector3Scale(direction, 3.0f));
-                unit->moveTimer = 1.0f;
+                pool->targetPosition[index] = Vector3Add(position, Vector3Scale(direction, 3.0f));
+                pool->moveTimer[index] = 1.0f;
             }
         } else {
             // Move towards target
-            Vector3 movement = Vector3Scale(direction, UNIT_SPEED * deltaTime);
-            unit->position = Vector3Add(unit->position, movement);
+            pool->velocity[index] = Vector3Scale(direction, UNIT_SPEED);
             
             // Update rotation to face movement direction
             float targetRotation = atan2f(direction.z, direction.x);
-            float rotationDiff = targetRotation - unit->rotation;
+            float rotationDiff = targetRotation - rotation;
             
             // Normalize rotation difference
             while (rotationDiff > PI) rotationDiff -= 2 * PI;
             while (rotationDiff < -PI) rotationDiff += 2 * PI;
             
-            unit->rotation += rotationDiff * UNIT_TURN_SPEED * deltaTime;
+            rotation += rotationDiff * UNIT_TURN_SPEED * deltaTime;
         }
     }
     
-    // Keep units on ground level (terrain-aware)
-    float groundHeight = GetGroundHeight(unit->position, model);
-    unit->position.y = groundHeight;
+    pool->nextRotation[index] = rotation;
+    return hasCommand;
+}
+
+// Function to compute out = values + rates * scale; fixed-size blocks let it vectorize even at -O2
+static void IntegrateFloats(float *restrict out, const float *restrict values, const float *restrict rates, int count, float scale) {
+    int i = 0;
+    
+    for (; i + UNIT_INTEGRATE_BLOCK <= count; i += UNIT_INTEGRATE_BLOCK) {
+        for (int k = 0; k < UNIT_INTEGRATE_BLOCK; k++) {
+            out[i + k] = values[i + k] + rates[i + k] * scale;
+        }
+    }
+    for (; i < count; i++) {
+        out[i] = values[i] + rates[i] * scale;
+    }
+}
+
+// Parameters of one simulation step, shared by all of its jobs
+typedef struct {
+    UnitPool *pool;
+    const CollisionScene *collision;
+    float deltaTime;
+    int probeBudget;               // Look-ahead rays for the whole step, 0 = unlimited
+    unsigned int tick;             // Steps started so far, rotates the budget
+    long long jobNanoseconds;      // CPU time of all jobs, for the profiler
+    long long rayNanoseconds;      // Part of it spent on ground queries
+    long long avoidanceRays;       // Ray queries of all jobs, for the benchmark report
+    long long groundRays;
+} UnitStep;
+
+// Function to simulate a range of units: steering, integration, then ground following
+// Ranges start on a bitset word boundary, so each job owns whole command words
+static void SimulateUnitRange(void *userData, int first, int count) {
+    UnitStep *step = (UnitStep *)userData;
+    UnitPool *pool = step->pool;
+    double jobStart = GetTime();
+    int avoidanceRays = 0;
+    
+    // The range's share of the probe budget, split by unit index so it never depends on the threads;
+    // the split shifts every tick so ranges whose share rounds to zero still get turns
+    int probesLeft = -1;
+    int start = 0;
+    if (step->probeBudget > 0) {
+        long long budget = step->probeBudget;
+        long long total = pool->count;
+        long long shift = ((long long)step->tick * UNIT_JOB_CHUNK) % total;
+        probesLeft = (int)(budget * (first + count + shift) / total - budget * (first + shift) / total);
+        
+        // Units take turns: each tick starts probing one share further into the range
+        start = (int)(((long long)step->tick * probesLeft) % count);
+    }
+    
+    unsigned int bits[UNIT_JOB_CHUNK / UNIT_BITS_PER_WORD] = {0};
+    for (int k = 0; k < count; k++) {
+        int local = (start + k) % count;
+        if (UpdateUnit(pool, first + local, step->collision, step->deltaTime, &probesLeft, &avoidanceRays)) {
+            bits[local / UNIT_BITS_PER_WORD] |= 1u << (local % UNIT_BITS_PER_WORD);
+        }
+    }
+    for (int w = 0; w * UNIT_BITS_PER_WORD < count; w++) {
+        pool->nextCommandBits[first / UNIT_BITS_PER_WORD + w] = bits[w];
+    }
+    
+    // Positions and velocities are packed floats, so both arrays are walked as one flat loop
+    IntegrateFloats((float *)(pool->nextPosition + first), (const float *)(pool->position + first),
+                    (const float *)(pool->velocity + first), count * 3, step->deltaTime);
+    
+    // Keep units on ground level (terrain-aware), batched so misses share ray packets
+    float heights[UNIT_JOB_CHUNK];
+    double rayStart = GetTime();
+    int groundRays = GetGroundHeights(pool->nextPosition + first, count, step->collision, heights);
+    for (int i = 0; i < count; i++) {
+        pool->nextPosition[first + i].y = heights[i];
+    }
+    
+    // Job timings and ray counts are summed from every thread
+    double jobEnd = GetTime();
+    ATOMIC_FETCH_ADD(&step->jobNanoseconds, (long long)((jobEnd - jobStart) * 1e9));
+    ATOMIC_FETCH_ADD(&step->rayNanoseconds, (long long)((jobEnd - rayStart) * 1e9));
+    ATOMIC_FETCH_ADD(&step->avoidanceRays, (long long)avoidanceRays);
+    ATOMIC_FETCH_ADD(&step->groundRays, (long long)groundRays);
+}
+
+// Simulation step in flight on the job system
+UnitStep unitStep = {0};
+bool unitStepRunning = false;
+
+// Fixed-rate simulation clock: frame time is banked and spent in whole ticks
+typedef struct {
+    float tickTime;            // Seconds per tick
+    int maxSubsteps;
+    float accumulator;         // Frame time not simulated yet, including the tick in flight
+} UnitClock;
+
+UnitClock unitClock = { 1.0f / UNIT_TICK_RATE, UNIT_MAX_SUBSTEPS, 0.0f };
+
+// Look-ahead rays allowed per step, 0 = unlimited
+int unitProbeBudget = UNIT_PROBE_BUDGET;
+
+// Function to start simulating the next step on the job threads
+void BeginUnitStep(const CollisionScene *collision, float deltaTime) {
+    BuildUnitGrid();
+    
+    unitStep.pool = &unitPool;
+    unitStep.collision = collision;
+    unitStep.deltaTime = deltaTime;
+    unitStep.probeBudget = unitProbeBudget;
+    unitStep.tick++;
+    unitStep.jobNanoseconds = 0;
+    unitStep.rayNanoseconds = 0;
+    unitStep.avoidanceRays = 0;
+    unitStep.groundRays = 0;
+    
+    BeginParallelFor(&unitJobs, unitPool.count, UNIT_JOB_CHUNK, SimulateUnitRange, &unitStep);
+    unitStepRunning = true;
+}
+
+// Function to wait for the running step and make its output current
+void FinishUnitStep(void) {
+    if (!unitStepRunning) return;
+    
+    WaitParallelFor(&unitJobs);
+    SwapUnitBuffers(&unitPool);
+    unitStepRunning = false;
+    unitClock.accumulator -= unitStep.deltaTime;
+    
+    // The step ran alongside the previous frame, its job time is reported with this one
+    AddProfileZoneTime(PROFILE_ZONE_UNIT_JOBS, unitStep.jobNanoseconds * 1e-9);
+    AddProfileZoneTime(PROFILE_ZONE_GROUND_RAYS, unitStep.rayNanoseconds * 1e-9);
+    rayQueryCounts.avoidance += unitStep.avoidanceRays;
+    rayQueryCounts.ground += unitStep.groundRays;
+}
+
+// Function to spend the banked frame time on unit ticks and blend the drawn state
+// Catch-up ticks wait for their jobs, the last due tick runs while the frame is drawn and is
+// only taken off the clock once collected, so drawing trails the simulation by one tick
+void UpdateUnitClock(const CollisionScene *collision, float frameTime) {
+    float tick = unitClock.tickTime;
+    unitClock.accumulator += frameTime;
+    
+    int substeps = 1;
+    while (unitClock.accumulator >= 2.0f * tick && substeps < unitClock.maxSubsteps) {
+        BeginUnitStep(collision, tick);
+        FinishUnitStep();
+        substeps++;
+    }
+    
+    // Time past the cap is dropped, so a hitch slows units down instead of moving them through walls
+    if (unitClock.accumulator >= 2.0f * tick) unitClock.accumulator = tick;
+    
+    if (unitClock.accumulator >= tick) {
+        BeginUnitStep(collision, tick);
+    } else {
+        BuildUnitGrid();  // Culling still needs the grid of the current positions
+    }
+    
+    float alpha = unitClock.accumulator / tick;
+    InterpolateUnits(&unitPool, (alpha < 1.0f) ? alpha : 1.0f);
+}
+
+// State shared by the unit frustum query
+typedef struct {
+    const Frustum *frustum;
+    const UnitPool *pool;
+} UnitCullQuery;
+
+// Function to keep the units whose outline sphere touches the frustum where they are drawn
+static bool CollectVisibleUnit(int item, Vector3 position, void *userData) {
+    UnitCullQuery *query = (UnitCullQuery *)userData;
+    float radius = query->pool->size[item] * UNIT_RENDER_OUTLINE_SCALE;
+    (void)position;
+    
+    if (IsSphereInFrustum(query->frustum, query->pool->drawPosition[item], radius)) {
+        visibleUnits.units[visibleUnits.count++] = item;
+    }
+    return true;
+}
+
+// Function to collect the units to draw, querying the unit grid with the frustum bounds (NULL keeps every unit)
+void CullUnits(const Frustum *frustum) {
+    visibleUnits.count = 0;
+    
+    if (visibleUnits.capacity < unitPool.count) {
+        int *units = (int *)realloc(visibleUnits.units, sizeof(int) * unitPool.capacity);
+        if (units == NULL) {
+            printf("Failed to allocate visible unit list for %d units\n", unitPool.capacity);
+            return;
+        }
+        visibleUnits.units = units;
+        visibleUnits.capacity = unitPool.capacity;
+    }
+    
+    if (frustum == NULL) {
+        for (int i = 0; i < unitPool.count; i++) {
+            visibleUnits.units[visibleUnits.count++] = i;
+        }
+        return;
+    }
+    
+    // The grid holds current unit centres, grow the box by the reach of the largest unit
+    // and by one tick of movement, units are drawn up to a tick behind
+    float margin = UNIT_SIZE * UNIT_RENDER_OUTLINE_SCALE + UNIT_SPEED * unitClock.tickTime;
+    BoundingBox box = {
+        (Vector3){ frustum->bounds.min.x - margin, frustum->bounds.min.y - margin, frustum->bounds.min.z - margin },
+        (Vector3){ frustum->bounds.max.x + margin, frustum->bounds.max.y + margin, frustum->bounds.max.z + margin }
+    };
+    
+    UnitCullQuery query = { frustum, &unitPool };
+    VisitSpatialGridBox(&unitGrid, box, CollectVisibleUnit, &query);
 }
 
 // Function to draw a unit
-void DrawUnit(Unit* unit, Camera3D camera) {
-    if (!unit->active) return;
+void DrawUnit(const UnitPool *pool, int index) {
+    Vector3 position = pool->drawPosition[index];
+    float size = pool->size[index];
+    bool selected = IsUnitSelected(pool, index);
+    bool hasCommand = HasUnitCommand(pool, index);
     
     // Change color based on state
-    Color unitColor = unit->color;
-    if (unit->selected) {
-        unitColor = unit->hasCommand ? SKYBLUE : LIME;
+    Color unitColor = pool->color[index];
+    if (selected) {
+        unitColor = hasCommand ? SKYBLUE : LIME;
     }
     
     // Draw cube body
-    DrawCube(unit->position, unit->size, unit->size, unit->size, unitColor);
-    DrawCubeWires(unit->position, unit->size, unit->size, unit->size, BLACK);
+    DrawCube(position, size, size, size, unitColor);
+    DrawCubeWires(position, size, size, size, BLACK);
     
     // Draw direction indicator
     Vector3 front = {
-        unit->position.x + cosf(unit->rotation) * unit->size,
-        unit->position.y,
-        unit->position.z + sinf(unit->rotation) * unit->size
+        position.x + cosf(pool->drawRotation[index]) * size,
+        position.y,
+        position.z + sinf(pool->drawRotation[index]) * size
     };
-    DrawLine3D(unit->position, front, RED);
+    DrawLine3D(position, front, RED);
     
     // Draw selection indicator
-    if (unit->selected) {
-        DrawCubeWires(unit->position, unit->size * 1.5f, unit->size * 1.5f, unit->size * 1.5f, GREEN);
-    }
-    
-    // Draw group number above unit
-    if (unit->groupId > 0) {
-        Vector2 screenPos = GetWorldToScreen(
-            (Vector3){unit->position.x, unit->position.y + unit->size, unit->position.z}, 
-            camera
-        );
-        DrawText(TextFormat("%d", unit->groupId), screenPos.x - 5, screenPos.y - 10, 10, YELLOW);
+    if (selected) {
+        DrawCubeWires(position, size * 1.5f, size * 1.5f, size * 1.5f, GREEN);
     }
     
     // Draw command target line for selected units
-    if (unit->selected && unit->hasCommand) {
-        DrawLine3D(unit->position, unit->commandTarget, Fade(GREEN, 0.3f));
+    if (selected && hasCommand) {
+        DrawLine3D(position, pool->commandTarget[index], Fade(GREEN, 0.3f));
     }
 }
 
@@ -598,113 +795,105 @@ void DrawCommandMarker(float deltaTime) {
     DrawLine3D(commandMarker.position, beamTop, Fade(GREEN, alpha));
 }
 
+// Function to select every unit whose shown position falls in the frustum under a screen rectangle
+static bool SelectUnitInFrustum(int item, Vector3 position, void *userData) {
+    const Frustum *frustum = (const Frustum *)userData;
+    (void)position;
+    
+    if (IsSphereInFrustum(frustum, unitPool.drawPosition[item], 0.0f)) {
+        SetUnitSelected(&unitPool, item, true);
+    }
+    return true;
+}
+
 // Function to select units within a rectangle
 void SelectUnitsInBox(Vector2 start, Vector2 end, Camera3D camera) {
     // Deselect all units first
-    for (int i = 0; i < unitCount; i++) {
-        units[i].selected = false;
-    }
+    ClearUnitSelection(&unitPool);
     
-    // Get screen space bounding box
+    // Get screen space bounding box, a click still covers a few pixels
     float minX = fminf(start.x, end.x);
     float maxX = fmaxf(start.x, end.x);
     float minY = fminf(start.y, end.y);
     float maxY = fmaxf(start.y, end.y);
-    
-    // Check each unit
-    for (int i = 0; i < unitCount; i++) {
-        if (!units[i].active) continue;
-        
-        // Project unit position to screen space
-        Vector2 screenPos = GetWorldToScreen(units[i].position, camera);
-        
-        // Check if within selection box
-        if (screenPos.x >= minX && screenPos.x <= maxX &&
-            screenPos.y >= minY && screenPos.y <= maxY) {
-            units[i].selected = true;
-        }
+    if (maxX - minX < ISO_SELECTION_MIN_SIZE) {
+        minX -= ISO_SELECTION_MIN_SIZE * 0.5f;
+        maxX = minX + ISO_SELECTION_MIN_SIZE;
+    }
+    if (maxY - minY < ISO_SELECTION_MIN_SIZE) {
+        minY -= ISO_SELECTION_MIN_SIZE * 0.5f;
+        maxY = minY + ISO_SELECTION_MIN_SIZE;
     }
+    
+    // Units inside the rectangle are the ones inside the view frustum narrowed to it
+    Rectangle rect = { minX, minY, maxX - minX, maxY - minY };
+    Frustum frustum = GetScreenRectFrustum(camera, GetScreenWidth(), GetScreenHeight(), rect);
+    
+    // The grid is only rebuilt while units are simulated, refresh it (no step runs during camera updates);
+    // units are shown up to a tick away from their centre in it
+    BuildUnitGrid();
+    float margin = UNIT_SPEED * unitClock.tickTime;
+    BoundingBox box = {
+        (Vector3){ frustum.bounds.min.x - margin, frustum.bounds.min.y - margin, frustum.bounds.min.z - margin },
+        (Vector3){ frustum.bounds.max.x + margin, frustum.bounds.max.y + margin, frustum.bounds.max.z + margin }
+    };
+    VisitSpatialGridBox(&unitGrid, box, SelectUnitInFrustum, &frustum);
 }
 
 // Function to assign selected units to a control group
 void AssignControlGroup(int groupNum) {
-    if (groupNum < 1 || groupNum > 9) return;
-    
-    // Clear old group assignments for selected units
-    for (int i = 0; i < unitCount; i++) {
-        if (units[i].active && units[i].selected) {
-            // Remove from old group if any
-            if (units[i].groupId > 0) {
-                ControlGroup* oldGroup = &controlGroups[units[i].groupId];
-                for (int j = 0; j < oldGroup->unitCount; j++) {
-                    if (oldGroup->unitIndices[j] == i) {
-                        // Shift remaining units
-                        for (int k = j; k < oldGroup->unitCount - 1; k++) {
-                            oldGroup->unitIndices[k] = oldGroup->unitIndices[k + 1];
-                        }
-                        oldGroup->unitCount--;
-                        break;
-                    }
-                }
-            }
-            units[i].groupId = groupNum;
-        }
-    }
-    
-    // Build new group
-    ControlGroup* group = &controlGroups[groupNum];
-    group->unitCount = 0;
-    group->active = true;
+    if (groupNum < 1 || groupNum >= UNIT_GROUP_COUNT) return;
     
-    for (int i = 0; i < unitCount; i++) {
-        if (units[i].active && units[i].selected) {
-            group->unitIndices[group->unitCount++] = i;
-        }
+    // The group becomes exactly the selection, selected units leave the group they were in
+    ClearUnitGroup(&unitPool, groupNum);
+    for (int i = FindNextUnitBit(&unitPool, unitPool.selectedBits, 0); i >= 0; i = FindNextUnitBit(&unitPool, unitPool.selectedBits, i + 1)) {
+        SetUnitGroup(&unitPool, i, groupNum);
     }
 }
 
 // Function to select units in a control group and center camera
 Vector3 SelectControlGroup(int groupNum) {
-    if (groupNum < 1 || groupNum > 9) return (Vector3){0, 0, 0};
-    
-    ControlGroup* group = &controlGroups[groupNum];
-    if (!group->active || group->unitCount == 0) return (Vector3){0, 0, 0};
+    if (groupNum < 1 || groupNum >= UNIT_GROUP_COUNT) return (Vector3){0, 0, 0};
+    if (unitPool.groupCount[groupNum] == 0) return (Vector3){0, 0, 0};
     
-    // Deselect all units first
-    for (int i = 0; i < unitCount; i++) {
-        units[i].selected = false;
-    }
+    // Deleted units already left their group, so the bitset is the selection
+    SelectUnitGroup(&unitPool, groupNum);
     
-    // Select units in group and calculate center
+    // Calculate center
     Vector3 center = {0, 0, 0};
-    int validCount = 0;
-    
-    for (int i = 0; i < group->unitCount; i++) {
-        int unitIdx = group->unitIndices[i];
-        if (unitIdx < unitCount && units[unitIdx].active) {
-            units[unitIdx].selected = true;
-            center.x += units[unitIdx].position.x;
-            center.y += units[unitIdx].position.y;
-            center.z += units[unitIdx].position.z;
-            validCount++;
-        }
+    const unsigned int *members = unitPool.groupBits[groupNum];
+    for (int unit = FindNextUnitBit(&unitPool, members, 0); unit >= 0; unit = FindNextUnitBit(&unitPool, members, unit + 1)) {
+        center.x += unitPool.position[unit].x;
+        center.y += unitPool.position[unit].y;
+        center.z += unitPool.position[unit].z;
     }
     
-    if (validCount > 0) {
-        center.x /= validCount;
-        center.y /= validCount;
-        center.z /= validCount;
-        return center;
-    }
+    int count = unitPool.groupCount[groupNum];
+    center.x /= count;
+    center.y /= count;
+    center.z /= count;
+    return center;
+}
+
+// Function to place the camera from the orbit parameters
+void SetOrbitCameraView(Camera3D *camera, const OrbitCamera *orbit) {
+    float cosV = cosf(orbit->rotationV);
+    float sinV = sinf(orbit->rotationV);
+    float cosH = cosf(orbit->rotationH);
+    float sinH = sinf(orbit->rotationH);
+    
+    camera->position.x = orbit->target.x + orbit->distance * cosV * sinH;
+    camera->position.y = orbit->target.y + orbit->distance * sinV;
+    camera->position.z = orbit->target.z + orbit->distance * cosV * cosH;
     
-    return (Vector3){0, 0, 0};
+    camera->target = orbit->target;
 }
 
 // Function to update orbit camera based on input
-void UpdateOrbitCamera(Camera3D *camera, OrbitCamera *orbit) {
+void UpdateOrbitCamera(Camera3D *camera, OrbitCamera *orbit, const FrameInput *input) {
     // Mouse controls for rotation
-    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-        Vector2 mouseDelta = GetMouseDelta();
+    if (IsInputButtonDown(input, MOUSE_BUTTON_LEFT)) {
+        Vector2 mouseDelta = input->mouseDelta;
         orbit->rotationH -= mouseDelta.x * CAMERA_MOUSE_SENSITIVITY;
         orbit->rotationV += mouseDelta.y * CAMERA_MOUSE_SENSITIVITY;
         
@@ -714,7 +903,7 @@ void UpdateOrbitCamera(Camera3D *camera, OrbitCamera *orbit) {
     }
     
     // Mouse wheel for zoom
-    float wheelMove = GetMouseWheelMove();
+    float wheelMove = input->mouseWheel;
     if (wheelMove != 0) {
         orbit->distance -= wheelMove * orbit->distance * CAMERA_ZOOM_SPEED;
         if (orbit->distance < CAMERA_MIN_DISTANCE) orbit->distance = CAMERA_MIN_DISTANCE;
@@ -722,8 +911,8 @@ void UpdateOrbitCamera(Camera3D *camera, OrbitCamera *orbit) {
     }
     
     // Middle mouse button for panning
-    if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) {
-        Vector2 mouseDelta = GetMouseDelta();
+    if (IsInputButtonDown(input, MOUSE_BUTTON_MIDDLE)) {
+        Vector2 mouseDelta = input->mouseDelta;
         
         // Calculate right and up vectors based on camera orientation
         float cosH = cosf(orbit->rotationH);
@@ -736,40 +925,29 @@ void UpdateOrbitCamera(Camera3D *camera, OrbitCamera *orbit) {
     }
     
     // Reset camera with R key
-    if (IsKeyPressed(KEY_R)) {
+    if (IsInputKeyPressed(input, KEY_R)) {
         orbit->distance = 5.0f;
         orbit->rotationH = PI * 0.25f;
         orbit->rotationV = PI * 0.15f;
         orbit->target = (Vector3){0.0f, 0.0f, 0.0f};
     }
     
-    // Calculate camera position from orbit parameters
-    float cosV = cosf(orbit->rotationV);
-    float sinV = sinf(orbit->rotationV);
-    float cosH = cosf(orbit->rotationH);
-    float sinH = sinf(orbit->rotationH);
-    
-    camera->position.x = orbit->target.x + orbit->distance * cosV * sinH;
-    camera->position.y = orbit->target.y + orbit->distance * sinV;
-    camera->position.z = orbit->target.z + orbit->distance * cosV * cosH;
-    
-    camera->target = orbit->target;
+    SetOrbitCameraView(camera, orbit);
 }
 
 // Function to update isometric camera
-void UpdateIsometricCamera(Camera3D *camera, IsometricCamera *iso) {
-    float deltaTime = GetFrameTime();
-    Vector2 mousePos = GetMousePosition();
+void UpdateIsometricCamera(Camera3D *camera, IsometricCamera *iso, const FrameInput *input, float deltaTime) {
+    Vector2 mousePos = input->mousePosition;
     
     // Calculate movement direction
     float moveX = 0.0f;
     float moveZ = 0.0f;
     
     // Keyboard controls (WASD and arrow keys)
-    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) moveZ -= 1.0f;
-    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) moveZ += 1.0f;
-    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) moveX -= 1.0f;
-    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) moveX += 1.0f;
+    if (IsInputKeyDown(input, KEY_W) || IsInputKeyDown(input, KEY_UP)) moveZ -= 1.0f;
+    if (IsInputKeyDown(input, KEY_S) || IsInputKeyDown(input, KEY_DOWN)) moveZ += 1.0f;
+    if (IsInputKeyDown(input, KEY_A) || IsInputKeyDown(input, KEY_LEFT)) moveX -= 1.0f;
+    if (IsInputKeyDown(input, KEY_D) || IsInputKeyDown(input, KEY_RIGHT)) moveX += 1.0f;
     
     // Edge scrolling
     if (mousePos.x < ISO_CAMERA_EDGE_SCROLL_ZONE) moveX -= 1.0f;
@@ -785,8 +963,8 @@ void UpdateIsometricCamera(Camera3D *camera, IsometricCamera *iso) {
     iso->targetTarget.z += moveZ * moveSpeed * deltaTime;
     
     // Middle mouse button drag for panning
-    if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) {
-        Vector2 mouseDelta = GetMouseDelta();
+    if (IsInputButtonDown(input, MOUSE_BUTTON_MIDDLE)) {
+        Vector2 mouseDelta = input->mouseDelta;
         float panSpeed = iso->height * 0.002f;
         
         iso->targetPosition.x -= mouseDelta.x * panSpeed;
@@ -796,14 +974,14 @@ void UpdateIsometricCamera(Camera3D *camera, IsometricCamera *iso) {
     }
     
     // Mouse wheel zoom
-    float wheelMove = GetMouseWheelMove();
+    float wheelMove = input->mouseWheel;
     if (wheelMove != 0) {
         iso->height -= wheelMove * ISO_CAMERA_ZOOM_SPEED;
         iso->height = fmaxf(ISO_CAMERA_MIN_HEIGHT, fminf(ISO_CAMERA_MAX_HEIGHT, iso->height));
     }
     
     // Selection box handling
-    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+    if (IsInputButtonPressed(input, MOUSE_BUTTON_LEFT)) {
         iso->selecting = true;
         iso->selectionStart = mousePos;
         iso->selectionEnd = mousePos;
@@ -812,7 +990,7 @@ void UpdateIsometricCamera(Camera3D *camera, IsometricCamera *iso) {
     if (iso->selecting) {
         iso->selectionEnd = mousePos;
         
-        if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
+        if (IsInputButtonReleased(input, MOUSE_BUTTON_LEFT)) {
             iso->selecting = false;
             // Handle selection for units
             SelectUnitsInBox(iso->selectionStart, iso->selectionEnd, *camera);
@@ -820,14 +998,14 @@ void UpdateIsometricCamera(Camera3D *camera, IsometricCamera *iso) {
     }
     
     // Right click to command units  
-    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
+    if (IsInputButtonPressed(input, MOUSE_BUTTON_RIGHT)) {
         // Need to access model through isometric camera's parent context
         // For now, we'll need to pass model as parameter
         // This is handled in the main loop
     }
     
     // Reset camera with R key
-    if (IsKeyPressed(KEY_R)) {
+    if (IsInputKeyPressed(input, KEY_R)) {
         iso->position = (Vector3){0.0f, 15.0f, 10.0f};
         iso->target = (Vector3){0.0f, 0.0f, 0.0f};
         iso->targetPosition = iso->position;
@@ -849,6 +1027,55 @@ void UpdateIsometricCamera(Camera3D *camera, IsometricCamera *iso) {
     camera->target = iso->target;
 }
 
+// Function to check whether the isometric camera has caught up with where it is heading
+bool IsIsometricCameraSettled(const IsometricCamera *iso) {
+    return fabsf(iso->targetPosition.x - iso->position.x) < IDLE_SETTLE_DISTANCE &&
+           fabsf(iso->targetPosition.z - iso->position.z) < IDLE_SETTLE_DISTANCE &&
+           fabsf(iso->targetTarget.x - iso->target.x) < IDLE_SETTLE_DISTANCE &&
+           fabsf(iso->targetTarget.z - iso->target.z) < IDLE_SETTLE_DISTANCE &&
+           !iso->selecting;
+}
+
+// Function to check for input that may change what is drawn (keys, mouse buttons, mouse motion, wheel)
+bool HasFrameInput(const FrameInput *input) {
+    if (input->mouseDelta.x != 0.0f || input->mouseDelta.y != 0.0f || input->mouseWheel != 0.0f) return true;
+    if (input->buttonsDown != 0 || input->buttonsReleased != 0) return true;
+    
+    for (int i = 0; i < FRAME_INPUT_KEY_WORDS; i++) {
+        if (input->keysDown[i] != 0 || input->keysReleased[i] != 0) return true;
+    }
+    return false;
+}
+
+// Function to present the cached frame (render textures are stored bottom-up)
+void DrawFrameCache(RenderTexture2D cache) {
+    Rectangle source = { 0.0f, 0.0f, (float)cache.texture.width, -(float)cache.texture.height };
+    DrawTextureRec(cache.texture, source, (Vector2){ 0.0f, 0.0f }, WHITE);
+}
+
+// Function to move the orbit camera along the benchmark path: turns around the model while zooming in and out
+void UpdateBenchmarkCamera(Camera3D *camera, OrbitCamera *orbit, int frame, float startDistance) {
+    orbit->rotationH = PI * 0.25f + 2.0f * PI * (float)frame / BENCH_CAMERA_ORBIT_FRAMES;
+    orbit->distance = startDistance * (1.0f + BENCH_CAMERA_ZOOM_RANGE * sinf(2.0f * PI * (float)frame / BENCH_CAMERA_ZOOM_FRAMES));
+    SetOrbitCameraView(camera, orbit);
+}
+
+// Function to send every unit to the next scripted screen point, picked like a right click
+void CommandBenchmarkUnits(int frame, Camera3D camera, const CollisionScene *collision) {
+    int point = (frame / BENCH_COMMAND_INTERVAL) % BENCH_COMMAND_POINTS;
+    float angle = 2.0f * PI * point / BENCH_COMMAND_POINTS;
+    Vector2 screenPoint = {
+        GetScreenWidth() * (0.5f + 0.25f * cosf(angle)),
+        GetScreenHeight() * (0.5f + 0.25f * sinf(angle))
+    };
+    
+    for (int i = 0; i < unitPool.count; i++) {
+        SetUnitSelected(&unitPool, i, true);
+    }
+    Vector3 targetPos = GetGroundPositionFromMouse(screenPoint, camera, collision);
+    CommandUnitsToPosition(targetPos, collision);
+}
+
 // Function to draw selection box
 void DrawSelectionBox(IsometricCamera *iso) {
     if (!iso->selecting) return;
@@ -862,37 +1089,143 @@ void DrawSelectionBox(IsometricCamera *iso) {
     DrawRectangle(x, y, width, height, Fade(GREEN, 0.1f));
 }
 
+// Function to draw the loading screen shown while the model file is read
+void DrawLoadingScreen(const char *path, const char *stage, float progress) {
+    int barWidth = WINDOW_WIDTH - 200;
+    int barX = 100;
+    int barY = WINDOW_HEIGHT / 2;
+    
+    ClearBackground((Color){48, 48, 56, 255});
+    DrawText(TextFormat("Loading %s", GetFileName(path)), barX, barY - 40, 20, WHITE);
+    DrawText(stage, barX, barY - 15, 10, GRAY);
+    DrawRectangle(barX, barY, barWidth, 12, Fade(BLACK, 0.7f));
+    DrawRectangle(barX, barY, (int)(barWidth * progress), 12, GREEN);
+    DrawText(TextFormat("%d%%", (int)(progress * 100.0f)), barX + barWidth + 10, barY, 10, GRAY);
+}
+
 // Function to calculate model bounds
-BoundingBox GetModelBounds(Model model) {
-    BoundingBox bounds = {0};
-    
-    if (model.meshCount > 0) {
-        bounds = GetMeshBoundingBox(model.meshes[0]);
-        
-        for (int i = 1; i < model.meshCount; i++) {
-            BoundingBox meshBounds = GetMeshBoundingBox(model.meshes[i]);
-            
-            bounds.min.x = fminf(bounds.min.x, meshBounds.min.x);
-            bounds.min.y = fminf(bounds.min.y, meshBounds.min.y);
-            bounds.min.z = fminf(bounds.min.z, meshBounds.min.z);
-            
-            bounds.max.x = fmaxf(bounds.max.x, meshBounds.max.x);
-            bounds.max.y = fmaxf(bounds.max.y, meshBounds.max.y);
-            bounds.max.z = fmaxf(bounds.max.z, meshBounds.max.z);
-        }
-    }
-    
-    return bounds;
+BoundingBox GetModelBounds(const ModelInfo *info) {
+    // Mesh bounds are computed once at load
+    return info->bounds;
 }
 
 int main(int argc, char *argv[]) {
     // Get model filename from command line or use default
     const char *modelPath = "ibm-pc.glb";
-    if (argc > 1) {
-        modelPath = argv[1];
+    bool useHeightfield = true;
+    bool useFlowField = true;
+    float heightfieldCellSize = HEIGHTFIELD_DEFAULT_CELL_SIZE;
+    int workerThreads = -1;  // Negative = one per extra CPU core
+    bool useInstancing = true;
+    bool useCulling = true;
+    bool keepMeshData = false;
+    bool useSceneCache = true;
+    bool useLod = true;
+    bool useBatching = true;
+    bool optimizeMeshes = false;
+    bool quantizeVertices = false;
+    bool useKtx2 = true;
+    bool idleMode = false;
+    float lodPixelError = MESH_LOD_DEFAULT_PIXEL_ERROR;
+    int collisionLod = 0;
+    BenchSettings benchSettings = GetDefaultBenchSettings();
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    const char *scenePath = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-heightfield") == 0) {
+            useHeightfield = false;
+        } else if (strcmp(argv[i], "--no-flowfield") == 0) {
+            useFlowField = false;
+        } else if (strcmp(argv[i], "--heightfield-cell") == 0 && i + 1 < argc) {
+            heightfieldCellSize = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            workerThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-instancing") == 0) {
+            useInstancing = false;
+        } else if (strcmp(argv[i], "--no-culling") == 0) {
+            useCulling = false;
+        } else if (strcmp(argv[i], "--keep-mesh-data") == 0) {
+            keepMeshData = true;
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            useSceneCache = false;
+        } else if (strcmp(argv[i], "--no-lod") == 0) {
+            useLod = false;
+        } else if (strcmp(argv[i], "--no-batching") == 0) {
+            useBatching = false;
+        } else if (strcmp(argv[i], "--optimize-meshes") == 0) {
+            optimizeMeshes = true;
+        } else if (strcmp(argv[i], "--quantize-vertices") == 0) {
+            quantizeVertices = true;
+        } else if (strcmp(argv[i], "--no-ktx2") == 0) {
+            useKtx2 = false;
+        } else if (strcmp(argv[i], "--idle") == 0) {
+            idleMode = true;
+        } else if (strcmp(argv[i], "--lod-error") == 0 && i + 1 < argc) {
+            lodPixelError = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--collision-lod") == 0 && i + 1 < argc) {
+            collisionLod = atoi(argv[++i]);
+            if (collisionLod < 0) collisionLod = 0;
+            if (collisionLod >= MESH_LOD_MAX_LEVELS) collisionLod = MESH_LOD_MAX_LEVELS - 1;
+        } else if (strcmp(argv[i], "--probe-budget") == 0 && i + 1 < argc) {
+            unitProbeBudget = atoi(argv[++i]);
+            if (unitProbeBudget < 0) unitProbeBudget = 0;
+        } else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            float tickRate = (float)atof(argv[++i]);
+            if (tickRate > 0.0f) unitClock.tickTime = 1.0f / tickRate;
+        } else if (strcmp(argv[i], "--max-substeps") == 0 && i + 1 < argc) {
+            unitClock.maxSubsteps = atoi(argv[++i]);
+            if (unitClock.maxSubsteps < 1) unitClock.maxSubsteps = 1;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            benchSettings.enabled = true;
+        } else if (strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc) {
+            benchSettings.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-units") == 0 && i + 1 < argc) {
+            benchSettings.units = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-output") == 0 && i + 1 < argc) {
+            benchSettings.outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--hidden") == 0) {
+            benchSettings.hidden = true;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scenePath = argv[++i];
+        } else {
+            modelPath = argv[i];
+        }
+    }
+    
+    // A replay is a benchmark whose input comes from the log instead of the script, every logged frame is measured
+    InputReplay replay = {0};
+    bool replaying = replayPath != NULL;
+    if (replaying) {
+        if (!LoadInputReplay(&replay, replayPath)) return 1;
+        benchSettings.enabled = true;
+        benchSettings.frames = replay.frameCount;
+        benchSettings.warmupFrames = 0;
+    }
+    
+    // Tiles skip the single-model passes: rays hit their BVHs directly instead of a heightfield or flow fields,
+    // they are drawn at full detail without batches, and their CPU mesh data is released once baked
+    bool tiled = scenePath != NULL;
+    if (tiled) {
+        useHeightfield = false;
+        useFlowField = false;
+        useLod = false;
+        useBatching = false;
+        optimizeMeshes = false;
+        quantizeVertices = false;
+        keepMeshData = false;
+        collisionLod = 0;
     }
     
     // Initialize window
+    if (benchSettings.hidden) {
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    }
     InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "GLTF Viewer - Strategy Camera");
     
     // Initialize camera
@@ -923,21 +1256,124 @@ int main(int argc, char *argv[]) {
     isometric.angle = ISO_CAMERA_ANGLE;
     isometric.selecting = false;
     
-    // Load model
-    Model model = LoadModel(modelPath);
-    
-    // Check if model loaded successfully
-    if (model.meshCount == 0) {
-        printf("Failed to load model: %s\n", modelPath);
-        CloseWindow();
-        return 1;
+    // Benchmarks run uncapped, with a fixed simulation step instead of the frame time
+    bool benchmarking = benchSettings.enabled;
+    SetTargetFPS(benchmarking ? 0 : 60);
+    
+    // Worker threads decode compressed model buffers first, unit simulation uses them afterwards
+    InitJobSystem(&unitJobs, workerThreads);
+    
+    // KTX2 textures replace their PNG/JPEG fallback only in GPU formats this driver can sample
+    unsigned int textureFormats = useKtx2 ? GetSupportedTextureFormats() : 0;
+    
+    // A scene manifest streams its tiles from the main loop instead, the single model stays empty
+    TileScene tileScene = {0};
+    SceneCacheKey cacheKey = {0};
+    TextureStream textureStream = {0};
+    Model model = {0};
+    if (tiled) {
+        if (!LoadTileScene(&tileScene, scenePath, textureFormats, useSceneCache)) {
+            CloseJobSystem(&unitJobs);
+            UnloadInputReplay(&replay);
+            CloseWindow();
+            return 1;
+        }
+    } else {
+        // Read the model file on a background thread so the window keeps responding
+        ModelFileLoad fileLoad;
+        BeginModelFileLoad(&fileLoad, modelPath, &unitJobs, textureFormats);
+        while (!IsModelFileLoadDone(&fileLoad)) {
+            if (WindowShouldClose()) {
+                CancelModelFileLoad(&fileLoad);
+                CloseJobSystem(&unitJobs);
+                UnloadInputReplay(&replay);
+                CloseWindow();
+                return 0;
+            }
+            BeginDrawing();
+                DrawLoadingScreen(modelPath, "Reading file", GetModelFileLoadProgress(&fileLoad));
+            EndDrawing();
+        }
+        
+        // Parsing and GPU upload need the window thread, show one last frame while they run
+        BeginDrawing();
+            DrawLoadingScreen(modelPath, "Decoding meshes", 1.0f);
+        EndDrawing();
+        cacheKey = (SceneCacheKey){ fileLoad.hash, fileLoad.size, 0, MatrixIdentity(), useHeightfield, heightfieldCellSize, collisionLod };
+        model = FinishModelFileLoad(&fileLoad, &textureStream);
+        
+        // Check if model loaded successfully
+        if (model.meshCount == 0) {
+            printf("Failed to load model: %s\n", modelPath);
+            CloseJobSystem(&unitJobs);
+            UnloadInputReplay(&replay);
+            CloseWindow();
+            return 1;
+        }
     }
     
     // Ensure model transform is identity matrix for proper rendering
     model.transform = MatrixIdentity();
     
-    // Get model bounds and center camera target
-    BoundingBox bounds = GetModelBounds(model);
+    // Reorder triangles and vertices before batching and the collision build read the CPU data
+    if (optimizeMeshes) {
+        OptimizeModelMeshes(model);
+    }
+    
+    // Merge static meshes that share a material while their CPU data is still around
+    ModelBatches modelBatches = {0};
+    if (useBatching) {
+        modelBatches = LoadModelBatches(&model, quantizeVertices);
+    }
+    
+    // Meshes still drawn on their own get their reordered or quantized GPU copy
+    ModelQuantization meshQuantization = {0};
+    if (optimizeMeshes || quantizeVertices) {
+        meshQuantization = ReloadModelMeshes(&model, quantizeVertices);
+    }
+    
+    // A scene cache from an earlier run of the same file skips every collision preprocessing step
+    ModelCollision collision = {0};
+    bool collisionReady = false;
+    char *cachePath = (useSceneCache && !tiled) ? GetSceneCachePath(modelPath) : NULL;
+    cacheKey.meshCount = model.meshCount;
+    cacheKey.transform = model.transform;
+    
+    if (cachePath != NULL && LoadSceneCache(cachePath, cacheKey, &collision, &groundHeightfield)) {
+        printf("Loaded scene cache: %s\n", cachePath);
+        collisionReady = true;
+        if (useFlowField) RebuildNavigation();
+    } else {
+        // Mesh bounds are enough to frame the camera and cull meshes, so the model is shown right away
+        // while the ray acceleration structure and terrain heights build in the background
+        collision.transform = model.transform;
+        collision.info = LoadModelInfo(model);
+    }
+    
+    // Ray queries go through a top-level structure over the model's BVH, rebuilt whenever the collision is replaced
+    const ModelCollision *modelInstance = &collision;
+    CollisionScene collisionScene = LoadCollisionScene(&modelInstance, 1);
+    
+    // Tiled scenes answer the same queries from their own structure over the resident tiles
+    const CollisionScene *groundScene = tiled ? &tileScene.collision : &collisionScene;
+    
+    // LODs are not cached, they are simplified again in the background while the full meshes are drawn
+    // (tiles build their own collision as they load)
+    CollisionBuild collisionBuild = {0};
+    bool sceneBuildDone = tiled;
+    if (tiled) {
+        collisionReady = true;
+    } else {
+        BeginCollisionBuild(&collisionBuild, model, cacheKey, cachePath, !collisionReady, useLod || collisionLod > 0, optimizeMeshes);
+    }
+    bool texturesStreamed = (textureStream.textureCount == 0);
+    free(cachePath);
+    
+    // Scratch mesh list for re-baking collision from a LOD
+    Mesh *lodMeshes = (Mesh *)malloc(sizeof(Mesh) * model.meshCount);
+    
+    // Get model bounds (the start tile's footprint in tiled scenes) and center camera target
+    BoundingBox bounds = tiled ? GetTileSceneStartBounds(&tileScene) : GetModelBounds(&collision.info);
     Vector3 modelCenter = {
         (bounds.min.x + bounds.max.x) / 2.0f,
         (bounds.min.y + bounds.max.y) / 2.0f,
@@ -965,45 +1401,190 @@ int main(int argc, char *argv[]) {
     if (isometric.height < ISO_CAMERA_MIN_HEIGHT) isometric.height = ISO_CAMERA_MIN_HEIGHT;
     if (isometric.height > ISO_CAMERA_MAX_HEIGHT) isometric.height = ISO_CAMERA_MAX_HEIGHT;
     
-    // Model information
-    int totalTriangles = 0;
-    int totalVertices = 0;
-    for (int i = 0; i < model.meshCount; i++) {
-        totalTriangles += model.meshes[i].triangleCount;
-        totalVertices += model.meshes[i].vertexCount;
-    }
-    
-    // Initialize units array and command marker
-    for (int i = 0; i < MAX_UNITS; i++) {
-        units[i].active = false;
-    }
-    unitCount = 0;
+    // Initialize unit pool and command marker
+    unitPool = LoadUnitPool(UNIT_POOL_INITIAL_CAPACITY);
+    printf("Unit simulation: %d worker threads + main thread\n", unitJobs.threadCount);
     commandMarker.active = false;
+    unitGrid = LoadSpatialGrid(UNIT_SEPARATION_DISTANCE);
+    if (useInstancing) {
+        unitRenderer = LoadUnitRenderer();
+    }
+    unitLabels = LoadUnitLabels();
     
     // Display settings
     bool showInfo = true;
     bool showGrid = true;
     bool showAxes = true;
     bool showUnits = true;
+    bool showProfiler = false;
+    int meshesDrawn = 0;
+    int trianglesDrawn = 0;
+    int drawCalls = 0;
+    ModelCollision loadedCollision = {0};
+    Heightfield loadedHeightfield = {0};
+    ModelLod modelLod = {0};
+    
+    // Scripted run, seeded so every build sees the same spawns and wandering (replays reuse the recorded seed)
+    Benchmark bench = {0};
+    float benchDistance = orbit.distance;
+    bool scripted = benchmarking && !replaying;
+    if (benchmarking) {
+        bench = LoadBenchmark(benchSettings);
+        SetRandomSeed(replaying ? replay.seed : BENCH_RANDOM_SEED);
+        if (replaying) {
+            printf("Replay: %d frames of %s\n", replay.frameCount, replayPath);
+            if (replay.screenWidth != GetScreenWidth() || replay.screenHeight != GetScreenHeight()) {
+                printf("Replay was recorded in a %dx%d window, mouse positions may land elsewhere\n",
+                       replay.screenWidth, replay.screenHeight);
+            }
+        } else {
+            printf("Benchmark: %d units, %d frames after %d warm-up frames\n",
+                   benchSettings.units, bench.settings.frames, bench.settings.warmupFrames);
+        }
+    }
     
-    SetTargetFPS(60);
+    // Recorded runs choose their seed so the log reproduces every random spawn
+    InputRecorder recorder = {0};
+    if (recordPath != NULL && benchmarking) {
+        printf("Input recording is ignored in benchmark runs\n");
+    } else if (recordPath != NULL) {
+        unsigned int seed = (unsigned int)time(NULL);
+        SetRandomSeed(seed);
+        if (BeginInputRecording(&recorder, recordPath, seed, GetScreenWidth(), GetScreenHeight())) {
+            printf("Recording input to %s\n", recordPath);
+        }
+    }
+    
+    // Idle mode keeps the last frame in a render texture, shown again while nothing on screen changes
+    // (benchmarks always render)
+    RenderTexture2D frameCache = {0};
+    Camera3D cachedCamera = {0};
+    bool frameCached = false;
+    bool eventWaiting = false;
+    if (idleMode && !benchmarking) {
+        frameCache = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
+        idleMode = frameCache.id != 0;
+        if (!idleMode) printf("Failed to create the idle mode frame cache, rendering every frame\n");
+    } else {
+        idleMode = false;
+    }
     
     // Main loop
-    while (!WindowShouldClose()) {
-        float deltaTime = GetFrameTime();
+    while (!WindowShouldClose() && !(benchmarking && IsBenchmarkDone(&bench))) {
+        // All keyboard and mouse state of this frame, read from the log when replaying
+        FrameInput frameInput;
+        if (replaying) {
+            if (!ReadReplayFrameInput(&replay, &frameInput)) break;
+        } else {
+            frameInput = PollFrameInput();
+        }
+        float deltaTime = scripted ? BENCH_TIMESTEP : frameInput.frameTime;
+        BeginProfileFrame();
+        
+        // The first frame after sleeping on events would otherwise step over the whole wait
+        if (eventWaiting && deltaTime > IDLE_MAX_FRAME_TIME) {
+            deltaTime = IDLE_MAX_FRAME_TIME;
+        }
+        frameInput.frameTime = deltaTime;  // Logs keep the step the frame simulated
+        
+        // Queries are counted over the recorded frames only
+        if (benchmarking && bench.frame == bench.settings.warmupFrames) {
+            rayQueryCounts = (RayQueryCounts){0};
+        }
         
         // Update
         
+        // Collect the unit step that ran while the last frame was drawn, before anything touches units
+        BeginProfileZone(PROFILE_ZONE_UNIT_SYNC);
+        FinishUnitStep();
+        EndProfileZone(PROFILE_ZONE_UNIT_SYNC);
+        
+        // Switch to the full collision structures and LODs once the background build is done
+        // (benchmarks wait for it on the first frame so every run measures the same scene, replays on the frame
+        // the recorded run collected it, units only simulate the same way on the same collision)
+        BeginProfileZone(PROFILE_ZONE_SCENE);
+        bool sceneDue = !replaying || frameInput.sceneReady;
+        if (!sceneBuildDone && sceneDue && FinishCollisionBuild(&collisionBuild, benchmarking, &loadedCollision, &loadedHeightfield, &modelLod)) {
+            sceneBuildDone = true;
+            frameInput.sceneReady = true;
+            if (!collisionReady) {
+                UnloadModelCollision(&collision);
+                collision = loadedCollision;
+                groundHeightfield = loadedHeightfield;
+                collisionReady = true;
+                UnloadCollisionScene(&collisionScene);
+                collisionScene = LoadCollisionScene(&modelInstance, 1);
+                ResetUnitProbes(&unitPool);
+                
+                if (useHeightfield) {
+                    printf("Heightfield: %dx%d samples, cell %.2f, %d multi-layer\n",
+                           groundHeightfield.width, groundHeightfield.depth, groundHeightfield.cellSize,
+                           groundHeightfield.multiLayerSamples);
+                }
+                if (useFlowField) RebuildNavigation();
+            }
+            if (useLod) {
+                if (quantizeVertices) {
+                    UploadQuantizedModelLod(&meshQuantization, &modelLod);
+                } else {
+                    UploadModelLod(&modelLod);
+                }
+                if (useBatching) AddModelLodBatches(&modelBatches, model, &modelLod);
+            }
+            
+            // Rays only read the baked soup from here, GPU buffers hold everything drawing needs
+            if (!keepMeshData) {
+                size_t released = ReleaseModelMeshData(&model, &modelLod);
+                printf("Released %.1f MB of CPU mesh data\n", released / (1024.0 * 1024.0));
+            }
+        }
+        
+        // Re-bake collision triangles only if the model transform was changed (needs --keep-mesh-data)
+        if (sceneBuildDone && keepMeshData && lodMeshes != NULL &&
+            UpdateModelCollision(&collision, GetModelLodLevel(model, &modelLod, collisionLod, lodMeshes))) {
+            UnloadCollisionScene(&collisionScene);
+            collisionScene = LoadCollisionScene(&modelInstance, 1);
+            ResetUnitProbes(&unitPool);
+            if (useHeightfield) {
+                UnloadHeightfield(&groundHeightfield);
+                groundHeightfield = LoadHeightfield(&collision, heightfieldCellSize);
+                if (useFlowField) RebuildNavigation();
+            }
+        }
+        
+        // KTX2 textures show their small mips first and sharpen over the next frames (benchmarks upload them whole)
+        if (!texturesStreamed) {
+            texturesStreamed = UpdateTextureStream(&textureStream, &model, benchmarking ? 0 : TEXTURE_STREAM_FRAME_BYTES);
+            if (texturesStreamed) {
+                printf("Streamed %d KTX2 textures: %.1f MB on the GPU\n", textureStream.textureCount,
+                       textureStream.residentBytes / (1024.0 * 1024.0));
+            }
+        }
+        
+        // Tiles around the camera target load and evict in the background (benchmarks, recordings and replays
+        // finish each load within the frame, so a replay queries the same tiles on the same frames as its log)
+        if (tiled) {
+            Vector3 focus = (viewMode == VIEW_MODE_ORBIT) ? orbit.target : isometric.target;
+            if (UpdateTileScene(&tileScene, focus, benchmarking || recorder.file != NULL)) {
+                ResetUnitProbes(&unitPool);
+            }
+        }
+        EndProfileZone(PROFILE_ZONE_SCENE);
+        
         // Switch camera view mode with TAB
-        if (IsKeyPressed(KEY_TAB)) {
+        BeginProfileZone(PROFILE_ZONE_INPUT);
+        if (recorder.file != NULL) {
+            RecordFrameInput(&recorder, &frameInput);
+        }
+        if (IsInputKeyPressed(&frameInput, KEY_TAB)) {
             viewMode = (viewMode == VIEW_MODE_ORBIT) ? VIEW_MODE_ISOMETRIC : VIEW_MODE_ORBIT;
         }
         
         // Control group management
-        bool ctrlPressed = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+        bool ctrlPressed = IsInputKeyDown(&frameInput, KEY_LEFT_CONTROL) || IsInputKeyDown(&frameInput, KEY_RIGHT_CONTROL);
         
         for (int i = 1; i <= 9; i++) {
-            if (IsKeyPressed(KEY_ONE + i - 1)) {
+            if (IsInputKeyPressed(&frameInput, KEY_ONE + i - 1)) {
                 if (ctrlPressed) {
                     // Assign selected units to control group
                     AssignControlGroup(i);
@@ -1025,67 +1606,114 @@ int main(int argc, char *argv[]) {
                 }
             }
         }
+        EndProfileZone(PROFILE_ZONE_INPUT);
         
-        // Update camera based on view mode
-        if (viewMode == VIEW_MODE_ORBIT) {
-            UpdateOrbitCamera(&camera, &orbit);
-            
-            // Right click to command units in orbit mode too
-            if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
-                Vector3 targetPos = GetGroundPositionFromMouse(GetMousePosition(), camera, model);
-                CommandUnitsToPosition(targetPos, model);
-            }
+        // Update camera based on view mode, benchmarks follow a scripted orbit instead of the mouse
+        BeginProfileZone(PROFILE_ZONE_CAMERA);
+        if (scripted) {
+            UpdateBenchmarkCamera(&camera, &orbit, bench.frame, benchDistance);
+        } else if (viewMode == VIEW_MODE_ORBIT) {
+            UpdateOrbitCamera(&camera, &orbit, &frameInput);
         } else {
-            UpdateIsometricCamera(&camera, &isometric);
-            
-            // Handle right click command in isometric mode
-            if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
-                Vector3 targetPos = GetGroundPositionFromMouse(GetMousePosition(), camera, model);
-                CommandUnitsToPosition(targetPos, model);
+            UpdateIsometricCamera(&camera, &isometric, &frameInput, deltaTime);
+        }
+        
+        // View volume for culling, taken from the camera that is about to be drawn
+        Frustum viewFrustum = GetCameraFrustum(camera, (double)GetScreenWidth() / (double)GetScreenHeight());
+        EndProfileZone(PROFILE_ZONE_CAMERA);
+        
+        // Right click to command units, in both view modes
+        BeginProfileZone(PROFILE_ZONE_RAYS);
+        if (scripted) {
+            if (bench.frame % BENCH_COMMAND_INTERVAL == 0) {
+                CommandBenchmarkUnits(bench.frame, camera, groundScene);
             }
+        } else if (IsInputButtonPressed(&frameInput, MOUSE_BUTTON_RIGHT)) {
+            Vector3 targetPos = GetGroundPositionFromMouse(frameInput.mousePosition, camera, groundScene);
+            CommandUnitsToPosition(targetPos, groundScene);
         }
+        EndProfileZone(PROFILE_ZONE_RAYS);
         
-        // Spawn units with SPACE key
-        if (IsKeyPressed(KEY_SPACE)) {
+        // Spawn units with SPACE key (units need the ground, so wait for the collision build)
+        BeginProfileZone(PROFILE_ZONE_INPUT);
+        if (IsInputKeyPressed(&frameInput, KEY_SPACE) && collisionReady) {
             for (int i = 0; i < 5; i++) {
                 SpawnUnit(modelCenter, maxDimension * 2.0f);
             }
         }
+        if (scripted && bench.frame == 0) {
+            for (int i = 0; i < benchSettings.units; i++) {
+                SpawnUnit(modelCenter, maxDimension * 2.0f);
+            }
+        }
         
         // Clear all units with C key
-        if (IsKeyPressed(KEY_C)) {
-            unitCount = 0;
-            for (int i = 0; i < MAX_UNITS; i++) {
-                units[i].active = false;
-            }
+        if (IsInputKeyPressed(&frameInput, KEY_C)) {
+            ClearUnitPool(&unitPool);
         }
         
         // Delete selected units with DELETE key
-        if (IsKeyPressed(KEY_DELETE)) {
-            for (int i = 0; i < unitCount; i++) {
-                if (units[i].selected) {
-                    units[i].active = false;
+        if (IsInputKeyPressed(&frameInput, KEY_DELETE)) {
+            // Walk backwards so the unit moved into a freed index was already visited
+            for (int i = unitPool.count - 1; i >= 0; i--) {
+                if (IsUnitSelected(&unitPool, i)) {
+                    RemoveUnitAt(&unitPool, i);
                 }
             }
         }
         
-        // Update all active units
+        
+        // Toggle displays
+        if (IsInputKeyPressed(&frameInput, KEY_I)) showInfo = !showInfo;
+        if (IsInputKeyPressed(&frameInput, KEY_G)) showGrid = !showGrid;
+        if (IsInputKeyPressed(&frameInput, KEY_X)) showAxes = !showAxes;
+        if (IsInputKeyPressed(&frameInput, KEY_U)) showUnits = !showUnits;
+        if (IsInputKeyPressed(&frameInput, KEY_P)) showProfiler = !showProfiler;
+        if (IsInputKeyPressed(&frameInput, KEY_T)) ExportProfilerTrace(PROFILER_TRACE_FILE);
+        EndProfileZone(PROFILE_ZONE_INPUT);
+        
+        // Simulate all units on the job threads while this frame is drawn
+        BeginProfileZone(PROFILE_ZONE_UNIT_STEP);
         if (showUnits) {
-            for (int i = 0; i < unitCount; i++) {
-                if (units[i].active) {
-                    UpdateUnit(&units[i], model, deltaTime);
-                }
-            }
+            UpdateUnitClock(groundScene, deltaTime);
+            
+            // The grid was just rebuilt from the current positions, culling pads it by one tick
+            CullUnits(useCulling ? &viewFrustum : NULL);
         }
+        EndProfileZone(PROFILE_ZONE_UNIT_STEP);
         
-        // Toggle displays
-        if (IsKeyPressed(KEY_I)) showInfo = !showInfo;
-        if (IsKeyPressed(KEY_G)) showGrid = !showGrid;
-        if (IsKeyPressed(KEY_X)) showAxes = !showAxes;
-        if (IsKeyPressed(KEY_U)) showUnits = !showUnits;
+        // Idle mode: once units, loading work, the command marker and the camera have all settled, EndDrawing sleeps
+        // until the next input event, and frames without input present the cached image instead of rendering
+        if (idleMode) {
+            bool cameraMoved = memcmp(&camera, &cachedCamera, sizeof(Camera3D)) != 0;
+            bool quiescent = !(showUnits && unitPool.count > 0) && sceneBuildDone && texturesStreamed &&
+                             !(tiled && IsTileSceneBusy(&tileScene)) &&
+                             !commandMarker.active && !cameraMoved &&
+                             (viewMode == VIEW_MODE_ORBIT || IsIsometricCameraSettled(&isometric));
+            
+            if (quiescent != eventWaiting) {
+                if (quiescent) EnableEventWaiting();
+                else DisableEventWaiting();
+                eventWaiting = quiescent;
+            }
+            
+            if (frameCached && quiescent && !HasFrameInput(&frameInput)) {
+                BeginProfileZone(PROFILE_ZONE_PRESENT);
+                BeginDrawing();
+                    DrawFrameCache(frameCache);
+                EndDrawing();
+                EndProfileZone(PROFILE_ZONE_PRESENT);
+                EndProfileFrame();
+                continue;
+            }
+            cachedCamera = camera;
+            frameCached = true;
+        }
         
         // Draw
+        BeginProfileZone(PROFILE_ZONE_DRAW_3D);
         BeginDrawing();
+            if (idleMode) BeginTextureMode(frameCache);
             ClearBackground((Color){48, 48, 56, 255});
             
             BeginMode3D(camera);
@@ -1094,15 +1722,37 @@ int main(int argc, char *argv[]) {
                     DrawGrid(30, 1.0f);
                 }
                 
-                // Draw model
-                DrawModelEx(model, (Vector3){0, 0, 0}, (Vector3){0, 1, 0}, 0.0f, (Vector3){1, 1, 1}, WHITE);
+                // Draw the model meshes that touch the view frustum, each at the LOD its screen size allows;
+                // batched meshes are queued and drawn with their neighbours below
+                meshesDrawn = 0;
+                trianglesDrawn = 0;
+                drawCalls = 0;
+                for (int m = 0; m < model.meshCount; m++) {
+                    BoundingBox meshBounds = collision.info.meshes[m].bounds;
+                    if (useCulling && !IsBoxInFrustum(&viewFrustum, meshBounds)) continue;
+                    
+                    int level = modelLod.uploaded ? SelectMeshLod(&modelLod.meshes[m], meshBounds, camera, GetScreenHeight(), lodPixelError) : 0;
+                    meshesDrawn++;
+                    if (QueueBatchedMesh(&modelBatches, m, level)) continue;
+                    
+                    Mesh mesh = GetModelLodMesh(model, &modelLod, m, level);
+                    DrawMesh(mesh, model.materials[model.meshMaterial[m]], GetMeshDrawTransform(&meshQuantization, m, level, model.transform));
+                    trianglesDrawn += mesh.triangleCount;
+                    drawCalls++;
+                }
+                drawCalls += DrawModelBatches(&modelBatches, model, &trianglesDrawn);
+                if (tiled) {
+                    int tileMeshes = DrawTileScene(&tileScene, useCulling ? &viewFrustum : NULL, &trianglesDrawn);
+                    meshesDrawn += tileMeshes;
+                    drawCalls += tileMeshes;
+                }
                 
                 // Draw units
-                if (showUnits) {
-                    for (int i = 0; i < unitCount; i++) {
-                        if (units[i].active) {
-                            DrawUnit(&units[i], camera);
-                        }
+                if (showUnits && unitRenderer.ready) {
+                    DrawUnitsInstanced(&unitRenderer, &unitPool, visibleUnits.units, visibleUnits.count);
+                } else if (showUnits) {
+                    for (int k = 0; k < visibleUnits.count; k++) {
+                        DrawUnit(&unitPool, visibleUnits.units[k]);
                     }
                 }
                 
@@ -1117,6 +1767,14 @@ int main(int argc, char *argv[]) {
                 }
                 
             EndMode3D();
+            EndProfileZone(PROFILE_ZONE_DRAW_3D);
+            BeginProfileZone(PROFILE_ZONE_DRAW_UI);
+            
+            // Draw group numbers above units
+            if (showUnits) {
+                DrawUnitLabels(&unitLabels, &unitPool, visibleUnits.units, visibleUnits.count,
+                               camera, GetScreenWidth(), GetScreenHeight());
+            }
             
             // Draw selection box for isometric mode
             if (viewMode == VIEW_MODE_ISOMETRIC) {
@@ -1126,31 +1784,30 @@ int main(int argc, char *argv[]) {
             // Draw UI
             if (showInfo) {
                 // Camera mode and unit info
-                DrawRectangle(10, 10, 180, 145, Fade(BLACK, 0.7f));
+                DrawRectangle(10, 10, 180, 190, Fade(BLACK, 0.7f));
                 const char* modeText = (viewMode == VIEW_MODE_ORBIT) ? "ORBIT" : "ISOMETRIC";
                 DrawText(modeText, 15, 15, 12, GREEN);
-                DrawText("MODEL", 15, 35, 10, WHITE);
-                DrawText(TextFormat("Meshes: %d", model.meshCount), 15, 50, 10, GRAY);
-                DrawText(TextFormat("Triangles: %d", totalTriangles), 15, 65, 10, GRAY);
-                DrawText(TextFormat("Vertices: %d", totalVertices), 15, 80, 10, GRAY);
+                int sceneMeshes = tiled ? tileScene.meshCount : collision.info.meshCount;
+                if (tiled) {
+                    DrawText(TextFormat("SCENE %d/%d tiles, %.0f MB", tileScene.residentTiles, tileScene.tileCount,
+                                        tileScene.residentBytes / (1024.0 * 1024.0)), 15, 35, 10, WHITE);
+                } else {
+                    DrawText(collisionReady ? "MODEL" : "MODEL (building collision)", 15, 35, 10, WHITE);
+                }
+                DrawText(TextFormat("Meshes: %d", sceneMeshes), 15, 50, 10, GRAY);
+                DrawText(TextFormat("Triangles: %d", tiled ? tileScene.triangleCount : collision.info.totalTriangles), 15, 65, 10, GRAY);
+                DrawText(TextFormat("Vertices: %d", tiled ? tileScene.vertexCount : collision.info.totalVertices), 15, 80, 10, GRAY);
                 
                 // Unit counter
-                int activeUnits = 0;
-                int selectedUnits = 0;
-                for (int i = 0; i < unitCount; i++) {
-                    if (units[i].active) {
-                        activeUnits++;
-                        if (units[i].selected) selectedUnits++;
-                    }
-                }
-                DrawText(TextFormat("Units: %d/%d", activeUnits, MAX_UNITS), 15, 95, 10, YELLOW);
+                int selectedUnits = CountSelectedUnits(&unitPool);
+                DrawText(TextFormat("Units: %d", unitPool.count), 15, 95, 10, YELLOW);
                 DrawText(TextFormat("Selected: %d", selectedUnits), 15, 110, 10, GREEN);
                 
                 // Show active control groups
                 char groupsText[64] = "Groups: ";
                 bool hasGroups = false;
-                for (int g = 1; g <= 9; g++) {
-                    if (controlGroups[g].active && controlGroups[g].unitCount > 0) {
+                for (int g = 1; g < UNIT_GROUP_COUNT; g++) {
+                    if (unitPool.groupCount[g] > 0) {
                         char groupNum[4];
                         snprintf(groupNum, sizeof(groupNum), "%d ", g);
                         strcat(groupsText, groupNum);
@@ -1161,6 +1818,13 @@ int main(int argc, char *argv[]) {
                     DrawText(groupsText, 15, 125, 10, YELLOW);
                 }
                 
+                // Frustum culling results
+                int unitsDrawn = showUnits ? visibleUnits.count : 0;
+                DrawText(TextFormat("Drawn meshes: %d/%d", meshesDrawn, sceneMeshes), 15, 140, 10, GRAY);
+                DrawText(TextFormat("Drawn units: %d/%d", unitsDrawn, unitPool.count), 15, 155, 10, GRAY);
+                DrawText(TextFormat("Drawn triangles: %d", trianglesDrawn), 15, 170, 10, GRAY);
+                DrawText(TextFormat("Mesh draw calls: %d", drawCalls), 15, 185, 10, GRAY);
+                
                 if (viewMode == VIEW_MODE_ORBIT) {
                     DrawText(TextFormat("Dist: %.1f", orbit.distance), 15, 115, 10, GRAY);
                 } else {
@@ -1184,11 +1848,11 @@ int main(int argc, char *argv[]) {
             DrawText("[SPACE] Spawn Units  [C] Clear Units", 15, WINDOW_HEIGHT - 80, 10, YELLOW);
             DrawText("[DELETE] Delete Selected  [U] Toggle Units", 15, WINDOW_HEIGHT - 65, 10, YELLOW);
             DrawText("[TAB] Switch Mode  [R] Reset Camera", 15, WINDOW_HEIGHT - 50, 10, GRAY);
-            DrawText("[G] Grid  [X] Axes  [I] Info  [ESC] Exit", 15, WINDOW_HEIGHT - 35, 10, GRAY);
+            DrawText("[G] Grid  [X] Axes  [I] Info  [P] Profiler  [ESC] Exit", 15, WINDOW_HEIGHT - 35, 10, GRAY);
             
             // Edge scroll indicator for isometric mode
             if (viewMode == VIEW_MODE_ISOMETRIC) {
-                Vector2 mousePos = GetMousePosition();
+                Vector2 mousePos = frameInput.mousePosition;
                 if (mousePos.x < ISO_CAMERA_EDGE_SCROLL_ZONE ||
                     mousePos.x > WINDOW_WIDTH - ISO_CAMERA_EDGE_SCROLL_ZONE ||
                     mousePos.y < ISO_CAMERA_EDGE_SCROLL_ZONE ||
@@ -1200,12 +1864,82 @@ int main(int argc, char *argv[]) {
             // FPS
             DrawFPS(WINDOW_WIDTH - 80, 10);
             
+            // Frame timings below the FPS counter
+            if (showProfiler) {
+                DrawProfilerOverlay(WINDOW_WIDTH - PROFILER_OVERLAY_WIDTH - 10, 30);
+            }
+            EndProfileZone(PROFILE_ZONE_DRAW_UI);
+            
+            // Idle mode drew into the frame cache, which is what the window shows
+            if (idleMode) {
+                EndTextureMode();
+                DrawFrameCache(frameCache);
+            }
+            
+        BeginProfileZone(PROFILE_ZONE_PRESENT);
         EndDrawing();
+        EndProfileZone(PROFILE_ZONE_PRESENT);
+        EndProfileFrame();
+        
+        if (benchmarking) {
+            RecordBenchmarkFrame(&bench);
+        }
     }
     
+    // Benchmark results, the exit code tells scripts whether the report was written
+    int exitCode = 0;
+    if (benchmarking) {
+        BenchReport report = {0};
+        report.modelPath = tiled ? scenePath : modelPath;
+        report.unitCount = unitPool.count;
+        report.threadCount = unitJobs.threadCount;
+        report.meshCount = tiled ? tileScene.meshCount : collision.info.meshCount;
+        report.triangleCount = tiled ? tileScene.triangleCount : collision.info.totalTriangles;
+        report.avoidanceRays = rayQueryCounts.avoidance;
+        report.groundRays = rayQueryCounts.ground;
+        report.pickingRays = rayQueryCounts.picking;
+        
+        if (!IsBenchmarkDone(&bench)) {
+            printf("Benchmark interrupted after %d of %d frames\n", bench.recorded, bench.settings.frames);
+            exitCode = 1;
+        } else if (!SaveBenchmarkReport(&bench, &report)) {
+            exitCode = 1;
+        }
+        UnloadBenchmark(&bench);
+        
+        // Replays also keep the zone timeline of their last frames
+        if (replaying) ExportProfilerTrace(PROFILER_TRACE_FILE);
+    }
+    EndInputRecording(&recorder);
+    UnloadInputReplay(&replay);
+    
     // Cleanup
+    FinishUnitStep();
+    CloseJobSystem(&unitJobs);
+    UnloadUnitRenderer(&unitRenderer);
+    UnloadUnitLabels(&unitLabels);
+    free(visibleUnits.units);
+    UnloadUnitPool(&unitPool);
+    UnloadSpatialGrid(&unitGrid);
+    if (!sceneBuildDone) {
+        FinishCollisionBuild(&collisionBuild, true, &loadedCollision, &loadedHeightfield, &modelLod);
+        UnloadModelCollision(&loadedCollision);
+        UnloadHeightfield(&loadedHeightfield);
+    }
+    UnloadModelLod(&modelLod);
+    UnloadModelBatches(&modelBatches);
+    UnloadModelQuantization(&meshQuantization);
+    free(lodMeshes);
+    UnloadFlowFieldCache(&flowFields);
+    UnloadNavGrid(&navGrid);
+    UnloadHeightfield(&groundHeightfield);
+    UnloadTileScene(&tileScene);
+    UnloadCollisionScene(&collisionScene);
+    UnloadModelCollision(&collision);
+    UnloadTextureStream(&textureStream, &model);
+    if (idleMode) UnloadRenderTexture(frameCache);
     UnloadModel(model);
     CloseWindow();
     
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,399 @@
+#include "meshbatch.h"
+#include "meshopt.h"
+#include <rlgl.h>
+#include <raymath.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mesh that can be merged, sorted by material and then by position
+typedef struct {
+    int meshIndex;
+    int materialIndex;
+    unsigned int mortonCode;
+} BatchCandidate;
+
+// Function to check whether a mesh can live in a shared static buffer
+static bool IsMeshBatchable(Mesh mesh) {
+    return mesh.vertices != NULL && mesh.vertexCount > 0 && mesh.vertexCount <= MESH_BATCH_MAX_VERTICES &&
+           mesh.vaoId > 0 && mesh.boneIds == NULL && mesh.animVertices == NULL;
+}
+
+// Function to spread the low 10 bits of v so two zero bits follow each one
+static unsigned int SpreadBits10(unsigned int v) {
+    v &= 0x3FF;
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v << 8)) & 0x0300F00F;
+    v = (v | (v << 4)) & 0x030C30C3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+static int CompareBatchCandidates(const void *a, const void *b) {
+    const BatchCandidate *ca = (const BatchCandidate *)a;
+    const BatchCandidate *cb = (const BatchCandidate *)b;
+    if (ca->materialIndex != cb->materialIndex) return (ca->materialIndex > cb->materialIndex) - (ca->materialIndex < cb->materialIndex);
+    if (ca->mortonCode != cb->mortonCode) return (ca->mortonCode > cb->mortonCode) - (ca->mortonCode < cb->mortonCode);
+    return ca->meshIndex - cb->meshIndex;
+}
+
+// Function to get the box around a mesh's vertices
+static BoundingBox GetMeshVertexBounds(Mesh mesh) {
+    BoundingBox box = { { mesh.vertices[0], mesh.vertices[1], mesh.vertices[2] }, { mesh.vertices[0], mesh.vertices[1], mesh.vertices[2] } };
+    for (int v = 1; v < mesh.vertexCount; v++) {
+        Vector3 p = { mesh.vertices[v * 3], mesh.vertices[v * 3 + 1], mesh.vertices[v * 3 + 2] };
+        box.min = Vector3Min(box.min, p);
+        box.max = Vector3Max(box.max, p);
+    }
+    return box;
+}
+
+// Function to merge count candidates into one batch, returns false if memory ran out
+static bool BuildMeshBatch(MeshBatch *batch, Mesh *const *meshes, const BatchCandidate *candidates, int count, bool quantize) {
+    int vertexCount = 0;
+    int indexCount = 0;
+    bool hasNormals = false, hasTexcoords = false, hasTexcoords2 = false, hasTangents = false, hasColors = false;
+
+    for (int i = 0; i < count; i++) {
+        Mesh mesh = *meshes[candidates[i].meshIndex];
+        vertexCount += mesh.vertexCount;
+        indexCount += (mesh.indices != NULL) ? mesh.triangleCount * 3 : (mesh.vertexCount / 3) * 3;
+        hasNormals |= (mesh.normals != NULL);
+        hasTexcoords |= (mesh.texcoords != NULL);
+        hasTexcoords2 |= (mesh.texcoords2 != NULL);
+        hasTangents |= (mesh.tangents != NULL);
+        hasColors |= (mesh.colors != NULL);
+    }
+
+    // Attributes some members lack get the values raylib's default shader assumes
+    Mesh merged = {0};
+    merged.vertexCount = vertexCount;
+    merged.triangleCount = indexCount / 3;
+    merged.vertices = (float *)malloc(sizeof(float) * 3 * vertexCount);
+    merged.indices = (unsigned short *)malloc(sizeof(unsigned short) * indexCount);
+    if (hasNormals) merged.normals = (float *)malloc(sizeof(float) * 3 * vertexCount);
+    if (hasTexcoords) merged.texcoords = (float *)calloc(2 * vertexCount, sizeof(float));
+    if (hasTexcoords2) merged.texcoords2 = (float *)calloc(2 * vertexCount, sizeof(float));
+    if (hasTangents) merged.tangents = (float *)malloc(sizeof(float) * 4 * vertexCount);
+    if (hasColors) merged.colors = (unsigned char *)malloc(4 * vertexCount);
+    batch->ranges = (MeshBatchRange *)malloc(sizeof(MeshBatchRange) * count);
+
+    if (merged.vertices == NULL || merged.indices == NULL || batch->ranges == NULL ||
+        (hasNormals && merged.normals == NULL) || (hasTexcoords && merged.texcoords == NULL) ||
+        (hasTexcoords2 && merged.texcoords2 == NULL) || (hasTangents && merged.tangents == NULL) ||
+        (hasColors && merged.colors == NULL)) {
+        UnloadMesh(merged);
+        free(batch->ranges);
+        batch->ranges = NULL;
+        return false;
+    }
+
+    int baseVertex = 0;
+    int firstIndex = 0;
+    for (int i = 0; i < count; i++) {
+        int meshIndex = candidates[i].meshIndex;
+        Mesh mesh = *meshes[meshIndex];
+        int n = mesh.vertexCount;
+
+        memcpy(merged.vertices + baseVertex * 3, mesh.vertices, sizeof(float) * 3 * n);
+        for (int v = 0; hasNormals && v < n; v++) {
+            if (mesh.normals != NULL) memcpy(merged.normals + (baseVertex + v) * 3, mesh.normals + v * 3, sizeof(float) * 3);
+            else memcpy(merged.normals + (baseVertex + v) * 3, (float[3]){ 0.0f, 1.0f, 0.0f }, sizeof(float) * 3);
+        }
+        if (mesh.texcoords != NULL) memcpy(merged.texcoords + baseVertex * 2, mesh.texcoords, sizeof(float) * 2 * n);
+        if (mesh.texcoords2 != NULL) memcpy(merged.texcoords2 + baseVertex * 2, mesh.texcoords2, sizeof(float) * 2 * n);
+        for (int v = 0; hasTangents && v < n; v++) {
+            if (mesh.tangents != NULL) memcpy(merged.tangents + (baseVertex + v) * 4, mesh.tangents + v * 4, sizeof(float) * 4);
+            else memcpy(merged.tangents + (baseVertex + v) * 4, (float[4]){ 1.0f, 0.0f, 0.0f, 1.0f }, sizeof(float) * 4);
+        }
+        if (hasColors) {
+            if (mesh.colors != NULL) memcpy(merged.colors + baseVertex * 4, mesh.colors, 4 * n);
+            else memset(merged.colors + baseVertex * 4, 255, 4 * n);
+        }
+
+        // Unindexed meshes get 0, 1, 2, ... so every member draws with the same call
+        int meshIndices = (mesh.indices != NULL) ? mesh.triangleCount * 3 : (n / 3) * 3;
+        for (int k = 0; k < meshIndices; k++) {
+            int local = (mesh.indices != NULL) ? mesh.indices[k] : k;
+            merged.indices[firstIndex + k] = (unsigned short)(baseVertex + local);
+        }
+
+        batch->ranges[i] = (MeshBatchRange){ meshIndex, firstIndex, meshIndices };
+        baseVertex += n;
+        firstIndex += meshIndices;
+    }
+
+    batch->dequant = MatrixIdentity();
+    if (!quantize || !UploadQuantizedMesh(&merged, &batch->dequant)) UploadMesh(&merged, false);
+
+    // Only the GPU copy is drawn, keep the struct's counts and buffer ids
+    free(merged.vertices);
+    free(merged.normals);
+    free(merged.texcoords);
+    free(merged.texcoords2);
+    free(merged.tangents);
+    free(merged.colors);
+    free(merged.indices);
+    merged.vertices = merged.normals = merged.texcoords = merged.texcoords2 = merged.tangents = NULL;
+    merged.colors = NULL;
+    merged.indices = NULL;
+
+    batch->mesh = merged;
+    batch->materialIndex = candidates[0].materialIndex;
+    batch->rangeCount = count;
+    return true;
+}
+
+// Function to group one LOD of the model's static meshes by material into buffers of at most MESH_BATCH_MAX_VERTICES
+// meshes[m] is model mesh m at this LOD, NULL when the mesh has no such level; returns the meshes merged
+static int BuildLevelBatches(ModelBatches *batches, Mesh *const *meshes, const int *meshMaterial, int level) {
+    int meshCount = batches->meshCount;
+    BatchCandidate *candidates = (BatchCandidate *)malloc(sizeof(BatchCandidate) * meshCount);
+    Vector3 *centers = (Vector3 *)malloc(sizeof(Vector3) * meshCount);
+    batches->meshBatch[level] = (int *)malloc(sizeof(int) * meshCount);
+
+    if (candidates == NULL || centers == NULL || batches->meshBatch[level] == NULL) {
+        printf("Failed to allocate mesh batches for %d meshes\n", meshCount);
+        free(candidates);
+        free(centers);
+        free(batches->meshBatch[level]);
+        batches->meshBatch[level] = NULL;
+        return 0;
+    }
+
+    // Mesh centres, and the box around them that the Morton codes are quantized in
+    int candidateCount = 0;
+    BoundingBox extent = { { 0, 0, 0 }, { 0, 0, 0 } };
+    for (int m = 0; m < meshCount; m++) {
+        batches->meshBatch[level][m] = -1;
+        if (meshes[m] == NULL || !IsMeshBatchable(*meshes[m])) continue;
+
+        BoundingBox box = GetMeshVertexBounds(*meshes[m]);
+        Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+        if (candidateCount == 0) extent = (BoundingBox){ center, center };
+        extent.min = Vector3Min(extent.min, center);
+        extent.max = Vector3Max(extent.max, center);
+
+        centers[candidateCount] = center;
+        candidates[candidateCount].meshIndex = m;
+        candidates[candidateCount].materialIndex = meshMaterial[m];
+        candidateCount++;
+    }
+
+    // Sorting along a Morton curve keeps meshes that are culled together next to each other in the buffer
+    Vector3 size = Vector3Subtract(extent.max, extent.min);
+    for (int i = 0; i < candidateCount; i++) {
+        Vector3 offset = Vector3Subtract(centers[i], extent.min);
+        unsigned int x = (size.x > 0.0f) ? (unsigned int)(offset.x / size.x * 1023.0f) : 0;
+        unsigned int y = (size.y > 0.0f) ? (unsigned int)(offset.y / size.y * 1023.0f) : 0;
+        unsigned int z = (size.z > 0.0f) ? (unsigned int)(offset.z / size.z * 1023.0f) : 0;
+        candidates[i].mortonCode = SpreadBits10(x) | (SpreadBits10(y) << 1) | (SpreadBits10(z) << 2);
+    }
+    qsort(candidates, candidateCount, sizeof(BatchCandidate), CompareBatchCandidates);
+
+    int merged = 0;
+    for (int first = 0; first < candidateCount;) {
+        // Fill one batch with consecutive meshes of the same material
+        int count = 0;
+        int vertexCount = 0;
+        while (first + count < candidateCount && candidates[first + count].materialIndex == candidates[first].materialIndex &&
+               vertexCount + meshes[candidates[first + count].meshIndex]->vertexCount <= MESH_BATCH_MAX_VERTICES) {
+            vertexCount += meshes[candidates[first + count].meshIndex]->vertexCount;
+            count++;
+        }
+
+        if (count >= MESH_BATCH_MIN_MESHES && batches->batchCount == batches->batchCapacity) {
+            int capacity = (batches->batchCapacity > 0) ? batches->batchCapacity * 2 : 16;
+            MeshBatch *grown = (MeshBatch *)realloc(batches->batches, sizeof(MeshBatch) * capacity);
+            if (grown == NULL) break;
+            batches->batches = grown;
+            batches->batchCapacity = capacity;
+        }
+
+        MeshBatch *batch = &batches->batches[batches->batchCount];
+        if (count >= MESH_BATCH_MIN_MESHES && BuildMeshBatch(batch, meshes, candidates + first, count, batches->quantize)) {
+            batch->level = level;
+            for (int i = 0; i < count; i++) {
+                int meshIndex = candidates[first + i].meshIndex;
+                batches->meshBatch[level][meshIndex] = batches->batchCount;
+                UnloadMeshBuffers(meshes[meshIndex]);
+            }
+            merged += count;
+            batches->batchCount++;
+        }
+
+        first += count;
+    }
+
+    free(candidates);
+    free(centers);
+
+    batches->mergedMeshes += merged;
+    return merged;
+}
+
+// Function to merge the full-resolution meshes
+ModelBatches LoadModelBatches(Model *model, bool quantize) {
+    ModelBatches batches = {0};
+    batches.quantize = quantize;
+    if (model->meshCount == 0) return batches;
+
+    batches.meshCount = model->meshCount;
+    batches.queued = (unsigned char *)calloc(model->meshCount, sizeof(unsigned char));
+    Mesh **meshes = (Mesh **)malloc(sizeof(Mesh *) * model->meshCount);
+
+    if (batches.queued == NULL || meshes == NULL) {
+        printf("Failed to allocate mesh batches for %d meshes\n", model->meshCount);
+        free(meshes);
+        UnloadModelBatches(&batches);
+        return batches;
+    }
+
+    for (int m = 0; m < model->meshCount; m++) meshes[m] = &model->meshes[m];
+    int merged = BuildLevelBatches(&batches, meshes, model->meshMaterial, 0);
+    free(meshes);
+
+    printf("Mesh batches: %d meshes merged into %d batches, %d drawn on their own\n",
+           merged, batches.batchCount, model->meshCount - merged);
+
+    return batches;
+}
+
+// Function to merge every simplified level
+void AddModelLodBatches(ModelBatches *batches, Model model, ModelLod *lod) {
+    if (batches->queued == NULL || lod->meshes == NULL) return;
+
+    Mesh **meshes = (Mesh **)malloc(sizeof(Mesh *) * model.meshCount);
+    if (meshes == NULL) return;
+
+    int firstBatch = batches->batchCount;
+    int merged = 0;
+    for (int level = 1; level < MESH_LOD_MAX_LEVELS; level++) {
+        for (int m = 0; m < model.meshCount; m++) {
+            MeshLod *chain = &lod->meshes[m];
+            meshes[m] = (level < chain->levelCount) ? &chain->levels[level - 1] : NULL;
+        }
+        merged += BuildLevelBatches(batches, meshes, model.meshMaterial, level);
+    }
+    free(meshes);
+
+    printf("LOD batches: %d simplified meshes merged into %d batches\n", merged, batches->batchCount - firstBatch);
+}
+
+// Function to release batch buffers
+void UnloadModelBatches(ModelBatches *batches) {
+    for (int i = 0; i < batches->batchCount; i++) {
+        UnloadMesh(batches->batches[i].mesh);
+        free(batches->batches[i].ranges);
+    }
+    free(batches->batches);
+    for (int level = 0; level < MESH_LOD_MAX_LEVELS; level++) {
+        free(batches->meshBatch[level]);
+    }
+    free(batches->queued);
+    memset(batches, 0, sizeof(*batches));
+}
+
+// Function to mark a batched mesh for drawing
+bool QueueBatchedMesh(ModelBatches *batches, int meshIndex, int level) {
+    if (batches->meshBatch[level] == NULL || batches->meshBatch[level][meshIndex] < 0) return false;
+
+    batches->queued[meshIndex] = (unsigned char)(level + 1);
+    return true;
+}
+
+// Function to draw the queued ranges of one batch with the same shader setup as DrawMesh
+static int DrawMeshBatch(const MeshBatch *batch, Material material, Matrix transform, const unsigned char *queued, int *triangleCount) {
+    unsigned char mark = (unsigned char)(batch->level + 1);
+    int r = 0;
+    while (r < batch->rangeCount && queued[batch->ranges[r].meshIndex] != mark) r++;
+    if (r == batch->rangeCount) return 0;
+
+    rlEnableShader(material.shader.id);
+
+    if (material.shader.locs[SHADER_LOC_COLOR_DIFFUSE] != -1) {
+        Color color = material.maps[MATERIAL_MAP_DIFFUSE].color;
+        float values[4] = { color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+        rlSetUniform(material.shader.locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+    }
+    if (material.shader.locs[SHADER_LOC_COLOR_SPECULAR] != -1) {
+        Color color = material.maps[MATERIAL_MAP_SPECULAR].color;
+        float values[4] = { color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+        rlSetUniform(material.shader.locs[SHADER_LOC_COLOR_SPECULAR], values, SHADER_UNIFORM_VEC4, 1);
+    }
+
+    Matrix matView = rlGetMatrixModelview();
+    Matrix matProjection = rlGetMatrixProjection();
+    Matrix matModel = MatrixMultiply(MatrixMultiply(batch->dequant, transform), rlGetMatrixTransform());
+    Matrix matModelView = MatrixMultiply(matModel, matView);
+
+    if (material.shader.locs[SHADER_LOC_MATRIX_VIEW] != -1) rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_VIEW], matView);
+    if (material.shader.locs[SHADER_LOC_MATRIX_PROJECTION] != -1) rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+    if (material.shader.locs[SHADER_LOC_MATRIX_MODEL] != -1) rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_MODEL], matModel);
+    if (material.shader.locs[SHADER_LOC_MATRIX_NORMAL] != -1) rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(matModel)));
+    rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matModelView, matProjection));
+
+    for (int i = 0; i <= MATERIAL_MAP_BRDF; i++) {
+        if (material.maps[i].texture.id == 0) continue;
+        rlActiveTextureSlot(i);
+        if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP) {
+            rlEnableTextureCubemap(material.maps[i].texture.id);
+        } else {
+            rlEnableTexture(material.maps[i].texture.id);
+        }
+        rlSetUniform(material.shader.locs[SHADER_LOC_MAP_DIFFUSE + i], &i, SHADER_UNIFORM_INT, 1);
+    }
+
+    // Ranges are contiguous in the index buffer, so each run of queued neighbours is one call
+    int drawCalls = 0;
+    rlEnableVertexArray(batch->mesh.vaoId);
+    while (r < batch->rangeCount) {
+        if (queued[batch->ranges[r].meshIndex] != mark) {
+            r++;
+            continue;
+        }
+
+        int firstIndex = batch->ranges[r].firstIndex;
+        int indexCount = 0;
+        for (; r < batch->rangeCount && queued[batch->ranges[r].meshIndex] == mark; r++) {
+            indexCount += batch->ranges[r].indexCount;
+        }
+
+        rlDrawVertexArrayElements(firstIndex, indexCount, 0);
+        *triangleCount += indexCount / 3;
+        drawCalls++;
+    }
+
+    for (int i = 0; i <= MATERIAL_MAP_BRDF; i++) {
+        if (material.maps[i].texture.id == 0) continue;
+        rlActiveTextureSlot(i);
+        if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP) {
+            rlDisableTextureCubemap();
+        } else {
+            rlDisableTexture();
+        }
+    }
+
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableVertexBufferElement();
+    rlDisableShader();
+
+    rlSetMatrixModelview(matView);
+    rlSetMatrixProjection(matProjection);
+
+    return drawCalls;
+}
+
+// Function to draw and clear this frame's queue
+int DrawModelBatches(ModelBatches *batches, Model model, int *triangleCount) {
+    int drawCalls = 0;
+
+    for (int i = 0; i < batches->batchCount; i++) {
+        const MeshBatch *batch = &batches->batches[i];
+        drawCalls += DrawMeshBatch(batch, model.materials[batch->materialIndex], model.transform, batches->queued, triangleCount);
+    }
+    if (batches->queued != NULL) memset(batches->queued, 0, batches->meshCount);
+
+    return drawCalls;
+}
@@ -0,0 +1,59 @@
+#ifndef MESHBATCH_H
+#define MESHBATCH_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include "meshlod.h"
+
+// Mesh batching settings
+#define MESH_BATCH_MAX_VERTICES 65535      // Batches keep raylib's 16-bit indices
+#define MESH_BATCH_MIN_MESHES 2            // Materials with fewer mergeable meshes are drawn as they are
+
+// Index range of one source mesh inside a batch
+typedef struct {
+    int meshIndex;             // Source mesh in the model
+    int firstIndex;
+    int indexCount;
+} MeshBatchRange;
+
+// Static meshes of one material and LOD merged into one set of GPU buffers
+typedef struct {
+    Mesh mesh;                 // GPU buffers only, the CPU copy is freed after upload
+    int materialIndex;
+    int level;
+    Matrix dequant;            // Applied before the model transform, identity unless the buffers are quantized
+    MeshBatchRange *ranges;    // In buffer order, neighbours in space are neighbours here
+    int rangeCount;
+} MeshBatch;
+
+// Every batch of a model, and which mesh went where
+typedef struct {
+    MeshBatch *batches;
+    int batchCount;
+    int batchCapacity;
+    int *meshBatch[MESH_LOD_MAX_LEVELS];   // Batch of each model mesh per LOD, -1 when drawn on its own (NULL until merged)
+    unsigned char *queued;                 // LOD + 1 each model mesh is queued at this frame, 0 when not queued
+    int meshCount;
+    int mergedMeshes;                      // Over all LODs
+    bool quantize;                         // Batch buffers use the quantized vertex format of meshopt.h
+} ModelBatches;
+
+// Merge the full-resolution static meshes of each material and upload them, quantized when quantize is set
+// Requires the window thread and CPU mesh data; the source meshes' own GPU buffers are released,
+// their CPU data, and so picking and collision, is untouched
+ModelBatches LoadModelBatches(Model *model, bool quantize);
+
+// Merge the simplified levels the same way, once they are uploaded and before their CPU data is released
+void AddModelLodBatches(ModelBatches *batches, Model model, ModelLod *lod);
+
+// Release batch buffers
+void UnloadModelBatches(ModelBatches *batches);
+
+// Queue a mesh at a LOD for this frame's batched draw, returns false if it is not batched there and must be drawn alone
+bool QueueBatchedMesh(ModelBatches *batches, int meshIndex, int level);
+
+// Draw every queued mesh, one draw call per run of neighbouring queued ranges; clears the queue
+// Returns the number of draw calls, triangles drawn are added to triangleCount
+int DrawModelBatches(ModelBatches *batches, Model model, int *triangleCount);
+
+#endif // MESHBATCH_H
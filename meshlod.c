@@ -0,0 +1,530 @@
+#include "meshlod.h"
+#include <raymath.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <float.h>
+
+// Symmetric 4x4 plane error quadric: xx xy xz xw yy yz yw zz zw ww
+typedef struct {
+    double q[10];
+} Quadric;
+
+// Half-edge collapse moving vertex from onto vertex to
+typedef struct {
+    int from;
+    int to;
+    double cost;
+} Collapse;
+
+// Working state of one mesh while it is simplified level by level
+// Vertex numbers are source mesh indices, welded so equal vertices share the lowest index
+typedef struct {
+    const Mesh *mesh;
+    unsigned int *indices;     // Current triangles
+    int triangleCount;
+    Quadric *quadrics;
+    unsigned char *locked;     // Seam and border vertices never move
+    unsigned char *touched;    // Vertices whose triangles changed in the current pass
+    int *collapseTarget;
+    int *adjacencyOffsets;     // Triangles around each vertex, vertexCount + 1 offsets
+    int *adjacency;
+    Collapse *collapses;       // Best collapse per vertex
+    double error;              // Largest collapse cost accepted so far
+} Simplifier;
+
+// Function to hash a vertex position (bitwise, so only exact duplicates meet)
+static uint32_t HashPosition(const float *position) {
+    uint32_t bits[3];
+    memcpy(bits, position, sizeof(bits));
+    return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+}
+
+// Function to compare every attribute of two vertices
+static bool VerticesEqual(const Mesh *mesh, int a, int b) {
+    if (memcmp(&mesh->vertices[a * 3], &mesh->vertices[b * 3], sizeof(float) * 3) != 0) return false;
+    if (mesh->normals != NULL && memcmp(&mesh->normals[a * 3], &mesh->normals[b * 3], sizeof(float) * 3) != 0) return false;
+    if (mesh->texcoords != NULL && memcmp(&mesh->texcoords[a * 2], &mesh->texcoords[b * 2], sizeof(float) * 2) != 0) return false;
+    if (mesh->texcoords2 != NULL && memcmp(&mesh->texcoords2[a * 2], &mesh->texcoords2[b * 2], sizeof(float) * 2) != 0) return false;
+    if (mesh->tangents != NULL && memcmp(&mesh->tangents[a * 4], &mesh->tangents[b * 4], sizeof(float) * 4) != 0) return false;
+    if (mesh->colors != NULL && memcmp(&mesh->colors[a * 4], &mesh->colors[b * 4], 4) != 0) return false;
+    return true;
+}
+
+// Function to map every vertex to the first vertex equal to it (all attributes, or the position only)
+static int *BuildVertexRemap(const Mesh *mesh, bool positionOnly) {
+    int count = mesh->vertexCount;
+    int tableSize = 1;
+    while (tableSize < count * 2) tableSize <<= 1;
+
+    int *remap = (int *)malloc(sizeof(int) * count);
+    int *table = (int *)malloc(sizeof(int) * tableSize);
+    if (remap == NULL || table == NULL) {
+        free(remap);
+        free(table);
+        return NULL;
+    }
+    memset(table, 0xff, sizeof(int) * tableSize);
+
+    for (int i = 0; i < count; i++) {
+        uint32_t slot = HashPosition(&mesh->vertices[i * 3]) & (uint32_t)(tableSize - 1);
+        remap[i] = i;
+
+        while (table[slot] >= 0) {
+            int j = table[slot];
+            bool equal = positionOnly ? memcmp(&mesh->vertices[i * 3], &mesh->vertices[j * 3], sizeof(float) * 3) == 0
+                                      : VerticesEqual(mesh, i, j);
+            if (equal) {
+                remap[i] = j;
+                break;
+            }
+            slot = (slot + 1) & (uint32_t)(tableSize - 1);
+        }
+        if (remap[i] == i) table[slot] = i;
+    }
+
+    free(table);
+    return remap;
+}
+
+static Vector3 GetVertexPosition(const Mesh *mesh, int v) {
+    return (Vector3){ mesh->vertices[v * 3], mesh->vertices[v * 3 + 1], mesh->vertices[v * 3 + 2] };
+}
+
+static void AddQuadric(Quadric *a, const Quadric *b) {
+    for (int i = 0; i < 10; i++) a->q[i] += b->q[i];
+}
+
+// Function to get the summed squared distance of a point to the planes of a quadric
+static double EvaluateQuadric(const Quadric *quadric, Vector3 p) {
+    const double *q = quadric->q;
+    double x = p.x, y = p.y, z = p.z;
+    return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x +
+           q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y +
+           q[7] * z * z + 2.0 * q[8] * z + q[9];
+}
+
+// Function to list the triangles around every vertex
+static void BuildAdjacency(Simplifier *s) {
+    int vertexCount = s->mesh->vertexCount;
+    int *cursor = s->collapseTarget;  // Scratch, the pass resets it right after
+    memset(s->adjacencyOffsets, 0, sizeof(int) * (vertexCount + 1));
+
+    for (int i = 0; i < s->triangleCount * 3; i++) s->adjacencyOffsets[s->indices[i] + 1]++;
+    for (int v = 0; v < vertexCount; v++) s->adjacencyOffsets[v + 1] += s->adjacencyOffsets[v];
+
+    memcpy(cursor, s->adjacencyOffsets, sizeof(int) * vertexCount);
+    for (int i = 0; i < s->triangleCount * 3; i++) s->adjacency[cursor[s->indices[i]]++] = i / 3;
+}
+
+// Function to check whether moving from onto to turns any remaining triangle over
+static bool CollapseFlipsTriangle(const Simplifier *s, int from, int to) {
+    Vector3 target = GetVertexPosition(s->mesh, to);
+
+    for (int k = s->adjacencyOffsets[from]; k < s->adjacencyOffsets[from + 1]; k++) {
+        const unsigned int *tri = &s->indices[s->adjacency[k] * 3];
+        if ((int)tri[0] == to || (int)tri[1] == to || (int)tri[2] == to) continue;  // Collapses away
+
+        Vector3 p[3], moved[3];
+        for (int i = 0; i < 3; i++) {
+            p[i] = GetVertexPosition(s->mesh, (int)tri[i]);
+            moved[i] = ((int)tri[i] == from) ? target : p[i];
+        }
+
+        Vector3 before = Vector3CrossProduct(Vector3Subtract(p[1], p[0]), Vector3Subtract(p[2], p[0]));
+        Vector3 after = Vector3CrossProduct(Vector3Subtract(moved[1], moved[0]), Vector3Subtract(moved[2], moved[0]));
+        if (Vector3DotProduct(before, after) <= MESH_LOD_MIN_NORMAL_DOT * Vector3Length(before) * Vector3Length(after)) return true;
+    }
+
+    return false;
+}
+
+static int CompareCollapses(const void *a, const void *b) {
+    double ca = ((const Collapse *)a)->cost;
+    double cb = ((const Collapse *)b)->cost;
+    return (ca > cb) - (ca < cb);
+}
+
+// Function to run one pass of independent collapses, cheapest first, returns the number done
+static int RunCollapsePass(Simplifier *s, int targetTriangles, double maxCost) {
+    int vertexCount = s->mesh->vertexCount;
+    BuildAdjacency(s);
+
+    // Cheapest collapse of every free vertex, indexed by vertex until compacted below
+    for (int v = 0; v < vertexCount; v++) s->collapses[v] = (Collapse){ v, -1, DBL_MAX };
+
+    for (int t = 0; t < s->triangleCount; t++) {
+        for (int e = 0; e < 3; e++) {
+            int a = (int)s->indices[t * 3 + e];
+            int b = (int)s->indices[t * 3 + (e + 1) % 3];
+
+            for (int dir = 0; dir < 2; dir++) {
+                int from = dir ? b : a;
+                int to = dir ? a : b;
+                if (s->locked[from]) continue;
+
+                Quadric sum = s->quadrics[from];
+                AddQuadric(&sum, &s->quadrics[to]);
+                double cost = EvaluateQuadric(&sum, GetVertexPosition(s->mesh, to));
+                if (cost < s->collapses[from].cost) {
+                    s->collapses[from].to = to;
+                    s->collapses[from].cost = cost;
+                }
+            }
+        }
+    }
+
+    int candidateCount = 0;
+    for (int v = 0; v < vertexCount; v++) {
+        if (s->collapses[v].to >= 0 && s->collapses[v].cost <= maxCost) s->collapses[candidateCount++] = s->collapses[v];
+    }
+    qsort(s->collapses, candidateCount, sizeof(Collapse), CompareCollapses);
+
+    for (int v = 0; v < vertexCount; v++) {
+        s->touched[v] = 0;
+        s->collapseTarget[v] = v;
+    }
+
+    int removed = 0;
+    int collapsed = 0;
+    for (int c = 0; c < candidateCount && removed < s->triangleCount - targetTriangles; c++) {
+        Collapse collapse = s->collapses[c];
+        if (s->touched[collapse.from] || s->touched[collapse.to]) continue;
+        if (CollapseFlipsTriangle(s, collapse.from, collapse.to)) continue;
+
+        // Lock the whole one-ring, its triangles change shape and later flip checks would be stale
+        for (int k = s->adjacencyOffsets[collapse.from]; k < s->adjacencyOffsets[collapse.from + 1]; k++) {
+            const unsigned int *tri = &s->indices[s->adjacency[k] * 3];
+            if ((int)tri[0] == collapse.to || (int)tri[1] == collapse.to || (int)tri[2] == collapse.to) removed++;
+            s->touched[tri[0]] = s->touched[tri[1]] = s->touched[tri[2]] = 1;
+        }
+        s->touched[collapse.to] = 1;
+
+        s->collapseTarget[collapse.from] = collapse.to;
+        AddQuadric(&s->quadrics[collapse.to], &s->quadrics[collapse.from]);
+        if (collapse.cost > s->error) s->error = collapse.cost;
+        collapsed++;
+    }
+    if (collapsed == 0) return 0;
+
+    // Targets never move in the same pass, so one lookup resolves every vertex
+    int kept = 0;
+    for (int t = 0; t < s->triangleCount; t++) {
+        unsigned int a = (unsigned int)s->collapseTarget[s->indices[t * 3]];
+        unsigned int b = (unsigned int)s->collapseTarget[s->indices[t * 3 + 1]];
+        unsigned int c = (unsigned int)s->collapseTarget[s->indices[t * 3 + 2]];
+        if (a == b || b == c || a == c) continue;
+
+        s->indices[kept * 3] = a;
+        s->indices[kept * 3 + 1] = b;
+        s->indices[kept * 3 + 2] = c;
+        kept++;
+    }
+    s->triangleCount = kept;
+
+    return collapsed;
+}
+
+static int CompareEdgeKeys(const void *a, const void *b) {
+    uint64_t ka = *(const uint64_t *)a;
+    uint64_t kb = *(const uint64_t *)b;
+    return (ka > kb) - (ka < kb);
+}
+
+// Function to lock vertices on UV/normal seams and on open or non-manifold edges
+static bool LockSeamsAndBorders(Simplifier *s, const int *remap, const int *positionRemap) {
+    int vertexCount = s->mesh->vertexCount;
+    int edgeCount = s->triangleCount * 3;
+    int *groupVertices = (int *)calloc(vertexCount, sizeof(int));
+    unsigned char *groupLocked = (unsigned char *)calloc(vertexCount, 1);
+    uint64_t *edges = (uint64_t *)malloc(sizeof(uint64_t) * (edgeCount + 1));
+
+    if (groupVertices == NULL || groupLocked == NULL || edges == NULL) {
+        free(groupVertices);
+        free(groupLocked);
+        free(edges);
+        return false;
+    }
+
+    // A position shared by several distinct vertices is a seam, moving one side would tear it open
+    for (int v = 0; v < vertexCount; v++) {
+        if (remap[v] == v) groupVertices[positionRemap[v]]++;
+    }
+    for (int v = 0; v < vertexCount; v++) {
+        if (groupVertices[positionRemap[v]] > 1) groupLocked[positionRemap[v]] = 1;
+    }
+
+    // Edges are compared by position so seams do not look like borders
+    for (int t = 0; t < s->triangleCount; t++) {
+        for (int e = 0; e < 3; e++) {
+            uint64_t a = (uint64_t)positionRemap[s->indices[t * 3 + e]];
+            uint64_t b = (uint64_t)positionRemap[s->indices[t * 3 + (e + 1) % 3]];
+            edges[t * 3 + e] = (a < b) ? (a << 32 | b) : (b << 32 | a);
+        }
+    }
+    qsort(edges, edgeCount, sizeof(uint64_t), CompareEdgeKeys);
+
+    for (int i = 0; i < edgeCount;) {
+        int run = 1;
+        while (i + run < edgeCount && edges[i + run] == edges[i]) run++;
+        if (run != 2) {
+            groupLocked[edges[i] >> 32] = 1;
+            groupLocked[edges[i] & 0xffffffffu] = 1;
+        }
+        i += run;
+    }
+
+    for (int v = 0; v < vertexCount; v++) s->locked[v] = groupLocked[positionRemap[v]];
+
+    free(groupVertices);
+    free(groupLocked);
+    free(edges);
+    return true;
+}
+
+// Function to copy the vertices still in use into a standalone mesh
+static bool BuildLevelMesh(const Simplifier *s, Mesh *level) {
+    const Mesh *mesh = s->mesh;
+    int *newIndex = (int *)malloc(sizeof(int) * mesh->vertexCount);
+    if (newIndex == NULL) return false;
+    memset(newIndex, 0xff, sizeof(int) * mesh->vertexCount);
+
+    int used = 0;
+    for (int i = 0; i < s->triangleCount * 3; i++) {
+        if (newIndex[s->indices[i]] < 0) newIndex[s->indices[i]] = used++;
+    }
+
+    // raylib meshes use 16-bit indices
+    if (used > 65535) {
+        free(newIndex);
+        return false;
+    }
+
+    memset(level, 0, sizeof(*level));
+    level->vertexCount = used;
+    level->triangleCount = s->triangleCount;
+    level->vertices = (float *)malloc(sizeof(float) * 3 * used);
+    level->indices = (unsigned short *)malloc(sizeof(unsigned short) * 3 * s->triangleCount);
+    if (mesh->normals != NULL) level->normals = (float *)malloc(sizeof(float) * 3 * used);
+    if (mesh->texcoords != NULL) level->texcoords = (float *)malloc(sizeof(float) * 2 * used);
+    if (mesh->texcoords2 != NULL) level->texcoords2 = (float *)malloc(sizeof(float) * 2 * used);
+    if (mesh->tangents != NULL) level->tangents = (float *)malloc(sizeof(float) * 4 * used);
+    if (mesh->colors != NULL) level->colors = (unsigned char *)malloc(4 * used);
+
+    bool ok = level->vertices != NULL && level->indices != NULL &&
+              (mesh->normals == NULL || level->normals != NULL) &&
+              (mesh->texcoords == NULL || level->texcoords != NULL) &&
+              (mesh->texcoords2 == NULL || level->texcoords2 != NULL) &&
+              (mesh->tangents == NULL || level->tangents != NULL) &&
+              (mesh->colors == NULL || level->colors != NULL);
+
+    if (ok) {
+        for (int v = 0; v < mesh->vertexCount; v++) {
+            int n = newIndex[v];
+            if (n < 0) continue;
+
+            memcpy(&level->vertices[n * 3], &mesh->vertices[v * 3], sizeof(float) * 3);
+            if (level->normals != NULL) memcpy(&level->normals[n * 3], &mesh->normals[v * 3], sizeof(float) * 3);
+            if (level->texcoords != NULL) memcpy(&level->texcoords[n * 2], &mesh->texcoords[v * 2], sizeof(float) * 2);
+            if (level->texcoords2 != NULL) memcpy(&level->texcoords2[n * 2], &mesh->texcoords2[v * 2], sizeof(float) * 2);
+            if (level->tangents != NULL) memcpy(&level->tangents[n * 4], &mesh->tangents[v * 4], sizeof(float) * 4);
+            if (level->colors != NULL) memcpy(&level->colors[n * 4], &mesh->colors[v * 4], 4);
+        }
+        for (int i = 0; i < s->triangleCount * 3; i++) {
+            level->indices[i] = (unsigned short)newIndex[s->indices[i]];
+        }
+    } else {
+        UnloadMesh(*level);
+        memset(level, 0, sizeof(*level));
+    }
+
+    free(newIndex);
+    return ok;
+}
+
+// Function to generate the simplified levels of one mesh, errors are scaled to world units
+static void GenerateMeshLod(const Mesh *mesh, float worldScale, MeshLod *lod) {
+    memset(lod, 0, sizeof(*lod));
+    lod->levelCount = 1;
+
+    // Skinned meshes move their vertices every frame, the simplified copies would not follow
+    if (mesh->vertices == NULL || mesh->boneIds != NULL || mesh->animVertices != NULL) return;
+    if (mesh->triangleCount <= MESH_LOD_MIN_TRIANGLES) return;
+
+    int vertexCount = mesh->vertexCount;
+    Simplifier s = {0};
+    s.mesh = mesh;
+    s.indices = (unsigned int *)malloc(sizeof(unsigned int) * 3 * mesh->triangleCount);
+    s.quadrics = (Quadric *)calloc(vertexCount, sizeof(Quadric));
+    s.locked = (unsigned char *)calloc(vertexCount, 1);
+    s.touched = (unsigned char *)calloc(vertexCount, 1);
+    s.collapseTarget = (int *)malloc(sizeof(int) * vertexCount);
+    s.adjacencyOffsets = (int *)malloc(sizeof(int) * (vertexCount + 1));
+    s.adjacency = (int *)malloc(sizeof(int) * 3 * mesh->triangleCount);
+    s.collapses = (Collapse *)malloc(sizeof(Collapse) * vertexCount);
+    int *remap = BuildVertexRemap(mesh, false);
+    int *positionRemap = BuildVertexRemap(mesh, true);
+
+    bool ok = s.indices != NULL && s.quadrics != NULL && s.locked != NULL && s.touched != NULL &&
+              s.collapseTarget != NULL && s.adjacencyOffsets != NULL && s.adjacency != NULL &&
+              s.collapses != NULL && remap != NULL && positionRemap != NULL;
+
+    if (ok) {
+        // Welded triangles, each vertex contributing the planes of the faces around it
+        for (int t = 0; t < mesh->triangleCount; t++) {
+            unsigned int tri[3];
+            bool valid = true;
+            for (int i = 0; i < 3; i++) {
+                int source = (mesh->indices != NULL) ? mesh->indices[t * 3 + i] : t * 3 + i;
+                if (source >= vertexCount) valid = false;
+                tri[i] = valid ? (unsigned int)remap[source] : 0;
+            }
+            if (!valid) continue;
+
+            // Zero-area triangles (two corners at one position, as at sphere poles) only get in the way
+            int g0 = positionRemap[tri[0]], g1 = positionRemap[tri[1]], g2 = positionRemap[tri[2]];
+            if (g0 == g1 || g1 == g2 || g0 == g2) continue;
+
+            Vector3 p0 = GetVertexPosition(mesh, (int)tri[0]);
+            Vector3 normal = Vector3CrossProduct(Vector3Subtract(GetVertexPosition(mesh, (int)tri[1]), p0),
+                                                 Vector3Subtract(GetVertexPosition(mesh, (int)tri[2]), p0));
+            float length = Vector3Length(normal);
+            if (length > 0.0f) {
+                double a = normal.x / length, b = normal.y / length, c = normal.z / length;
+                double d = -(a * p0.x + b * p0.y + c * p0.z);
+                Quadric plane = {{ a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d }};
+                for (int i = 0; i < 3; i++) AddQuadric(&s.quadrics[tri[i]], &plane);
+            }
+
+            memcpy(&s.indices[s.triangleCount * 3], tri, sizeof(tri));
+            s.triangleCount++;
+        }
+
+        ok = LockSeamsAndBorders(&s, remap, positionRemap);
+    }
+
+    if (ok) {
+        BoundingBox bounds = GetMeshBoundingBox(*mesh);
+        double maxError = MESH_LOD_MAX_ERROR * Vector3Distance(bounds.min, bounds.max);
+        int previous = s.triangleCount;
+
+        for (int level = 1; level < MESH_LOD_MAX_LEVELS && previous > MESH_LOD_MIN_TRIANGLES; level++) {
+            int target = (int)(previous * MESH_LOD_REDUCTION);
+            if (target < MESH_LOD_MIN_TRIANGLES) target = MESH_LOD_MIN_TRIANGLES;
+
+            for (int pass = 0; pass < MESH_LOD_MAX_PASSES && s.triangleCount > target; pass++) {
+                if (RunCollapsePass(&s, target, maxError * maxError) == 0) break;
+            }
+
+            // Stop once the error limit leaves too little to gain
+            if (s.triangleCount > previous * MESH_LOD_MIN_REDUCTION) break;
+            if (!BuildLevelMesh(&s, &lod->levels[level - 1])) break;
+
+            lod->errors[level] = (float)sqrt(s.error) * worldScale;
+            lod->levelCount++;
+            previous = s.triangleCount;
+        }
+    }
+
+    free(s.indices);
+    free(s.quadrics);
+    free(s.locked);
+    free(s.touched);
+    free(s.collapseTarget);
+    free(s.adjacencyOffsets);
+    free(s.adjacency);
+    free(s.collapses);
+    free(remap);
+    free(positionRemap);
+}
+
+// Function to simplify every mesh of a model
+ModelLod GenerateModelLod(Model model) {
+    ModelLod lod = {0};
+    lod.meshes = (MeshLod *)calloc(model.meshCount, sizeof(MeshLod));
+    if (lod.meshes == NULL) {
+        printf("Failed to allocate LOD chains for %d meshes\n", model.meshCount);
+        return lod;
+    }
+    lod.meshCount = model.meshCount;
+
+    // Errors are measured in mesh space, the largest axis scale turns them into world units
+    Matrix m = model.transform;
+    float scale = fmaxf(Vector3Length((Vector3){ m.m0, m.m1, m.m2 }),
+                  fmaxf(Vector3Length((Vector3){ m.m4, m.m5, m.m6 }), Vector3Length((Vector3){ m.m8, m.m9, m.m10 })));
+
+    int simplified = 0;
+    int levels = 0;
+    for (int i = 0; i < model.meshCount; i++) {
+        GenerateMeshLod(&model.meshes[i], scale, &lod.meshes[i]);
+        if (lod.meshes[i].levelCount > 1) simplified++;
+        levels += lod.meshes[i].levelCount - 1;
+    }
+    printf("LOD: %d of %d meshes simplified, %d levels\n", simplified, model.meshCount, levels);
+
+    return lod;
+}
+
+// Function to upload the simplified levels
+void UploadModelLod(ModelLod *lod) {
+    for (int i = 0; i < lod->meshCount; i++) {
+        for (int level = 1; level < lod->meshes[i].levelCount; level++) {
+            UploadMesh(&lod->meshes[i].levels[level - 1], false);
+        }
+    }
+    lod->uploaded = true;
+}
+
+// Function to release the simplified meshes (CPU and GPU)
+void UnloadModelLod(ModelLod *lod) {
+    for (int i = 0; i < lod->meshCount; i++) {
+        for (int level = 1; level < lod->meshes[i].levelCount; level++) {
+            UnloadMesh(lod->meshes[i].levels[level - 1]);
+        }
+    }
+    free(lod->meshes);
+    memset(lod, 0, sizeof(*lod));
+}
+
+// Function to pick the mesh of one LOD
+Mesh GetModelLodMesh(Model model, const ModelLod *lod, int meshIndex, int level) {
+    if (lod == NULL || lod->meshes == NULL || level <= 0) return model.meshes[meshIndex];
+
+    const MeshLod *chain = &lod->meshes[meshIndex];
+    if (level >= chain->levelCount) level = chain->levelCount - 1;
+
+    return (level == 0) ? model.meshes[meshIndex] : chain->levels[level - 1];
+}
+
+// Function to build a model view whose meshes are all at one LOD
+Model GetModelLodLevel(Model model, const ModelLod *lod, int level, Mesh *meshes) {
+    for (int i = 0; i < model.meshCount; i++) meshes[i] = GetModelLodMesh(model, lod, i, level);
+
+    Model view = model;
+    view.meshes = meshes;
+    return view;
+}
+
+// Function to choose a LOD from the projected error
+int SelectMeshLod(const MeshLod *lod, BoundingBox bounds, Camera3D camera, int screenHeight, float pixelError) {
+    if (lod->levelCount <= 1) return 0;
+
+    // Pixels covered by one world unit at the nearest point of the mesh
+    float pixelsPerUnit;
+    if (camera.projection == CAMERA_ORTHOGRAPHIC) {
+        pixelsPerUnit = screenHeight / camera.fovy;
+    } else {
+        Vector3 nearest = Vector3Clamp(camera.position, bounds.min, bounds.max);
+        float distance = Vector3Distance(nearest, camera.position);
+        if (distance <= 0.0f) return 0;
+        pixelsPerUnit = screenHeight / (2.0f * tanf(camera.fovy * DEG2RAD * 0.5f) * distance);
+    }
+
+    for (int level = lod->levelCount - 1; level > 0; level--) {
+        if (lod->errors[level] * pixelsPerUnit <= pixelError) return level;
+    }
+
+    return 0;
+}
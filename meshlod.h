@@ -0,0 +1,51 @@
+#ifndef MESHLOD_H
+#define MESHLOD_H
+
+#include <raylib.h>
+#include <stdbool.h>
+
+// LOD generation settings
+#define MESH_LOD_MAX_LEVELS 4              // Including the full-resolution mesh
+#define MESH_LOD_REDUCTION 0.5f            // Target triangle ratio of each level to the previous one
+#define MESH_LOD_MIN_REDUCTION 0.8f        // A level that keeps more of the previous triangles is dropped
+#define MESH_LOD_MIN_TRIANGLES 32          // Meshes (and levels) this small are not simplified further
+#define MESH_LOD_MAX_ERROR 0.01f           // Largest collapse error, relative to the mesh extent
+#define MESH_LOD_MAX_PASSES 32             // Collapse passes per level before giving up
+#define MESH_LOD_MIN_NORMAL_DOT 0.5f       // A collapse may turn a face by at most 60 degrees
+
+// LOD selection settings
+#define MESH_LOD_DEFAULT_PIXEL_ERROR 1.0f  // Largest simplification error allowed on screen, in pixels
+
+// Simplified versions of one mesh, all sharing its material
+typedef struct {
+    Mesh levels[MESH_LOD_MAX_LEVELS - 1];  // levels[i] is LOD i + 1, LOD 0 is the source mesh
+    float errors[MESH_LOD_MAX_LEVELS];     // World-space geometric error of each LOD, errors[0] is 0
+    int levelCount;                        // LODs available, including the source mesh
+} MeshLod;
+
+// LOD chains of every mesh of a model
+typedef struct {
+    MeshLod *meshes;           // One per model mesh, NULL when no LODs were generated
+    int meshCount;
+    bool uploaded;             // Simplified levels have GPU buffers and can be drawn
+} ModelLod;
+
+// Simplify every static mesh with quadric edge collapses (CPU only, safe on a worker thread)
+ModelLod GenerateModelLod(Model model);
+
+// Upload the simplified levels to the GPU (requires the window thread)
+void UploadModelLod(ModelLod *lod);
+
+// Release the simplified meshes
+void UnloadModelLod(ModelLod *lod);
+
+// Mesh to use for one model mesh at a LOD (clamped to the levels that exist)
+Mesh GetModelLodMesh(Model model, const ModelLod *lod, int meshIndex, int level);
+
+// Shallow copy of the model drawing every mesh at a LOD, meshes must hold model.meshCount entries
+Model GetModelLodLevel(Model model, const ModelLod *lod, int level, Mesh *meshes);
+
+// Coarsest LOD whose error projects to at most pixelError pixels, from the mesh's world bounds
+int SelectMeshLod(const MeshLod *lod, BoundingBox bounds, Camera3D camera, int screenHeight, float pixelError);
+
+#endif // MESHLOD_H
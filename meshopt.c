@@ -0,0 +1,623 @@
+#include "meshopt.h"
+#include <rlgl.h>
+#include <raymath.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// GL vertex attribute types rlgl has no names for (all core since OpenGL 3.3)
+#define MESH_OPT_GL_UNSIGNED_SHORT 0x1403
+#define MESH_OPT_GL_HALF_FLOAT 0x140B
+#define MESH_OPT_GL_INT_2_10_10_10_REV 0x8D9F
+
+// Triangles sharing a cache-cold start, drawn as one unit by the overdraw sort
+typedef struct {
+    int firstTriangle;
+    int triangleCount;
+    float sortKey;             // How far the cluster faces away from the mesh centre, outer clusters first
+} TriangleCluster;
+
+// Interleaved quantized vertex: 16-bit position padded to 8 bytes, then the attributes the mesh has
+typedef struct {
+    int stride;
+    int normalOffset;          // Byte offsets, -1 for attributes the mesh lacks
+    int texcoordOffset;
+    int texcoord2Offset;
+    int tangentOffset;
+    int colorOffset;
+    bool halfTexcoords;        // Otherwise the coordinates are too large for half floats and stay 32-bit
+    bool halfTexcoords2;
+} QuantizedLayout;
+
+// Function to check whether a mesh can be reordered
+static bool IsMeshOptimizable(Mesh mesh) {
+    return mesh.vertices != NULL && mesh.indices != NULL && mesh.triangleCount > 0 &&
+           mesh.boneIds == NULL && mesh.animVertices == NULL;
+}
+
+// Function to count post-transform cache misses of an index order on a FIFO cache
+static int CountCacheMisses(const unsigned short *indices, int indexCount, int vertexCount) {
+    int *cacheTime = (int *)calloc(vertexCount, sizeof(int));
+    if (cacheTime == NULL) return 0;
+
+    // A vertex is cached while fewer than MESH_OPT_CACHE_SIZE misses happened since its own
+    int time = MESH_OPT_CACHE_SIZE + 1;
+    int misses = 0;
+    for (int i = 0; i < indexCount; i++) {
+        int v = indices[i];
+        if (time - cacheTime[v] > MESH_OPT_CACHE_SIZE) {
+            cacheTime[v] = time++;
+            misses++;
+        }
+    }
+
+    free(cacheTime);
+    return misses;
+}
+
+static int CompareTriangleClusters(const void *a, const void *b) {
+    const TriangleCluster *ca = (const TriangleCluster *)a;
+    const TriangleCluster *cb = (const TriangleCluster *)b;
+    if (ca->sortKey != cb->sortKey) return (ca->sortKey < cb->sortKey) - (ca->sortKey > cb->sortKey);
+    return ca->firstTriangle - cb->firstTriangle;
+}
+
+// Function to order triangles with Tipsify (Sander et al. 2007): fan around the cached vertex that stays useful longest
+// order receives triangle indices, clusterStart the first order slot of each cluster; returns the cluster count or -1
+static int OrderTrianglesForCache(const unsigned short *indices, int triangleCount, int vertexCount, int *order, int *clusterStart) {
+    int indexCount = triangleCount * 3;
+    int *offsets = (int *)calloc(vertexCount + 1, sizeof(int));
+    int *adjacency = (int *)malloc(sizeof(int) * indexCount);
+    int *live = (int *)calloc(vertexCount, sizeof(int));
+    int *cacheTime = (int *)calloc(vertexCount, sizeof(int));
+    int *deadEnd = (int *)malloc(sizeof(int) * indexCount);
+    bool *emitted = (bool *)calloc(triangleCount, sizeof(bool));
+
+    if (offsets == NULL || adjacency == NULL || live == NULL || cacheTime == NULL || deadEnd == NULL || emitted == NULL) {
+        free(offsets);
+        free(adjacency);
+        free(live);
+        free(cacheTime);
+        free(deadEnd);
+        free(emitted);
+        return -1;
+    }
+
+    // Triangles around each vertex
+    for (int i = 0; i < indexCount; i++) live[indices[i]]++;
+    for (int v = 0; v < vertexCount; v++) offsets[v + 1] = offsets[v] + live[v];
+    for (int i = 0; i < indexCount; i++) adjacency[offsets[indices[i]]++] = i / 3;
+    for (int v = vertexCount; v > 0; v--) offsets[v] = offsets[v - 1];
+    offsets[0] = 0;
+
+    int time = MESH_OPT_CACHE_SIZE + 1;
+    int deadEndCount = 0;
+    int cursor = 0;
+    int emittedCount = 0;
+    int clusterCount = 0;
+
+    while (cursor < vertexCount && live[cursor] == 0) cursor++;
+    int fanning = (cursor < vertexCount) ? cursor : -1;
+    if (fanning >= 0) clusterStart[clusterCount++] = 0;
+
+    while (fanning >= 0) {
+        int candidatesStart = deadEndCount;
+        for (int a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+            int t = adjacency[a];
+            if (emitted[t]) continue;
+
+            emitted[t] = true;
+            order[emittedCount++] = t;
+            for (int k = 0; k < 3; k++) {
+                int v = indices[t * 3 + k];
+                deadEnd[deadEndCount++] = v;
+                live[v]--;
+                if (time - cacheTime[v] > MESH_OPT_CACHE_SIZE) cacheTime[v] = time++;
+            }
+        }
+
+        // Prefer the oldest candidate that will still be cached once its remaining triangles are emitted
+        int best = -1;
+        int bestPriority = -1;
+        for (int c = candidatesStart; c < deadEndCount; c++) {
+            int v = deadEnd[c];
+            if (live[v] == 0) continue;
+
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= MESH_OPT_CACHE_SIZE) priority = time - cacheTime[v];
+            if (priority > bestPriority) {
+                best = v;
+                bestPriority = priority;
+            }
+        }
+
+        // Dead end: go back to a recently touched vertex, or scan on for any vertex with triangles left
+        if (best < 0) {
+            while (deadEndCount > 0 && best < 0) {
+                int v = deadEnd[--deadEndCount];
+                if (live[v] > 0) best = v;
+            }
+            while (best < 0 && cursor < vertexCount) {
+                if (live[cursor] > 0) best = cursor;
+                else cursor++;
+            }
+
+            // The next fan starts cold, which is where the overdraw sort may cut without costing cache misses
+            if (best >= 0 && time - cacheTime[best] > MESH_OPT_CACHE_SIZE) clusterStart[clusterCount++] = emittedCount;
+        }
+
+        fanning = best;
+    }
+
+    free(offsets);
+    free(adjacency);
+    free(live);
+    free(cacheTime);
+    free(deadEnd);
+    free(emitted);
+
+    return clusterCount;
+}
+
+// Function to sort triangle clusters so the ones facing out of the mesh are drawn first and occlude the rest
+static bool SortClustersForOverdraw(Mesh mesh, const int *order, const int *clusterStart, int clusterCount, unsigned short *output) {
+    TriangleCluster *clusters = (TriangleCluster *)malloc(sizeof(TriangleCluster) * clusterCount);
+    Vector3 *centroids = (Vector3 *)malloc(sizeof(Vector3) * clusterCount);
+    Vector3 *normals = (Vector3 *)malloc(sizeof(Vector3) * clusterCount);
+
+    if (clusters == NULL || centroids == NULL || normals == NULL) {
+        free(clusters);
+        free(centroids);
+        free(normals);
+        return false;
+    }
+
+    // Area-weighted centroid and normal of every cluster, and the centroid of the whole mesh
+    Vector3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    for (int c = 0; c < clusterCount; c++) {
+        int first = clusterStart[c];
+        int last = (c + 1 < clusterCount) ? clusterStart[c + 1] : mesh.triangleCount;
+        Vector3 centroid = { 0.0f, 0.0f, 0.0f };
+        Vector3 normal = { 0.0f, 0.0f, 0.0f };
+        float area = 0.0f;
+
+        for (int i = first; i < last; i++) {
+            const unsigned short *tri = mesh.indices + order[i] * 3;
+            Vector3 a = { mesh.vertices[tri[0] * 3], mesh.vertices[tri[0] * 3 + 1], mesh.vertices[tri[0] * 3 + 2] };
+            Vector3 b = { mesh.vertices[tri[1] * 3], mesh.vertices[tri[1] * 3 + 1], mesh.vertices[tri[1] * 3 + 2] };
+            Vector3 p = { mesh.vertices[tri[2] * 3], mesh.vertices[tri[2] * 3 + 1], mesh.vertices[tri[2] * 3 + 2] };
+            Vector3 n = Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(p, a));
+            float triangleArea = Vector3Length(n);
+
+            centroid = Vector3Add(centroid, Vector3Scale(Vector3Add(Vector3Add(a, b), p), triangleArea / 3.0f));
+            normal = Vector3Add(normal, n);
+            area += triangleArea;
+        }
+
+        meshCentroid = Vector3Add(meshCentroid, centroid);
+        meshArea += area;
+        centroids[c] = (area > 0.0f) ? Vector3Scale(centroid, 1.0f / area) : centroid;
+        normals[c] = Vector3Normalize(normal);
+        clusters[c] = (TriangleCluster){ first, last - first, 0.0f };
+    }
+    if (meshArea > 0.0f) meshCentroid = Vector3Scale(meshCentroid, 1.0f / meshArea);
+
+    for (int c = 0; c < clusterCount; c++) {
+        clusters[c].sortKey = Vector3DotProduct(Vector3Subtract(centroids[c], meshCentroid), normals[c]);
+    }
+    qsort(clusters, clusterCount, sizeof(TriangleCluster), CompareTriangleClusters);
+
+    int written = 0;
+    for (int c = 0; c < clusterCount; c++) {
+        for (int i = 0; i < clusters[c].triangleCount; i++) {
+            memcpy(output + written * 3, mesh.indices + order[clusters[c].firstTriangle + i] * 3, sizeof(unsigned short) * 3);
+            written++;
+        }
+    }
+
+    free(clusters);
+    free(centroids);
+    free(normals);
+    return true;
+}
+
+// Function to apply a vertex permutation to one attribute array, newArray[remap[v]] = array[v]
+static bool RemapAttribute(void **array, size_t stride, const int *remap, int vertexCount) {
+    if (*array == NULL) return true;
+
+    unsigned char *source = (unsigned char *)*array;
+    unsigned char *remapped = (unsigned char *)malloc(stride * vertexCount);
+    if (remapped == NULL) return false;
+
+    for (int v = 0; v < vertexCount; v++) {
+        memcpy(remapped + (size_t)remap[v] * stride, source + (size_t)v * stride, stride);
+    }
+
+    // raylib allocates mesh arrays with RL_MALLOC, which is malloc unless raylib was rebuilt otherwise
+    free(*array);
+    *array = remapped;
+    return true;
+}
+
+// Function to reorder one mesh
+void OptimizeMesh(Mesh *mesh) {
+    if (!IsMeshOptimizable(*mesh)) return;
+
+    int indexCount = mesh->triangleCount * 3;
+    for (int i = 0; i < indexCount; i++) {
+        if (mesh->indices[i] >= mesh->vertexCount) return;
+    }
+
+    int *order = (int *)malloc(sizeof(int) * mesh->triangleCount);
+    int *clusterStart = (int *)malloc(sizeof(int) * mesh->triangleCount);
+    unsigned short *indices = (unsigned short *)malloc(sizeof(unsigned short) * indexCount);
+    int *remap = (int *)malloc(sizeof(int) * mesh->vertexCount);
+
+    int clusterCount = -1;
+    if (order != NULL && clusterStart != NULL && indices != NULL && remap != NULL) {
+        clusterCount = OrderTrianglesForCache(mesh->indices, mesh->triangleCount, mesh->vertexCount, order, clusterStart);
+    }
+    if (clusterCount < 0 || !SortClustersForOverdraw(*mesh, order, clusterStart, clusterCount, indices)) {
+        printf("Failed to allocate mesh optimization buffers for %d triangles\n", mesh->triangleCount);
+        free(order);
+        free(clusterStart);
+        free(indices);
+        free(remap);
+        return;
+    }
+
+    // Vertices in the order the index buffer first reaches them, unreferenced ones at the end
+    int next = 0;
+    for (int v = 0; v < mesh->vertexCount; v++) remap[v] = -1;
+    for (int i = 0; i < indexCount; i++) {
+        if (remap[indices[i]] < 0) remap[indices[i]] = next++;
+        indices[i] = (unsigned short)remap[indices[i]];
+    }
+    for (int v = 0; v < mesh->vertexCount; v++) {
+        if (remap[v] < 0) remap[v] = next++;
+    }
+
+    bool remapped = RemapAttribute((void **)&mesh->vertices, sizeof(float) * 3, remap, mesh->vertexCount) &&
+                    RemapAttribute((void **)&mesh->normals, sizeof(float) * 3, remap, mesh->vertexCount) &&
+                    RemapAttribute((void **)&mesh->texcoords, sizeof(float) * 2, remap, mesh->vertexCount) &&
+                    RemapAttribute((void **)&mesh->texcoords2, sizeof(float) * 2, remap, mesh->vertexCount) &&
+                    RemapAttribute((void **)&mesh->tangents, sizeof(float) * 4, remap, mesh->vertexCount) &&
+                    RemapAttribute((void **)&mesh->colors, 4, remap, mesh->vertexCount);
+
+    // Attributes already remapped can't be put back, so a failure part way leaves the mesh broken
+    if (!remapped) printf("Failed to reorder mesh vertices, the mesh is left inconsistent\n");
+    memcpy(mesh->indices, indices, sizeof(unsigned short) * indexCount);
+
+    free(order);
+    free(clusterStart);
+    free(indices);
+    free(remap);
+}
+
+// Function to release a mesh's GPU buffers but keep its CPU arrays
+void UnloadMeshBuffers(Mesh *mesh) {
+    Mesh buffers = {0};
+    buffers.vaoId = mesh->vaoId;
+    buffers.vboId = mesh->vboId;
+    UnloadMesh(buffers);
+
+    mesh->vaoId = 0;
+    mesh->vboId = NULL;
+}
+
+// Function to convert a float to IEEE half precision, rounding to nearest
+static unsigned short FloatToHalf(float value) {
+    union { float f; unsigned int u; } bits = { value };
+    unsigned int sign = (bits.u >> 16) & 0x8000;
+    int exponent = (int)((bits.u >> 23) & 0xFF) - 127 + 15;
+    unsigned int mantissa = bits.u & 0x7FFFFF;
+
+    if (exponent <= 0) {
+        if (exponent < -10) return (unsigned short)sign;
+        mantissa |= 0x800000;
+        return (unsigned short)(sign | (mantissa >> (14 - exponent)));
+    }
+    if (exponent >= 31) return (unsigned short)(sign | 0x7C00);
+
+    // A carry out of the mantissa correctly bumps the exponent
+    unsigned int half = sign | ((unsigned int)exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000) half++;
+    return (unsigned short)half;
+}
+
+// Function to pack a unit vector into signed normalized 10:10:10:2
+static unsigned int PackSnorm1010102(float x, float y, float z, float w) {
+    int ix = (int)roundf(Clamp(x, -1.0f, 1.0f) * 511.0f);
+    int iy = (int)roundf(Clamp(y, -1.0f, 1.0f) * 511.0f);
+    int iz = (int)roundf(Clamp(z, -1.0f, 1.0f) * 511.0f);
+    int iw = (w < 0.0f) ? -2 : 1;  // Decodes to -1 and 1 under both the GL 3.3 and the GL 4.2 snorm rule
+
+    return ((unsigned int)ix & 0x3FF) | (((unsigned int)iy & 0x3FF) << 10) | (((unsigned int)iz & 0x3FF) << 20) |
+           (((unsigned int)iw & 0x3) << 30);
+}
+
+// Function to check whether texture coordinates stay in the range half floats hold precisely enough
+static bool FitsHalfTexcoords(const float *texcoords, int vertexCount) {
+    for (int i = 0; i < vertexCount * 2; i++) {
+        if (fabsf(texcoords[i]) > MESH_OPT_HALF_TEXCOORD_RANGE) return false;
+    }
+    return true;
+}
+
+// Function to lay out the quantized vertex of a mesh
+static QuantizedLayout GetQuantizedLayout(Mesh mesh) {
+    QuantizedLayout layout = { 8, -1, -1, -1, -1, -1, false, false };
+    layout.halfTexcoords = mesh.texcoords != NULL && FitsHalfTexcoords(mesh.texcoords, mesh.vertexCount);
+    layout.halfTexcoords2 = mesh.texcoords2 != NULL && FitsHalfTexcoords(mesh.texcoords2, mesh.vertexCount);
+
+    if (mesh.normals != NULL) { layout.normalOffset = layout.stride; layout.stride += 4; }
+    if (mesh.texcoords != NULL) { layout.texcoordOffset = layout.stride; layout.stride += layout.halfTexcoords ? 4 : 8; }
+    if (mesh.texcoords2 != NULL) { layout.texcoord2Offset = layout.stride; layout.stride += layout.halfTexcoords2 ? 4 : 8; }
+    if (mesh.tangents != NULL) { layout.tangentOffset = layout.stride; layout.stride += 4; }
+    if (mesh.colors != NULL) { layout.colorOffset = layout.stride; layout.stride += 4; }
+
+    return layout;
+}
+
+// Function to disable a vertex attribute the mesh lacks and give shaders raylib's default for it
+static void SetMissingAttribute(int location, const float *value, int type, int count) {
+    rlSetVertexAttributeDefault(location, value, type, count);
+    rlDisableVertexAttribute(location);
+}
+
+// Function to upload one mesh in the quantized vertex format
+bool UploadQuantizedMesh(Mesh *mesh, Matrix *dequant) {
+    if (mesh->vertices == NULL || mesh->vertexCount == 0 || mesh->vaoId > 0) return false;
+
+    QuantizedLayout layout = GetQuantizedLayout(*mesh);
+    int stride = layout.stride;
+
+    // Older GL without vertex array objects would draw the buffer as floats
+    unsigned int vaoId = rlLoadVertexArray();
+    unsigned char *data = (unsigned char *)calloc(mesh->vertexCount, stride);
+    unsigned int *vboId = (unsigned int *)calloc(MESH_OPT_VERTEX_BUFFERS, sizeof(unsigned int));
+    if (vaoId == 0 || data == NULL || vboId == NULL) {
+        if (vaoId > 0) rlUnloadVertexArray(vaoId);
+        free(data);
+        free(vboId);
+        return false;
+    }
+
+    // A uniform scale keeps the dequantization a similarity transform, so normal matrices stay valid
+    BoundingBox box = { { mesh->vertices[0], mesh->vertices[1], mesh->vertices[2] }, { mesh->vertices[0], mesh->vertices[1], mesh->vertices[2] } };
+    for (int v = 1; v < mesh->vertexCount; v++) {
+        Vector3 p = { mesh->vertices[v * 3], mesh->vertices[v * 3 + 1], mesh->vertices[v * 3 + 2] };
+        box.min = Vector3Min(box.min, p);
+        box.max = Vector3Max(box.max, p);
+    }
+    Vector3 size = Vector3Subtract(box.max, box.min);
+    float scale = fmaxf(size.x, fmaxf(size.y, size.z));
+    if (scale <= 0.0f) scale = 1.0f;
+
+    for (int v = 0; v < mesh->vertexCount; v++) {
+        unsigned char *vertex = data + (size_t)v * stride;
+
+        unsigned short position[4] = { 0, 0, 0, 0 };
+        for (int k = 0; k < 3; k++) {
+            float offset = mesh->vertices[v * 3 + k] - ((k == 0) ? box.min.x : (k == 1) ? box.min.y : box.min.z);
+            position[k] = (unsigned short)Clamp(offset / scale * 65535.0f + 0.5f, 0.0f, 65535.0f);
+        }
+        memcpy(vertex, position, sizeof(position));
+
+        if (mesh->normals != NULL) {
+            const float *n = mesh->normals + v * 3;
+            unsigned int packed = PackSnorm1010102(n[0], n[1], n[2], 0.0f);
+            memcpy(vertex + layout.normalOffset, &packed, 4);
+        }
+        if (mesh->texcoords != NULL) {
+            if (layout.halfTexcoords) {
+                unsigned short uv[2] = { FloatToHalf(mesh->texcoords[v * 2]), FloatToHalf(mesh->texcoords[v * 2 + 1]) };
+                memcpy(vertex + layout.texcoordOffset, uv, 4);
+            } else {
+                memcpy(vertex + layout.texcoordOffset, mesh->texcoords + v * 2, 8);
+            }
+        }
+        if (mesh->texcoords2 != NULL) {
+            if (layout.halfTexcoords2) {
+                unsigned short uv[2] = { FloatToHalf(mesh->texcoords2[v * 2]), FloatToHalf(mesh->texcoords2[v * 2 + 1]) };
+                memcpy(vertex + layout.texcoord2Offset, uv, 4);
+            } else {
+                memcpy(vertex + layout.texcoord2Offset, mesh->texcoords2 + v * 2, 8);
+            }
+        }
+        if (mesh->tangents != NULL) {
+            const float *t = mesh->tangents + v * 4;
+            unsigned int packed = PackSnorm1010102(t[0], t[1], t[2], t[3]);
+            memcpy(vertex + layout.tangentOffset, &packed, 4);
+        }
+        if (mesh->colors != NULL) memcpy(vertex + layout.colorOffset, mesh->colors + v * 4, 4);
+    }
+
+    rlEnableVertexArray(vaoId);
+    vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = rlLoadVertexBuffer(data, stride * mesh->vertexCount, false);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, MESH_OPT_GL_UNSIGNED_SHORT, true, stride, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+
+    float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if (mesh->normals != NULL) {
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 4, MESH_OPT_GL_INT_2_10_10_10_REV, true, stride, layout.normalOffset);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+    } else {
+        SetMissingAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, white, SHADER_ATTRIB_VEC3, 3);
+    }
+    if (mesh->texcoords != NULL) {
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, layout.halfTexcoords ? MESH_OPT_GL_HALF_FLOAT : RL_FLOAT, false, stride, layout.texcoordOffset);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+    } else {
+        SetMissingAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, zero, SHADER_ATTRIB_VEC2, 2);
+    }
+    if (mesh->texcoords2 != NULL) {
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, 2, layout.halfTexcoords2 ? MESH_OPT_GL_HALF_FLOAT : RL_FLOAT, false, stride, layout.texcoord2Offset);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2);
+    } else {
+        SetMissingAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, zero, SHADER_ATTRIB_VEC2, 2);
+    }
+    if (mesh->tangents != NULL) {
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, 4, MESH_OPT_GL_INT_2_10_10_10_REV, true, stride, layout.tangentOffset);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+    } else {
+        SetMissingAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, zero, SHADER_ATTRIB_VEC4, 4);
+    }
+    if (mesh->colors != NULL) {
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, stride, layout.colorOffset);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+    } else {
+        SetMissingAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, white, SHADER_ATTRIB_VEC4, 4);
+    }
+
+    if (mesh->indices != NULL) {
+        vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = rlLoadVertexBufferElement(mesh->indices, sizeof(unsigned short) * mesh->triangleCount * 3, false);
+    }
+    rlDisableVertexArray();
+    free(data);
+
+    mesh->vaoId = vaoId;
+    mesh->vboId = vboId;
+    *dequant = MatrixMultiply(MatrixScale(scale, scale, scale), MatrixTranslate(box.min.x, box.min.y, box.min.z));
+    return true;
+}
+
+// Function to get the size of a mesh's vertex data as raylib uploads it
+static size_t GetFloatVertexBytes(Mesh mesh) {
+    size_t stride = 3 * sizeof(float);
+    if (mesh.normals != NULL) stride += 3 * sizeof(float);
+    if (mesh.texcoords != NULL) stride += 2 * sizeof(float);
+    if (mesh.texcoords2 != NULL) stride += 2 * sizeof(float);
+    if (mesh.tangents != NULL) stride += 4 * sizeof(float);
+    if (mesh.colors != NULL) stride += 4;
+    return stride * mesh.vertexCount;
+}
+
+// Function to upload one mesh quantized, recording its dequantization, or as floats if that fails
+static void UploadMeshForQuantization(ModelQuantization *quantization, Mesh *mesh, Matrix *dequant) {
+    size_t floatBytes = GetFloatVertexBytes(*mesh);
+    if (!UploadQuantizedMesh(mesh, dequant)) {
+        UploadMesh(mesh, false);
+        return;
+    }
+
+    quantization->quantizedMeshes++;
+    quantization->floatBytes += floatBytes;
+    quantization->quantizedBytes += (size_t)GetQuantizedLayout(*mesh).stride * mesh->vertexCount;
+}
+
+// Function to allocate identity dequantization transforms for one LOD
+static bool AllocateQuantizationLevel(ModelQuantization *quantization, int level) {
+    quantization->transforms[level] = (Matrix *)malloc(sizeof(Matrix) * quantization->meshCount);
+    if (quantization->transforms[level] == NULL) {
+        printf("Failed to allocate quantization transforms for %d meshes\n", quantization->meshCount);
+        return false;
+    }
+
+    for (int m = 0; m < quantization->meshCount; m++) quantization->transforms[level][m] = MatrixIdentity();
+    return true;
+}
+
+// Function to reorder every static mesh, reporting the vertex cache miss ratio before and after
+void OptimizeModelMeshes(Model model) {
+    long long missesBefore = 0;
+    long long missesAfter = 0;
+    long long triangles = 0;
+    int optimized = 0;
+
+    for (int m = 0; m < model.meshCount; m++) {
+        Mesh *mesh = &model.meshes[m];
+        if (!IsMeshOptimizable(*mesh)) continue;
+
+        missesBefore += CountCacheMisses(mesh->indices, mesh->triangleCount * 3, mesh->vertexCount);
+        OptimizeMesh(mesh);
+        missesAfter += CountCacheMisses(mesh->indices, mesh->triangleCount * 3, mesh->vertexCount);
+        triangles += mesh->triangleCount;
+        optimized++;
+    }
+
+    if (triangles > 0) {
+        printf("Mesh optimization: %d meshes reordered, vertex cache misses per triangle %.2f -> %.2f\n",
+               optimized, (double)missesBefore / triangles, (double)missesAfter / triangles);
+    }
+}
+
+// Function to reorder every simplified level
+void OptimizeModelLod(ModelLod *lod) {
+    for (int i = 0; i < lod->meshCount; i++) {
+        for (int level = 1; level < lod->meshes[i].levelCount; level++) {
+            OptimizeMesh(&lod->meshes[i].levels[level - 1]);
+        }
+    }
+}
+
+// Function to replace the GPU copies of the static meshes
+ModelQuantization ReloadModelMeshes(Model *model, bool quantize) {
+    ModelQuantization quantization = {0};
+    quantization.meshCount = model->meshCount;
+    if (quantize && !AllocateQuantizationLevel(&quantization, 0)) quantize = false;
+
+    for (int m = 0; m < model->meshCount; m++) {
+        Mesh *mesh = &model->meshes[m];
+
+        // Batched meshes have no buffers of their own anymore, skinned ones are updated as floats every frame
+        if (mesh->vaoId == 0 || mesh->vertices == NULL || mesh->boneIds != NULL || mesh->animVertices != NULL) continue;
+
+        UnloadMeshBuffers(mesh);
+        if (quantize) {
+            UploadMeshForQuantization(&quantization, mesh, &quantization.transforms[0][m]);
+        } else {
+            UploadMesh(mesh, false);
+        }
+    }
+
+    if (quantization.quantizedMeshes > 0) {
+        printf("Quantized %d meshes: %.1f MB of vertex data instead of %.1f MB\n", quantization.quantizedMeshes,
+               quantization.quantizedBytes / (1024.0 * 1024.0), quantization.floatBytes / (1024.0 * 1024.0));
+    }
+
+    return quantization;
+}
+
+// Function to upload the simplified levels quantized
+void UploadQuantizedModelLod(ModelQuantization *quantization, ModelLod *lod) {
+    int quantizedMeshes = quantization->quantizedMeshes;
+    size_t floatBytes = quantization->floatBytes;
+    size_t quantizedBytes = quantization->quantizedBytes;
+
+    if (quantization->meshCount == 0) quantization->meshCount = lod->meshCount;
+    for (int level = 1; level < MESH_LOD_MAX_LEVELS; level++) {
+        if (quantization->transforms[level] == NULL && !AllocateQuantizationLevel(quantization, level)) {
+            UploadModelLod(lod);
+            return;
+        }
+    }
+
+    for (int i = 0; i < lod->meshCount; i++) {
+        for (int level = 1; level < lod->meshes[i].levelCount; level++) {
+            UploadMeshForQuantization(quantization, &lod->meshes[i].levels[level - 1], &quantization->transforms[level][i]);
+        }
+    }
+    lod->uploaded = true;
+
+    printf("Quantized %d LOD meshes: %.1f MB of vertex data instead of %.1f MB\n", quantization->quantizedMeshes - quantizedMeshes,
+           (quantization->quantizedBytes - quantizedBytes) / (1024.0 * 1024.0), (quantization->floatBytes - floatBytes) / (1024.0 * 1024.0));
+}
+
+// Function to release the dequantization transforms
+void UnloadModelQuantization(ModelQuantization *quantization) {
+    for (int level = 0; level < MESH_LOD_MAX_LEVELS; level++) {
+        free(quantization->transforms[level]);
+    }
+    memset(quantization, 0, sizeof(*quantization));
+}
+
+// Function to get the transform a mesh is drawn with
+Matrix GetMeshDrawTransform(const ModelQuantization *quantization, int meshIndex, int level, Matrix transform) {
+    if (quantization->transforms[level] == NULL) return transform;
+
+    return MatrixMultiply(quantization->transforms[level][meshIndex], transform);
+}
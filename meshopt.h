@@ -0,0 +1,52 @@
+#ifndef MESHOPT_H
+#define MESHOPT_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "meshlod.h"
+
+// Mesh optimization settings
+#define MESH_OPT_CACHE_SIZE 16             // Post-transform vertex cache entries the triangle order is tuned for
+#define MESH_OPT_HALF_TEXCOORD_RANGE 4.0f  // UVs beyond this keep 32-bit floats, half floats get too coarse for tiling
+#define MESH_OPT_VERTEX_BUFFERS 9          // raylib's MAX_MESH_VERTEX_BUFFERS, UnloadMesh walks that many buffer ids
+
+// Dequantization transforms of the meshes whose GPU copy stores 16-bit positions
+typedef struct {
+    Matrix *transforms[MESH_LOD_MAX_LEVELS];   // Per model mesh and LOD, identity for float meshes (NULL until quantized)
+    int meshCount;
+    int quantizedMeshes;
+    size_t floatBytes;                         // Vertex data the quantized meshes would have taken as floats
+    size_t quantizedBytes;
+} ModelQuantization;
+
+// Reorder a mesh's triangles for the post-transform cache and overdraw, then its vertices for fetch locality
+// CPU only, safe on a worker thread; the GPU copy is stale until the mesh is uploaded again
+void OptimizeMesh(Mesh *mesh);
+
+// Release a mesh's GPU buffers but keep its CPU arrays
+void UnloadMeshBuffers(Mesh *mesh);
+
+// Upload a mesh with 16-bit positions, packed normals/tangents and half-float UVs instead of floats (requires the window thread)
+// Positions are dequantized by drawing with *dequant applied before the model transform; returns false if nothing was uploaded
+bool UploadQuantizedMesh(Mesh *mesh, Matrix *dequant);
+
+// Reorder every static mesh of the model (CPU only, the GPU copies are replaced by ReloadModelMeshes)
+void OptimizeModelMeshes(Model model);
+
+// Reorder every simplified level (CPU only, run before UploadModelLod)
+void OptimizeModelLod(ModelLod *lod);
+
+// Replace the GPU buffers of the static meshes that still have them, quantized when quantize is set
+ModelQuantization ReloadModelMeshes(Model *model, bool quantize);
+
+// Upload the simplified levels quantized, in place of UploadModelLod
+void UploadQuantizedModelLod(ModelQuantization *quantization, ModelLod *lod);
+
+// Release the dequantization transforms
+void UnloadModelQuantization(ModelQuantization *quantization);
+
+// Transform to draw a mesh at a LOD with, the model transform preceded by its dequantization
+Matrix GetMeshDrawTransform(const ModelQuantization *quantization, int meshIndex, int level, Matrix transform);
+
+#endif // MESHOPT_H
@@ -0,0 +1,308 @@
+#include "modelloader.h"
+#include "meshopt.h"
+#include "gltfdecode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// Read being handed to raylib through the file data callback
+static ModelFileLoad *prefetchedLoad = NULL;
+
+// Function to read a whole file in chunks, publishing progress when a load is given
+static unsigned char *ReadFileChunked(const char *path, int *dataSize, ModelFileLoad *load) {
+    *dataSize = 0;
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Failed to open file: %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // raylib file data sizes are ints
+    if (size <= 0 || size > INT_MAX) {
+        printf("Failed to read file: %s (size %ld)\n", path, size);
+        fclose(file);
+        return NULL;
+    }
+    if (load != NULL) ATOMIC_STORE(&load->size, (int)size);
+
+    unsigned char *data = (unsigned char *)malloc((size_t)size);
+    if (data == NULL) {
+        printf("Failed to allocate %ld bytes for %s\n", size, path);
+        fclose(file);
+        return NULL;
+    }
+
+    long offset = 0;
+    while (offset < size) {
+        long chunk = size - offset;
+        if (chunk > MODEL_LOADER_CHUNK_SIZE) chunk = MODEL_LOADER_CHUNK_SIZE;
+
+        size_t count = fread(data + offset, 1, (size_t)chunk, file);
+        if (count == 0) break;
+
+        offset += (long)count;
+        if (load != NULL) ATOMIC_STORE(&load->bytesRead, (int)offset);
+    }
+    fclose(file);
+
+    if (offset < size) {
+        printf("Failed to read file: %s (%ld of %ld bytes)\n", path, offset, size);
+        free(data);
+        return NULL;
+    }
+
+    *dataSize = (int)size;
+    return data;
+}
+
+// Function to serve the prefetched model file to raylib, other files (textures, .bin buffers) are read normally
+static unsigned char *LoadPrefetchedFileData(const char *fileName, int *dataSize) {
+    if (prefetchedLoad != NULL && prefetchedLoad->data != NULL && strcmp(fileName, prefetchedLoad->path) == 0) {
+        unsigned char *data = prefetchedLoad->data;  // raylib releases it with UnloadFileData
+        *dataSize = prefetchedLoad->dataSize;
+        prefetchedLoad->data = NULL;
+        return data;
+    }
+
+    return ReadFileChunked(fileName, dataSize, NULL);
+}
+
+// Function run by the reader thread
+static void *ModelFileLoadMain(void *arg) {
+    ModelFileLoad *load = (ModelFileLoad *)arg;
+    int size = 0;
+
+    load->data = ReadFileChunked(load->path, &size, load);
+    if (load->data != NULL) load->hash = HashSceneData(load->data, (size_t)size);
+
+    // Compressed buffer views are expanded here so raylib's loader only ever sees plain accessors
+    if (load->data != NULL && !DecodeCompressedGltf(&load->data, &size, load->jobs)) {
+        free(load->data);
+        load->data = NULL;
+    }
+
+    // KTX2 textures are picked out before raylib parses the file, so it never decodes their PNG/JPEG fallbacks
+    if (load->data != NULL && load->textureFormats != 0) {
+        ExtractGltfKtx2Textures(load->data, size, load->path, load->textureFormats, &load->textures);
+    }
+    load->dataSize = size;
+    ATOMIC_STORE(&load->state, (load->data != NULL) ? MODEL_LOAD_READY : MODEL_LOAD_FAILED);
+
+    return NULL;
+}
+
+// Function to start reading a model file
+void BeginModelFileLoad(ModelFileLoad *load, const char *path, JobSystem *jobs, unsigned int textureFormats) {
+    memset(load, 0, sizeof(*load));
+    load->state = MODEL_LOAD_READING;
+    load->jobs = jobs;
+    load->textureFormats = textureFormats;
+
+    size_t length = strlen(path);
+    load->path = (char *)malloc(length + 1);
+    if (load->path == NULL) {
+        load->state = MODEL_LOAD_FAILED;
+        return;
+    }
+    memcpy(load->path, path, length + 1);
+
+    if (pthread_create(&load->thread, NULL, ModelFileLoadMain, load) == 0) {
+        load->started = true;
+    } else {
+        printf("Failed to start model reader thread, reading on the main thread\n");
+        ModelFileLoadMain(load);
+    }
+}
+
+// Function to get the read progress
+float GetModelFileLoadProgress(const ModelFileLoad *load) {
+    int size = ATOMIC_LOAD(&load->size);
+    if (size <= 0) return 0.0f;
+
+    return (float)ATOMIC_LOAD(&load->bytesRead) / (float)size;
+}
+
+// Function to check whether the read has finished
+bool IsModelFileLoadDone(const ModelFileLoad *load) {
+    return ATOMIC_LOAD(&load->state) != MODEL_LOAD_READING;
+}
+
+// Function to wait for the reader thread
+static void JoinModelFileLoad(ModelFileLoad *load) {
+    if (load->started) {
+        pthread_join(load->thread, NULL);
+        load->started = false;
+    }
+}
+
+// Function to parse the prefetched file with raylib's loader
+Model FinishModelFileLoad(ModelFileLoad *load, TextureStream *textures) {
+    Model model = {0};
+    JoinModelFileLoad(load);
+
+    if (load->state == MODEL_LOAD_READY) {
+        // LoadModel reads through LoadFileData, which picks up the buffer instead of touching the disk again
+        prefetchedLoad = load;
+        SetLoadFileDataCallback(LoadPrefetchedFileData);
+        model = LoadModel(load->path);
+        SetLoadFileDataCallback(NULL);
+        prefetchedLoad = NULL;
+    }
+
+    memset(textures, 0, sizeof(*textures));
+    if (model.meshCount > 0) {
+        *textures = load->textures;
+        memset(&load->textures, 0, sizeof(load->textures));
+    }
+
+    CancelModelFileLoad(load);
+    return model;
+}
+
+// Function to abandon a read
+void CancelModelFileLoad(ModelFileLoad *load) {
+    JoinModelFileLoad(load);
+
+    free(load->data);
+    free(load->path);
+    load->data = NULL;
+    load->path = NULL;
+    UnloadTextureStream(&load->textures, NULL);
+}
+
+// Function run by the collision build thread
+static void *CollisionBuildMain(void *arg) {
+    CollisionBuild *build = (CollisionBuild *)arg;
+
+    if (build->buildLod) {
+        build->lod = GenerateModelLod(build->model);
+        if (build->optimizeLod) OptimizeModelLod(&build->lod);
+    }
+
+    if (build->buildCollision) {
+        // Bake from the requested LOD, meshes without that many levels use their finest one
+        Mesh *meshes = (Mesh *)malloc(sizeof(Mesh) * (build->model.meshCount + 1));
+        Model source = build->model;
+        if (meshes != NULL) {
+            source = GetModelLodLevel(build->model, &build->lod, build->settings.collisionLod, meshes);
+        }
+
+        build->collision = LoadModelCollision(source);
+        if (build->settings.useHeightfield) {
+            build->heightfield = LoadHeightfield(&build->collision, build->settings.heightfieldCellSize);
+        }
+        free(meshes);
+
+        if (build->cachePath != NULL && SaveSceneCache(build->cachePath, build->settings, &build->collision, &build->heightfield)) {
+            printf("Saved scene cache: %s\n", build->cachePath);
+        }
+    }
+    ATOMIC_STORE(&build->done, 1);
+
+    return NULL;
+}
+
+// Function to start the background build
+void BeginCollisionBuild(CollisionBuild *build, Model model, SceneCacheKey settings, const char *cachePath,
+                         bool buildCollision, bool buildLod, bool optimizeLod) {
+    memset(build, 0, sizeof(*build));
+    build->model = model;
+    build->settings = settings;
+    build->buildCollision = buildCollision;
+    build->buildLod = buildLod;
+    build->optimizeLod = optimizeLod;
+
+    // Own a copy, the caller's string may be gone before the thread gets to it
+    if (cachePath != NULL) {
+        size_t length = strlen(cachePath);
+        build->cachePath = (char *)malloc(length + 1);
+        if (build->cachePath != NULL) memcpy(build->cachePath, cachePath, length + 1);
+    }
+
+    if (pthread_create(&build->thread, NULL, CollisionBuildMain, build) == 0) {
+        build->started = true;
+    } else {
+        printf("Failed to start collision build thread, building on the main thread\n");
+        CollisionBuildMain(build);
+    }
+}
+
+// Function to collect the collision build results
+bool FinishCollisionBuild(CollisionBuild *build, bool wait, ModelCollision *collision, Heightfield *heightfield, ModelLod *lod) {
+    if (!wait && !ATOMIC_LOAD(&build->done)) return false;
+
+    if (build->started) {
+        pthread_join(build->thread, NULL);
+        build->started = false;
+    }
+
+    free(build->cachePath);
+    build->cachePath = NULL;
+
+    *collision = build->collision;
+    *heightfield = build->heightfield;
+    *lod = build->lod;
+    build->collision = (ModelCollision){0};
+    build->heightfield = (Heightfield){0};
+    build->lod = (ModelLod){0};
+
+    return true;
+}
+
+// Function to free the vertex attributes of one mesh, returns the bytes released
+static size_t ReleaseMeshData(Mesh *mesh) {
+    size_t vertices = (size_t)mesh->vertexCount;
+    size_t released = 0;
+
+    if (mesh->vertices != NULL) released += vertices * 3 * sizeof(float);
+    if (mesh->normals != NULL) released += vertices * 3 * sizeof(float);
+    if (mesh->texcoords != NULL) released += vertices * 2 * sizeof(float);
+    if (mesh->texcoords2 != NULL) released += vertices * 2 * sizeof(float);
+    if (mesh->tangents != NULL) released += vertices * 4 * sizeof(float);
+    if (mesh->colors != NULL) released += vertices * 4;
+
+    // raylib allocates mesh arrays with RL_MALLOC, which is malloc unless raylib was rebuilt otherwise
+    free(mesh->vertices);
+    free(mesh->normals);
+    free(mesh->texcoords);
+    free(mesh->texcoords2);
+    free(mesh->tangents);
+    free(mesh->colors);
+    mesh->vertices = NULL;
+    mesh->normals = NULL;
+    mesh->texcoords = NULL;
+    mesh->texcoords2 = NULL;
+    mesh->tangents = NULL;
+    mesh->colors = NULL;
+
+    return released;
+}
+
+// Function to release the CPU-side vertex attributes of every static mesh
+size_t ReleaseModelMeshData(Model *model, ModelLod *lod) {
+    size_t released = 0;
+
+    for (int i = 0; i < model->meshCount; i++) {
+        Mesh *mesh = &model->meshes[i];
+
+        // Skinning recomputes the animated vertices from the bind pose every frame
+        if (mesh->boneIds != NULL || mesh->animVertices != NULL) continue;
+
+        released += ReleaseMeshData(mesh);
+    }
+
+    // Simplified levels are only ever generated for static meshes
+    for (int i = 0; lod != NULL && i < lod->meshCount; i++) {
+        for (int level = 1; level < lod->meshes[i].levelCount; level++) {
+            released += ReleaseMeshData(&lod->meshes[i].levels[level - 1]);
+        }
+    }
+
+    return released;
+}
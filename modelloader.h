@@ -0,0 +1,87 @@
+#ifndef MODELLOADER_H
+#define MODELLOADER_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "collision.h"
+#include "heightfield.h"
+#include "scenecache.h"
+#include "meshlod.h"
+#include "jobs.h"
+#include "texturestream.h"
+
+// Model loading settings
+#define MODEL_LOADER_CHUNK_SIZE (4 * 1024 * 1024)  // Bytes read between progress updates
+
+// Stage of a background model file read
+typedef enum {
+    MODEL_LOAD_READING,
+    MODEL_LOAD_READY,          // Whole file is in memory
+    MODEL_LOAD_FAILED
+} ModelLoadState;
+
+// Model file read on a background thread, parsed on the main thread once it is in memory
+typedef struct {
+    pthread_t thread;
+    bool started;              // A reader thread exists and must be joined
+    char *path;
+    unsigned char *data;       // Handed to raylib by FinishModelFileLoad, with compressed buffers decoded
+    int dataSize;
+    int size;                  // File size, shared with the reader thread and accessed atomically
+    int bytesRead;
+    int state;                 // ModelLoadState
+    unsigned long long hash;   // HashSceneData of the file, valid once the state is MODEL_LOAD_READY
+    JobSystem *jobs;           // Decodes compressed buffer views, owned by the caller and idle until the read is done
+    unsigned int textureFormats;   // GetSupportedTextureFormats bits KTX2 textures may use, 0 decodes every PNG/JPEG fallback
+    TextureStream textures;    // KTX2 material textures found by the reader thread
+} ModelFileLoad;
+
+// LOD chains, collision BVH and heightfield of a loaded model, built on a background thread
+typedef struct {
+    pthread_t thread;
+    bool started;
+    Model model;               // Only the CPU-side mesh arrays are read, the main thread keeps drawing it
+    SceneCacheKey settings;    // Heightfield and collision LOD settings, also the key results are cached under
+    bool buildCollision;       // False when the collision came from the scene cache
+    bool buildLod;
+    bool optimizeLod;          // Reorder the simplified levels for the vertex cache once generated
+    ModelLod lod;
+    ModelCollision collision;
+    Heightfield heightfield;
+    char *cachePath;           // Results are saved here when set
+    int done;                  // Set atomically once the results are complete
+} CollisionBuild;
+
+// Start reading a model file (reads synchronously if no thread can be started)
+// Compressed (EXT_meshopt_compression) buffer views are decoded on jobs once the file is in memory, and KTX2
+// (KHR_texture_basisu) textures in one of textureFormats are collected to be streamed in place of their fallback
+void BeginModelFileLoad(ModelFileLoad *load, const char *path, JobSystem *jobs, unsigned int textureFormats);
+
+// Fraction of the file read so far
+float GetModelFileLoadProgress(const ModelFileLoad *load);
+
+// Check whether the read has finished (successfully or not)
+bool IsModelFileLoadDone(const ModelFileLoad *load);
+
+// Parse the file and upload it to the GPU, must run on the window thread (meshCount is 0 on failure)
+// The KTX2 textures are handed to *textures, still to be uploaded by UpdateTextureStream
+Model FinishModelFileLoad(ModelFileLoad *load, TextureStream *textures);
+
+// Stop waiting for a read and release its memory
+void CancelModelFileLoad(ModelFileLoad *load);
+
+// Start building LODs and collision structures of a model (builds synchronously if no thread can be started)
+// Collision is baked from LOD settings.collisionLod and written to cachePath once built (NULL skips the cache)
+void BeginCollisionBuild(CollisionBuild *build, Model model, SceneCacheKey settings, const char *cachePath,
+                         bool buildCollision, bool buildLod, bool optimizeLod);
+
+// Hand over the results once the build is done, returns false while it is still running (unless wait is set)
+bool FinishCollisionBuild(CollisionBuild *build, bool wait, ModelCollision *collision, Heightfield *heightfield, ModelLod *lod);
+
+// Free the CPU copies of mesh vertex attributes once they are on the GPU and baked into the collision soup
+// Covers the simplified levels too when lod is given; indices stay, DrawMesh uses them to pick indexed drawing
+// Returns the bytes freed, callers report them (tiles release theirs quietly while streaming)
+size_t ReleaseModelMeshData(Model *model, ModelLod *lod);
+
+#endif // MODELLOADER_H
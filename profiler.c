@@ -0,0 +1,204 @@
+#include "profiler.h"
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One entry into a main-thread zone, in milliseconds from the frame start
+typedef struct {
+    int zone;
+    float start;
+    float duration;
+} ProfileSpan;
+
+// Timings of one recorded frame, in milliseconds
+typedef struct {
+    double frameStart;                     // GetTime() at BeginProfileFrame, in seconds
+    float frameTime;
+    float duration[PROFILE_ZONE_COUNT];    // Summed over every entry of the zone
+    ProfileSpan spans[PROFILER_MAX_SPANS];
+    int spanCount;
+} ProfileFrame;
+
+// Ring of recorded frames, frames[current] is the one being recorded
+typedef struct {
+    ProfileFrame frames[PROFILER_HISTORY];
+    int current;
+    int completed;                         // Finished frames in the ring, at most PROFILER_HISTORY - 1
+    double zoneBegin[PROFILE_ZONE_COUNT];
+} Profiler;
+
+static Profiler profiler = {0};
+
+static const char *zoneNames[PROFILE_ZONE_COUNT] = {
+    "Unit sync", "Scene", "Input", "Camera", "Rays", "Unit step",
+    "Draw 3D", "Draw UI", "Present", "Unit jobs", "Ground rays"
+};
+
+// Function to start recording a frame
+void BeginProfileFrame(void) {
+    ProfileFrame *frame = &profiler.frames[profiler.current];
+    memset(frame, 0, sizeof(*frame));
+    frame->frameStart = GetTime();
+}
+
+// Function to finish the current frame and move on to the next slot
+void EndProfileFrame(void) {
+    ProfileFrame *frame = &profiler.frames[profiler.current];
+    frame->frameTime = (float)((GetTime() - frame->frameStart) * 1000.0);
+
+    profiler.current = (profiler.current + 1) % PROFILER_HISTORY;
+    if (profiler.completed < PROFILER_HISTORY - 1) profiler.completed++;
+}
+
+// Function to enter a zone
+void BeginProfileZone(ProfileZone zone) {
+    profiler.zoneBegin[zone] = GetTime();
+}
+
+// Function to leave a zone, adding its time to the frame
+void EndProfileZone(ProfileZone zone) {
+    ProfileFrame *frame = &profiler.frames[profiler.current];
+    double begin = profiler.zoneBegin[zone];
+    float duration = (float)((GetTime() - begin) * 1000.0);
+
+    frame->duration[zone] += duration;
+    if (frame->spanCount < PROFILER_MAX_SPANS) {
+        frame->spans[frame->spanCount++] = (ProfileSpan){ zone, (float)((begin - frame->frameStart) * 1000.0), duration };
+    }
+}
+
+// Function to add externally measured time to a zone
+void AddProfileZoneTime(ProfileZone zone, double seconds) {
+    profiler.frames[profiler.current].duration[zone] += (float)(seconds * 1000.0);
+}
+
+// Function to get a finished frame, 0 is the oldest
+static const ProfileFrame *GetProfileFrame(int index) {
+    int oldest = profiler.current - profiler.completed + PROFILER_HISTORY;
+    return &profiler.frames[(oldest + index) % PROFILER_HISTORY];
+}
+
+// Function to get the duration of the last finished frame
+float GetProfileFrameTime(void) {
+    if (profiler.completed == 0) return 0.0f;
+    return GetProfileFrame(profiler.completed - 1)->frameTime;
+}
+
+// Function to get a zone's time in the last finished frame
+float GetProfileZoneTime(ProfileZone zone) {
+    if (profiler.completed == 0) return 0.0f;
+    return GetProfileFrame(profiler.completed - 1)->duration[zone];
+}
+
+// Function to get the name shown for a zone
+const char *GetProfileZoneName(ProfileZone zone) {
+    return zoneNames[zone];
+}
+
+static int CompareFloats(const void *a, const void *b) {
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Function to compute min/avg/p99 of a zone (PROFILE_ZONE_COUNT means the whole frame)
+static void GetZoneStats(int zone, float *minimum, float *average, float *p99) {
+    static float values[PROFILER_HISTORY];
+    int count = profiler.completed;
+    float sum = 0.0f;
+
+    for (int i = 0; i < count; i++) {
+        const ProfileFrame *frame = GetProfileFrame(i);
+        values[i] = (zone == PROFILE_ZONE_COUNT) ? frame->frameTime : frame->duration[zone];
+        sum += values[i];
+    }
+    if (count == 0) {
+        *minimum = *average = *p99 = 0.0f;
+        return;
+    }
+
+    qsort(values, count, sizeof(float), CompareFloats);
+    *minimum = values[0];
+    *average = sum / count;
+    *p99 = values[(count * 99) / 100];
+}
+
+// Function to draw the statistics table and the frame-time graph
+void DrawProfilerOverlay(int x, int y) {
+    int height = 20 + (PROFILE_ZONE_COUNT + 1) * 12 + 16 + PROFILER_GRAPH_HEIGHT + 20;
+    DrawRectangle(x, y, PROFILER_OVERLAY_WIDTH, height, Fade(BLACK, 0.7f));
+
+    DrawText("PROFILER (ms)", x + 5, y + 5, 10, GREEN);
+    DrawText("min", x + 115, y + 5, 10, GRAY);
+    DrawText("avg", x + 160, y + 5, 10, GRAY);
+    DrawText("p99", x + 205, y + 5, 10, GRAY);
+
+    // Whole frame first, then every zone, worker zones marked
+    int rowY = y + 20;
+    for (int zone = -1; zone < PROFILE_ZONE_COUNT; zone++) {
+        float minimum, average, p99;
+        GetZoneStats((zone < 0) ? PROFILE_ZONE_COUNT : zone, &minimum, &average, &p99);
+
+        Color color = (zone < 0) ? WHITE : (zone >= PROFILE_ZONE_MAIN_COUNT) ? SKYBLUE : LIGHTGRAY;
+        const char *name = (zone < 0) ? "Frame" : zoneNames[zone];
+        DrawText((zone >= PROFILE_ZONE_MAIN_COUNT) ? TextFormat("%s*", name) : name, x + 5, rowY, 10, color);
+        DrawText(TextFormat("%5.2f", minimum), x + 110, rowY, 10, color);
+        DrawText(TextFormat("%5.2f", average), x + 155, rowY, 10, color);
+        DrawText(TextFormat("%5.2f", p99), x + 200, rowY, 10, color);
+        rowY += 12;
+    }
+    DrawText("* summed over all job threads", x + 5, rowY, 10, GRAY);
+    rowY += 16;
+
+    // One column per frame, oldest on the left, with the 60 FPS budget as a reference line
+    int graphBottom = rowY + PROFILER_GRAPH_HEIGHT;
+    int graphLeft = x + 5;
+    float scale = PROFILER_GRAPH_HEIGHT / PROFILER_GRAPH_MAX_MS;
+    for (int i = 0; i < profiler.completed; i++) {
+        float ms = GetProfileFrame(i)->frameTime;
+        int barHeight = (int)(((ms < PROFILER_GRAPH_MAX_MS) ? ms : PROFILER_GRAPH_MAX_MS) * scale);
+        Color color = (ms <= PROFILER_TARGET_MS * 1.05f) ? LIME : (ms <= PROFILER_TARGET_MS * 2.0f) ? YELLOW : RED;
+        DrawLine(graphLeft + i, graphBottom, graphLeft + i, graphBottom - barHeight, color);
+    }
+    int targetY = graphBottom - (int)(PROFILER_TARGET_MS * scale);
+    DrawLine(graphLeft, targetY, graphLeft + PROFILER_HISTORY, targetY, Fade(WHITE, 0.5f));
+
+    DrawText("[T] Save trace", x + 5, graphBottom + 5, 10, GRAY);
+}
+
+// Function to write the history as trace events: zones as spans, worker totals as counters
+bool ExportProfilerTrace(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Failed to write profiler trace: %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Main thread\"}}");
+
+    for (int i = 0; i < profiler.completed; i++) {
+        const ProfileFrame *frame = GetProfileFrame(i);
+        double frameStart = frame->frameStart * 1000000.0;
+
+        fprintf(file, ",\n{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}",
+                frameStart, frame->frameTime * 1000.0);
+
+        for (int k = 0; k < frame->spanCount; k++) {
+            const ProfileSpan *span = &frame->spans[k];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}",
+                    zoneNames[span->zone], frameStart + span->start * 1000.0, span->duration * 1000.0);
+        }
+        for (int zone = PROFILE_ZONE_MAIN_COUNT; zone < PROFILE_ZONE_COUNT; zone++) {
+            fprintf(file, ",\n{\"name\":\"%s (ms)\",\"ph\":\"C\",\"pid\":1,\"ts\":%.1f,\"args\":{\"value\":%.3f}}",
+                    zoneNames[zone], frameStart, frame->duration[zone]);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    bool ok = (fclose(file) == 0);
+    if (ok) printf("Saved profiler trace: %s (%d frames)\n", path, profiler.completed);
+
+    return ok;
+}
@@ -0,0 +1,60 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+// Profiler settings
+#define PROFILER_HISTORY 240               // Frames kept for statistics, the graph and trace export
+#define PROFILER_MAX_SPANS 32              // Zone entries recorded per frame for the trace
+#define PROFILER_OVERLAY_WIDTH 250
+#define PROFILER_GRAPH_HEIGHT 60
+#define PROFILER_GRAPH_MAX_MS 50.0f        // Frame time at the top of the graph
+#define PROFILER_TARGET_MS (1000.0f / 60.0f)
+#define PROFILER_TRACE_FILE "profile-trace.json"
+
+// Timed phases of a frame
+// Main-thread zones are measured with Begin/EndProfileZone and appear as spans in the trace;
+// worker zones are CPU time summed over all job threads and reported with AddProfileZoneTime
+typedef enum {
+    PROFILE_ZONE_UNIT_SYNC,        // Waiting for the previous unit step
+    PROFILE_ZONE_SCENE,            // Background build hand-over and collision re-bakes
+    PROFILE_ZONE_INPUT,
+    PROFILE_ZONE_CAMERA,           // Camera update and frustum
+    PROFILE_ZONE_RAYS,             // Mouse picking and unit commands
+    PROFILE_ZONE_UNIT_STEP,        // Grid rebuild, job launch and unit culling
+    PROFILE_ZONE_DRAW_3D,
+    PROFILE_ZONE_DRAW_UI,
+    PROFILE_ZONE_PRESENT,          // EndDrawing: buffer swap and frame limiter wait
+    PROFILE_ZONE_MAIN_COUNT,
+    PROFILE_ZONE_UNIT_JOBS = PROFILE_ZONE_MAIN_COUNT,  // Unit simulation, all threads
+    PROFILE_ZONE_GROUND_RAYS,      // Ground-following queries inside the unit jobs
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+// Start recording a frame (call once at the top of the main loop)
+void BeginProfileFrame(void);
+
+// Close the frame and add it to the history
+void EndProfileFrame(void);
+
+// Time a main-thread zone, a zone entered several times per frame adds up
+void BeginProfileZone(ProfileZone zone);
+void EndProfileZone(ProfileZone zone);
+
+// Add time measured elsewhere (worker threads) to the current frame, in seconds
+void AddProfileZoneTime(ProfileZone zone, double seconds);
+
+// Times of the last finished frame, in milliseconds
+float GetProfileFrameTime(void);
+float GetProfileZoneTime(ProfileZone zone);
+
+// Display name of a zone
+const char *GetProfileZoneName(ProfileZone zone);
+
+// Draw per-zone min/avg/p99 and the frame-time graph
+void DrawProfilerOverlay(int x, int y);
+
+// Write the recorded history as Chrome trace event JSON (chrome://tracing, Perfetto)
+bool ExportProfilerTrace(const char *path);
+
+#endif // PROFILER_H
@@ -0,0 +1,386 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+// Ray query microbenchmark: throughput of the collision backends for the ray shapes the viewer casts
+#include <raylib.h>
+#include <raymath.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "collision.h"
+#include "raykernel.h"
+#include "jobs.h"
+
+// Benchmark settings
+#define RAYBENCH_RAY_COUNT 4096            // Distinct rays per shape, replayed until the time budget is used
+#define RAYBENCH_DEFAULT_SECONDS 0.25      // Time budget of each backend and shape
+#define RAYBENCH_BATCH 64                  // Rays between clock reads on one thread
+#define RAYBENCH_THREAD_BATCH 1024         // Rays per parallel-for on the job threads
+#define RAYBENCH_RANDOM_SEED 1234u
+#define RAYBENCH_BRUTE_FORCE_MAX_TRIANGLES 200000  // Larger models skip the backends without the BVH
+
+// Procedural terrain, the same 50x50 landscape at every resolution
+#define RAYBENCH_TERRAIN_SIZE 50.0f
+#define RAYBENCH_TERRAIN_TILE 64           // Quads per mesh side, keeps indices within 16 bits
+static const int terrainResolutions[] = { 16, 64, 256, 512 };  // Quads per terrain side
+
+// Ray shapes, with the distances main.c uses
+#define RAYBENCH_FORWARD_DISTANCE 1.5f     // UNIT_AVOIDANCE_DISTANCE
+#define RAYBENCH_FORWARD_HEIGHT 0.2f       // UNIT_HEIGHT_OFFSET
+#define RAYBENCH_QUERY_DISTANCE 10000.0f
+
+// Query shapes cast by the viewer
+typedef enum {
+    RAYBENCH_SHAPE_FORWARD,    // Unit look-ahead: short any-hit ray
+    RAYBENCH_SHAPE_GROUND,     // GetGroundHeight: downward closest hit
+    RAYBENCH_SHAPE_PICKING,    // GetGroundPositionFromMouse: camera ray closest hit
+    RAYBENCH_SHAPE_COUNT
+} RayBenchShape;
+
+// Ways of answering a ray query
+typedef enum {
+    RAYBENCH_BACKEND_SCALAR,   // Every triangle, one at a time
+    RAYBENCH_BACKEND_BRUTE,    // Every triangle, RAYKERNEL_WIDTH at a time
+    RAYBENCH_BACKEND_BVH,
+    RAYBENCH_BACKEND_PACKET,   // BVH with RAY_PACKET_SIZE rays per traversal (closest hit only)
+    RAYBENCH_BACKEND_THREADS,  // BVH on every job thread
+    RAYBENCH_BACKEND_COUNT
+} RayBenchBackend;
+
+static const char *shapeNames[RAYBENCH_SHAPE_COUNT] = { "forward", "ground", "picking" };
+static const char *backendNames[RAYBENCH_BACKEND_COUNT] = { "scalar", "brute", "bvh", "packet", "threads" };
+
+// Rays of one shape and the settings they are cast with
+typedef struct {
+    const ModelCollision *collision;
+    Ray rays[RAYBENCH_RAY_COUNT];
+    float maxDistance;
+    CollisionQueryMode mode;
+    int hits;                  // Hits of the last run, summed atomically by the threaded backend
+} RayBenchQuery;
+
+// Arguments of one threaded run
+typedef struct {
+    RayBenchQuery *query;
+    int first;                 // Ray index of parallel-for item 0
+} RayBenchJob;
+
+static unsigned int randomState = RAYBENCH_RANDOM_SEED;
+
+// Function to get a repeatable random value in [0, 1)
+static float GetBenchRandom(void) {
+    randomState = randomState * 1103515245u + 12345u;
+    return (float)((randomState >> 8) & 0xFFFF) / 65536.0f;
+}
+
+// Function to read a monotonic clock in seconds
+static double GetBenchTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// Function to get the terrain height: rolling hills with terraced steps that act as walls
+static float GetTerrainHeight(float x, float z) {
+    float hills = 2.0f * sinf(x * 0.21f) * cosf(z * 0.17f) + 0.7f * sinf(x * 0.53f + z * 0.41f);
+    return hills + floorf(hills * 1.5f) * 0.5f;
+}
+
+// Function to build a terrain model of resolution x resolution quads, split into tile meshes
+// Only the CPU arrays are filled, nothing is uploaded
+static Model GenTerrainModel(int resolution) {
+    Model model = {0};
+    model.transform = MatrixIdentity();
+
+    int tiles = (resolution + RAYBENCH_TERRAIN_TILE - 1) / RAYBENCH_TERRAIN_TILE;
+    model.meshes = (Mesh *)calloc(tiles * tiles, sizeof(Mesh));
+    if (model.meshes == NULL) return model;
+    model.meshCount = tiles * tiles;
+
+    float cell = RAYBENCH_TERRAIN_SIZE / resolution;
+    float origin = -RAYBENCH_TERRAIN_SIZE * 0.5f;
+
+    for (int tz = 0; tz < tiles; tz++) {
+        for (int tx = 0; tx < tiles; tx++) {
+            int quadsX = resolution - tx * RAYBENCH_TERRAIN_TILE;
+            int quadsZ = resolution - tz * RAYBENCH_TERRAIN_TILE;
+            if (quadsX > RAYBENCH_TERRAIN_TILE) quadsX = RAYBENCH_TERRAIN_TILE;
+            if (quadsZ > RAYBENCH_TERRAIN_TILE) quadsZ = RAYBENCH_TERRAIN_TILE;
+
+            Mesh *mesh = &model.meshes[tz * tiles + tx];
+            mesh->vertexCount = (quadsX + 1) * (quadsZ + 1);
+            mesh->triangleCount = quadsX * quadsZ * 2;
+            mesh->vertices = (float *)malloc(sizeof(float) * 3 * mesh->vertexCount);
+            mesh->indices = (unsigned short *)malloc(sizeof(unsigned short) * 3 * mesh->triangleCount);
+            if (mesh->vertices == NULL || mesh->indices == NULL) {
+                free(mesh->vertices);
+                free(mesh->indices);
+                memset(mesh, 0, sizeof(*mesh));
+                continue;
+            }
+
+            for (int z = 0; z <= quadsZ; z++) {
+                for (int x = 0; x <= quadsX; x++) {
+                    float wx = origin + (tx * RAYBENCH_TERRAIN_TILE + x) * cell;
+                    float wz = origin + (tz * RAYBENCH_TERRAIN_TILE + z) * cell;
+                    float *v = &mesh->vertices[(z * (quadsX + 1) + x) * 3];
+                    v[0] = wx;
+                    v[1] = GetTerrainHeight(wx, wz);
+                    v[2] = wz;
+                }
+            }
+
+            unsigned short *index = mesh->indices;
+            for (int z = 0; z < quadsZ; z++) {
+                for (int x = 0; x < quadsX; x++) {
+                    unsigned short a = (unsigned short)(z * (quadsX + 1) + x);
+                    unsigned short b = (unsigned short)(a + 1);
+                    unsigned short c = (unsigned short)(a + quadsX + 1);
+                    unsigned short d = (unsigned short)(c + 1);
+                    *index++ = a; *index++ = c; *index++ = b;
+                    *index++ = b; *index++ = c; *index++ = d;
+                }
+            }
+        }
+    }
+
+    return model;
+}
+
+// Function to free a model built by GenTerrainModel
+static void UnloadTerrainModel(Model *model) {
+    for (int i = 0; i < model->meshCount; i++) {
+        free(model->meshes[i].vertices);
+        free(model->meshes[i].indices);
+    }
+    free(model->meshes);
+    memset(model, 0, sizeof(*model));
+}
+
+// Function to generate the rays of one shape over the model bounds
+static void GenRayBenchQuery(RayBenchQuery *query, const ModelCollision *collision, RayBenchShape shape) {
+    BoundingBox bounds = collision->info.bounds;
+    Vector3 size = Vector3Subtract(bounds.max, bounds.min);
+    Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+    float maxDimension = fmaxf(size.x, fmaxf(size.y, size.z));
+
+    query->collision = collision;
+    query->maxDistance = (shape == RAYBENCH_SHAPE_FORWARD) ? RAYBENCH_FORWARD_DISTANCE : RAYBENCH_QUERY_DISTANCE;
+    query->mode = (shape == RAYBENCH_SHAPE_FORWARD) ? COLLISION_QUERY_ANY_HIT : COLLISION_QUERY_CLOSEST_HIT;
+
+    for (int i = 0; i < RAYBENCH_RAY_COUNT; i++) {
+        Vector3 point = {
+            bounds.min.x + GetBenchRandom() * size.x,
+            bounds.max.y + 1.0f,
+            bounds.min.z + GetBenchRandom() * size.z
+        };
+        Ray down = { point, (Vector3){ 0.0f, -1.0f, 0.0f } };
+
+        if (shape == RAYBENCH_SHAPE_GROUND) {
+            query->rays[i] = down;
+        } else if (shape == RAYBENCH_SHAPE_FORWARD) {
+            // Level ray from just above the ground, like a unit looking ahead
+            CollisionHit ground = RaycastModelCollision(collision, down, RAYBENCH_QUERY_DISTANCE, COLLISION_QUERY_CLOSEST_HIT);
+            float angle = GetBenchRandom() * 2.0f * PI;
+            point.y = (ground.hit ? ground.point.y : bounds.min.y) + RAYBENCH_FORWARD_HEIGHT;
+            query->rays[i] = (Ray){ point, (Vector3){ cosf(angle), 0.0f, sinf(angle) } };
+        } else {
+            // Orbit camera at the viewer's default pitch and distance, aimed at a point on the scene
+            float angle = GetBenchRandom() * 2.0f * PI;
+            float pitch = PI * 0.15f;
+            Vector3 eye = {
+                center.x + 2.0f * maxDimension * cosf(pitch) * sinf(angle),
+                center.y + 2.0f * maxDimension * sinf(pitch),
+                center.z + 2.0f * maxDimension * cosf(pitch) * cosf(angle)
+            };
+            point.y = center.y;
+            query->rays[i] = (Ray){ eye, Vector3Normalize(Vector3Subtract(point, eye)) };
+        }
+    }
+}
+
+// Function to test one ray against every triangle with the scalar intersection
+static bool RaycastScalar(const RayBenchQuery *query, Ray ray) {
+    const TriangleSoup *soup = &query->collision->soup;
+    float closest = query->maxDistance;
+    bool hit = false;
+
+    for (int t = 0; t < soup->count; t++) {
+        float distance;
+        if (IntersectRayTriangle(soup, t, ray, &distance) && distance < closest) {
+            closest = distance;
+            hit = true;
+            if (query->mode == COLLISION_QUERY_ANY_HIT) break;
+        }
+    }
+    return hit;
+}
+
+// Function to cast rays [first, first + count) with a single-threaded backend, returns the hits
+static int CastRayBenchRays(const RayBenchQuery *query, RayBenchBackend backend, int first, int count) {
+    const ModelCollision *collision = query->collision;
+    int hits = 0;
+
+    if (backend == RAYBENCH_BACKEND_PACKET) {
+        CollisionHit results[RAY_PACKET_SIZE];
+        for (int r = 0; r < count; r += RAY_PACKET_SIZE) {
+            int n = (count - r < RAY_PACKET_SIZE) ? count - r : RAY_PACKET_SIZE;
+            RaycastModelCollisionPacket(collision, &query->rays[first + r], n, query->maxDistance, results);
+            for (int k = 0; k < n; k++) hits += results[k].hit;
+        }
+        return hits;
+    }
+
+    for (int r = first; r < first + count; r++) {
+        Ray ray = query->rays[r];
+        if (backend == RAYBENCH_BACKEND_SCALAR) {
+            hits += RaycastScalar(query, ray);
+        } else if (backend == RAYBENCH_BACKEND_BRUTE) {
+            hits += RaycastModelCollisionBruteForce(collision, ray, query->maxDistance, query->mode).hit;
+        } else {
+            hits += RaycastModelCollision(collision, ray, query->maxDistance, query->mode).hit;
+        }
+    }
+    return hits;
+}
+
+// Function to run one chunk of a threaded batch
+static void CastRayBenchJob(void *userData, int first, int count) {
+    RayBenchJob *job = (RayBenchJob *)userData;
+    int hits = CastRayBenchRays(job->query, RAYBENCH_BACKEND_BVH, job->first + first, count);
+    ATOMIC_FETCH_ADD(&job->query->hits, hits);
+}
+
+// Function to measure one backend, returns rays per second and stores the hit ratio of one pass
+static double MeasureRayBench(RayBenchQuery *query, RayBenchBackend backend, JobSystem *jobs, double seconds, float *hitRatio) {
+    int batch = (backend == RAYBENCH_BACKEND_THREADS) ? RAYBENCH_THREAD_BATCH : RAYBENCH_BATCH;
+    long long rays = 0;
+    int passHits = 0;
+    int cursor = 0;
+
+    query->hits = 0;
+    double start = GetBenchTime();
+    double elapsed = 0.0;
+
+    // Always finish one whole pass so the hit ratio covers every ray
+    while (elapsed < seconds || rays < RAYBENCH_RAY_COUNT) {
+        if (backend == RAYBENCH_BACKEND_THREADS) {
+            RayBenchJob job = { query, cursor };
+            RunParallelFor(jobs, batch, RAYBENCH_BATCH, CastRayBenchJob, &job);
+        } else {
+            query->hits += CastRayBenchRays(query, backend, cursor, batch);
+        }
+
+        rays += batch;
+        cursor += batch;
+        if (cursor == RAYBENCH_RAY_COUNT) {
+            if (rays == RAYBENCH_RAY_COUNT) passHits = query->hits;
+            cursor = 0;
+        }
+        elapsed = GetBenchTime() - start;
+    }
+
+    *hitRatio = (float)passHits / RAYBENCH_RAY_COUNT;
+    return (double)rays / elapsed;
+}
+
+// Function to benchmark every shape and backend on one model
+static void RunModelBench(Model model, const char *name, JobSystem *jobs, double seconds) {
+    double buildStart = GetBenchTime();
+    ModelCollision collision = LoadModelCollision(model);
+    double buildTime = GetBenchTime() - buildStart;
+
+    if (collision.nodes == NULL) {
+        printf("Failed to build collision for %s\n", name);
+        UnloadModelCollision(&collision);
+        return;
+    }
+
+    printf("\n%s: %d triangles, %d meshes, BVH %d nodes built in %.1f ms\n",
+           name, collision.soup.count, collision.info.meshCount, collision.nodeCount, buildTime * 1000.0);
+    printf("%-8s", "shape");
+    for (int b = 0; b < RAYBENCH_BACKEND_COUNT; b++) printf("%12s", backendNames[b]);
+    printf("%8s\n", "hits");
+
+    static RayBenchQuery query;
+    for (int s = 0; s < RAYBENCH_SHAPE_COUNT; s++) {
+        GenRayBenchQuery(&query, &collision, (RayBenchShape)s);
+        printf("%-8s", shapeNames[s]);
+
+        // Every backend must agree on which rays hit
+        float firstRatio = -1.0f;
+        bool agree = true;
+        for (int b = 0; b < RAYBENCH_BACKEND_COUNT; b++) {
+            bool bruteForce = (b == RAYBENCH_BACKEND_SCALAR || b == RAYBENCH_BACKEND_BRUTE);
+            if ((b == RAYBENCH_BACKEND_PACKET && query.mode == COLLISION_QUERY_ANY_HIT) ||
+                (bruteForce && collision.soup.count > RAYBENCH_BRUTE_FORCE_MAX_TRIANGLES)) {
+                printf("%12s", "-");
+                continue;
+            }
+
+            float ratio;
+            double raysPerSecond = MeasureRayBench(&query, (RayBenchBackend)b, jobs, seconds, &ratio);
+            printf("%12.3f", raysPerSecond / 1e6);
+            fflush(stdout);
+
+            if (firstRatio < 0.0f) firstRatio = ratio;
+            if (ratio != firstRatio) agree = false;
+        }
+        printf("%7.0f%%%s\n", firstRatio * 100.0f, agree ? "" : "  (backends disagree)");
+    }
+
+    UnloadModelCollision(&collision);
+}
+
+int main(int argc, char *argv[]) {
+    const char *modelPath = NULL;
+    double seconds = RAYBENCH_DEFAULT_SECONDS;
+    int workerThreads = -1;  // Negative = one per extra CPU core
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            workerThreads = atoi(argv[++i]);
+        } else {
+            modelPath = argv[i];
+        }
+    }
+
+    JobSystem jobs;
+    InitJobSystem(&jobs, workerThreads);
+    printf("Ray query throughput in million rays per second (%s kernel, %d job threads + main thread)\n",
+           RAYKERNEL_NAME, jobs.threadCount);
+    printf("scalar/brute test every triangle, packet traces %d rays together, threads runs bvh on all threads\n",
+           RAY_PACKET_SIZE);
+
+    if (modelPath != NULL) {
+        // Model loading uploads meshes, so it needs a (hidden) window
+        SetTraceLogLevel(LOG_WARNING);
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(64, 64, "raybench");
+
+        Model model = LoadModel(modelPath);
+        if (model.meshCount == 0) {
+            printf("Failed to load model: %s\n", modelPath);
+        } else {
+            model.transform = MatrixIdentity();
+            RunModelBench(model, GetFileName(modelPath), &jobs, seconds);
+        }
+
+        UnloadModel(model);
+        CloseWindow();
+    } else {
+        int count = (int)(sizeof(terrainResolutions) / sizeof(terrainResolutions[0]));
+        for (int i = 0; i < count; i++) {
+            Model terrain = GenTerrainModel(terrainResolutions[i]);
+            RunModelBench(terrain, TextFormat("Terrain %dx%d", terrainResolutions[i], terrainResolutions[i]), &jobs, seconds);
+            UnloadTerrainModel(&terrain);
+        }
+    }
+
+    CloseJobSystem(&jobs);
+    return 0;
+}
@@ -0,0 +1,280 @@
+#include "raykernel.h"
+#include <raymath.h>
+#include <math.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+// Function to test one ray against one baked triangle (scalar reference path)
+bool IntersectRayTriangle(const TriangleSoup *soup, int index, Ray ray, float *distance) {
+    Vector3 e1 = { soup->e1x[index], soup->e1y[index], soup->e1z[index] };
+    Vector3 e2 = { soup->e2x[index], soup->e2y[index], soup->e2z[index] };
+
+    Vector3 p = Vector3CrossProduct(ray.direction, e2);
+    float det = Vector3DotProduct(e1, p);
+    if (det > -EPSILON && det < EPSILON) return false;
+
+    float invDet = 1.0f / det;
+    Vector3 tv = { ray.position.x - soup->v0x[index], ray.position.y - soup->v0y[index], ray.position.z - soup->v0z[index] };
+    float u = Vector3DotProduct(tv, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    Vector3 q = Vector3CrossProduct(tv, e1);
+    float v = Vector3DotProduct(ray.direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    float t = Vector3DotProduct(e2, q) * invDet;
+    if (t <= EPSILON) return false;
+
+    *distance = t;
+    return true;
+}
+
+#if RAYKERNEL_WIDTH > 1
+
+// Thin wrappers so the kernels below are written once for every instruction set
+// Masks are full-width lanes of all ones (true) or all zeros (false)
+#if defined(__AVX2__)
+typedef __m256 vfloat;
+typedef __m256 vmask;
+static inline vfloat VLoad(const float *p) { return _mm256_loadu_ps(p); }
+static inline vfloat VSet1(float x) { return _mm256_set1_ps(x); }
+static inline void VStore(float *p, vfloat a) { _mm256_storeu_ps(p, a); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat VDiv(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+static inline vmask VLess(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline vmask VLessEqual(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline vmask VGreater(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline vmask VGreaterEqual(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline vmask VAnd(vmask a, vmask b) { return _mm256_and_ps(a, b); }
+static inline vmask VOr(vmask a, vmask b) { return _mm256_or_ps(a, b); }
+static inline vfloat VSelect(vmask m, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, m); }
+static inline int VMaskBits(vmask m) { return _mm256_movemask_ps(m); }
+static inline vmask VLaneLess(int n) {
+    return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+typedef __m128 vfloat;
+typedef __m128 vmask;
+static inline vfloat VLoad(const float *p) { return _mm_loadu_ps(p); }
+static inline vfloat VSet1(float x) { return _mm_set1_ps(x); }
+static inline void VStore(float *p, vfloat a) { _mm_storeu_ps(p, a); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat VDiv(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+static inline vmask VLess(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+static inline vmask VLessEqual(vfloat a, vfloat b) { return _mm_cmple_ps(a, b); }
+static inline vmask VGreater(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+static inline vmask VGreaterEqual(vfloat a, vfloat b) { return _mm_cmpge_ps(a, b); }
+static inline vmask VAnd(vmask a, vmask b) { return _mm_and_ps(a, b); }
+static inline vmask VOr(vmask a, vmask b) { return _mm_or_ps(a, b); }
+static inline vfloat VSelect(vmask m, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline int VMaskBits(vmask m) { return _mm_movemask_ps(m); }
+static inline vmask VLaneLess(int n) {
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(n), _mm_setr_epi32(0, 1, 2, 3)));
+}
+#elif defined(__ARM_NEON)
+typedef float32x4_t vfloat;
+typedef uint32x4_t vmask;
+static inline vfloat VLoad(const float *p) { return vld1q_f32(p); }
+static inline vfloat VSet1(float x) { return vdupq_n_f32(x); }
+static inline void VStore(float *p, vfloat a) { vst1q_f32(p, a); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return vsubq_f32(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__)
+static inline vfloat VDiv(vfloat a, vfloat b) { return vdivq_f32(a, b); }
+#else
+static inline vfloat VDiv(vfloat a, vfloat b) {
+    float x[4], y[4];
+    vst1q_f32(x, a);
+    vst1q_f32(y, b);
+    for (int i = 0; i < 4; i++) x[i] /= y[i];
+    return vld1q_f32(x);
+}
+#endif
+static inline vmask VLess(vfloat a, vfloat b) { return vcltq_f32(a, b); }
+static inline vmask VLessEqual(vfloat a, vfloat b) { return vcleq_f32(a, b); }
+static inline vmask VGreater(vfloat a, vfloat b) { return vcgtq_f32(a, b); }
+static inline vmask VGreaterEqual(vfloat a, vfloat b) { return vcgeq_f32(a, b); }
+static inline vmask VAnd(vmask a, vmask b) { return vandq_u32(a, b); }
+static inline vmask VOr(vmask a, vmask b) { return vorrq_u32(a, b); }
+static inline vfloat VSelect(vmask m, vfloat a, vfloat b) { return vbslq_f32(m, a, b); }
+static inline int VMaskBits(vmask m) {
+    static const int32_t shifts[4] = { 0, 1, 2, 3 };
+    uint32x4_t bits = vshlq_u32(vshrq_n_u32(m, 31), vld1q_s32(shifts));
+    return (int)(vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1) | vgetq_lane_u32(bits, 2) | vgetq_lane_u32(bits, 3));
+}
+static inline vmask VLaneLess(int n) {
+    static const uint32_t lanes[4] = { 0, 1, 2, 3 };
+    return vcltq_u32(vld1q_u32(lanes), vdupq_n_u32((uint32_t)n));
+}
+#endif
+
+// Shared Moller-Trumbore core, operation order matches the scalar path exactly
+// Returns the lanes with a valid hit in (EPSILON, tMax) and the hit distances in t
+static inline vmask IntersectLanes(vfloat ox, vfloat oy, vfloat oz, vfloat dx, vfloat dy, vfloat dz,
+                                   vfloat v0x, vfloat v0y, vfloat v0z,
+                                   vfloat e1x, vfloat e1y, vfloat e1z,
+                                   vfloat e2x, vfloat e2y, vfloat e2z,
+                                   vfloat tMax, vfloat *t) {
+    const vfloat zero = VSet1(0.0f);
+    const vfloat one = VSet1(1.0f);
+    const vfloat eps = VSet1(EPSILON);
+
+    // p = cross(d, e2)
+    vfloat px = VSub(VMul(dy, e2z), VMul(dz, e2y));
+    vfloat py = VSub(VMul(dz, e2x), VMul(dx, e2z));
+    vfloat pz = VSub(VMul(dx, e2y), VMul(dy, e2x));
+
+    vfloat det = VAdd(VAdd(VMul(e1x, px), VMul(e1y, py)), VMul(e1z, pz));
+    vmask valid = VOr(VLessEqual(det, VSet1(-EPSILON)), VGreaterEqual(det, eps));
+    vfloat invDet = VDiv(one, det);
+
+    vfloat tvx = VSub(ox, v0x);
+    vfloat tvy = VSub(oy, v0y);
+    vfloat tvz = VSub(oz, v0z);
+
+    vfloat u = VMul(VAdd(VAdd(VMul(tvx, px), VMul(tvy, py)), VMul(tvz, pz)), invDet);
+    valid = VAnd(valid, VAnd(VGreaterEqual(u, zero), VLessEqual(u, one)));
+
+    // q = cross(tv, e1)
+    vfloat qx = VSub(VMul(tvy, e1z), VMul(tvz, e1y));
+    vfloat qy = VSub(VMul(tvz, e1x), VMul(tvx, e1z));
+    vfloat qz = VSub(VMul(tvx, e1y), VMul(tvy, e1x));
+
+    vfloat v = VMul(VAdd(VAdd(VMul(dx, qx), VMul(dy, qy)), VMul(dz, qz)), invDet);
+    valid = VAnd(valid, VAnd(VGreaterEqual(v, zero), VLessEqual(VAdd(u, v), one)));
+
+    *t = VMul(VAdd(VAdd(VMul(e2x, qx), VMul(e2y, qy)), VMul(e2z, qz)), invDet);
+    valid = VAnd(valid, VAnd(VGreater(*t, eps), VLess(*t, tMax)));
+
+    return valid;
+}
+
+// Function to test one ray against a block of triangles, RAYKERNEL_WIDTH per step
+int IntersectRayTriangles(const TriangleSoup *soup, int first, int count, Ray ray, float maxDistance, float *distance) {
+    const vfloat ox = VSet1(ray.position.x), oy = VSet1(ray.position.y), oz = VSet1(ray.position.z);
+    const vfloat dx = VSet1(ray.direction.x), dy = VSet1(ray.direction.y), dz = VSet1(ray.direction.z);
+
+    float closest = maxDistance;
+    int hitIndex = -1;
+
+    for (int base = first; base < first + count; base += RAYKERNEL_WIDTH) {
+        vfloat t;
+        vmask valid = IntersectLanes(ox, oy, oz, dx, dy, dz,
+                                     VLoad(soup->v0x + base), VLoad(soup->v0y + base), VLoad(soup->v0z + base),
+                                     VLoad(soup->e1x + base), VLoad(soup->e1y + base), VLoad(soup->e1z + base),
+                                     VLoad(soup->e2x + base), VLoad(soup->e2y + base), VLoad(soup->e2z + base),
+                                     VSet1(closest), &t);
+
+        // Lanes past the end of the block belong to other leaves
+        int remaining = first + count - base;
+        if (remaining < RAYKERNEL_WIDTH) valid = VAnd(valid, VLaneLess(remaining));
+
+        int bits = VMaskBits(valid);
+        if (bits == 0) continue;
+
+        float lanes[RAYKERNEL_WIDTH];
+        VStore(lanes, t);
+        for (int lane = 0; lane < RAYKERNEL_WIDTH; lane++) {
+            if ((bits & (1 << lane)) && lanes[lane] < closest) {
+                closest = lanes[lane];
+                hitIndex = base + lane;
+            }
+        }
+    }
+
+    if (hitIndex >= 0) *distance = closest;
+    return hitIndex;
+}
+
+// Function to test a packet of rays against a block of triangles, RAYKERNEL_WIDTH rays per step
+void IntersectRayPacketTriangles(const TriangleSoup *soup, int first, int count, RayPacket *packet) {
+    int fullCount = packet->count - packet->count % RAYKERNEL_WIDTH;
+
+    for (int r = 0; r < fullCount; r += RAYKERNEL_WIDTH) {
+        vfloat ox = VLoad(packet->ox + r), oy = VLoad(packet->oy + r), oz = VLoad(packet->oz + r);
+        vfloat dx = VLoad(packet->dx + r), dy = VLoad(packet->dy + r), dz = VLoad(packet->dz + r);
+        vfloat closest = VLoad(packet->distance + r);
+        int hitIndex[RAYKERNEL_WIDTH];
+        int anyHit = 0;
+
+        for (int i = first; i < first + count; i++) {
+            vfloat t;
+            vmask valid = IntersectLanes(ox, oy, oz, dx, dy, dz,
+                                         VSet1(soup->v0x[i]), VSet1(soup->v0y[i]), VSet1(soup->v0z[i]),
+                                         VSet1(soup->e1x[i]), VSet1(soup->e1y[i]), VSet1(soup->e1z[i]),
+                                         VSet1(soup->e2x[i]), VSet1(soup->e2y[i]), VSet1(soup->e2z[i]),
+                                         closest, &t);
+
+            int bits = VMaskBits(valid);
+            if (bits == 0) continue;
+
+            closest = VSelect(valid, t, closest);
+            for (int lane = 0; lane < RAYKERNEL_WIDTH; lane++) {
+                if (bits & (1 << lane)) hitIndex[lane] = i;
+            }
+            anyHit |= bits;
+        }
+
+        if (anyHit == 0) continue;
+
+        VStore(packet->distance + r, closest);
+        for (int lane = 0; lane < RAYKERNEL_WIDTH; lane++) {
+            if (anyHit & (1 << lane)) packet->hitTriangle[r + lane] = hitIndex[lane];
+        }
+    }
+
+    // Remaining rays that do not fill a vector
+    for (int r = fullCount; r < packet->count; r++) {
+        Ray ray = { { packet->ox[r], packet->oy[r], packet->oz[r] }, { packet->dx[r], packet->dy[r], packet->dz[r] } };
+        float distance;
+        int hit = IntersectRayTriangles(soup, first, count, ray, packet->distance[r], &distance);
+        if (hit >= 0) {
+            packet->distance[r] = distance;
+            packet->hitTriangle[r] = hit;
+        }
+    }
+}
+
+#else
+
+// Scalar fallback for targets without a supported vector unit
+int IntersectRayTriangles(const TriangleSoup *soup, int first, int count, Ray ray, float maxDistance, float *distance) {
+    float closest = maxDistance;
+    int hitIndex = -1;
+
+    for (int i = first; i < first + count; i++) {
+        float t;
+        if (IntersectRayTriangle(soup, i, ray, &t) && t < closest) {
+            closest = t;
+            hitIndex = i;
+        }
+    }
+
+    if (hitIndex >= 0) *distance = closest;
+    return hitIndex;
+}
+
+void IntersectRayPacketTriangles(const TriangleSoup *soup, int first, int count, RayPacket *packet) {
+    for (int r = 0; r < packet->count; r++) {
+        Ray ray = { { packet->ox[r], packet->oy[r], packet->oz[r] }, { packet->dx[r], packet->dy[r], packet->dz[r] } };
+        float distance;
+        int hit = IntersectRayTriangles(soup, first, count, ray, packet->distance[r], &distance);
+        if (hit >= 0) {
+            packet->distance[r] = distance;
+            packet->hitTriangle[r] = hit;
+        }
+    }
+}
+
+#endif
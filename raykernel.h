@@ -0,0 +1,45 @@
+#ifndef RAYKERNEL_H
+#define RAYKERNEL_H
+
+#include <raylib.h>
+#include "collision.h"
+
+// Vector width of the ray-triangle kernels for the instruction set this file is built for
+#if defined(__AVX2__)
+    #define RAYKERNEL_WIDTH 8
+    #define RAYKERNEL_NAME "AVX2"
+#elif defined(__SSE2__) || defined(_M_X64)
+    #define RAYKERNEL_WIDTH 4
+    #define RAYKERNEL_NAME "SSE2"
+#elif defined(__ARM_NEON)
+    #define RAYKERNEL_WIDTH 4
+    #define RAYKERNEL_NAME "NEON"
+#else
+    #define RAYKERNEL_WIDTH 1
+    #define RAYKERNEL_NAME "scalar"
+#endif
+
+// Soup arrays are padded to a multiple of this so full-width loads never run past the end
+#define RAYKERNEL_MAX_WIDTH 8
+
+// Rays in structure-of-arrays layout for the packet kernel
+typedef struct {
+    float *ox, *oy, *oz;       // Origins
+    float *dx, *dy, *dz;       // Directions
+    float *distance;           // In: max distance, out: closest hit distance
+    int *hitTriangle;          // Out: soup index of the closest hit (unchanged if none)
+    int count;
+} RayPacket;
+
+// Scalar Moller-Trumbore against one soup triangle (same rules as GetRayCollisionTriangle)
+bool IntersectRayTriangle(const TriangleSoup *soup, int index, Ray ray, float *distance);
+
+// Test one ray against count consecutive soup triangles, RAYKERNEL_WIDTH at a time
+// Returns the soup index of the closest hit nearer than maxDistance, or -1
+int IntersectRayTriangles(const TriangleSoup *soup, int first, int count, Ray ray, float maxDistance, float *distance);
+
+// Test every ray of a packet against count consecutive soup triangles, RAYKERNEL_WIDTH rays at a time
+// Rays that hit closer than their current distance get distance and hitTriangle updated
+void IntersectRayPacketTriangles(const TriangleSoup *soup, int first, int count, RayPacket *packet);
+
+#endif // RAYKERNEL_H
@@ -0,0 +1,323 @@
+#include "scenecache.h"
+#include "raykernel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// FNV-1a constants, applied to 64-bit words instead of bytes
+#define SCENE_CACHE_HASH_BASIS 0xcbf29ce484222325ull
+#define SCENE_CACHE_HASH_PRIME 0x100000001b3ull
+
+// Byte range of one array in the file
+typedef struct {
+    uint64_t offset;           // Multiple of SCENE_CACHE_ALIGNMENT
+    uint64_t size;
+} SceneCacheSection;
+
+// Sections in file order
+enum {
+    SCENE_SECTION_MESHES,      // MeshInfo[meshCount]
+    SCENE_SECTION_SOUP,        // TriangleSoup buffer, GetTriangleSoupBufferSize(triangleCount) bytes
+    SCENE_SECTION_NODES,       // BVHNode[nodeCount]
+    SCENE_SECTION_HEIGHTS,     // float[width * depth]
+    SCENE_SECTION_FLAGS,       // unsigned char[width * depth]
+    SCENE_SECTION_COUNT
+};
+
+// Fixed-size header at the start of the file, every section can be mapped in place
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t soupPadding;      // RAYKERNEL_MAX_WIDTH the soup arrays were padded to
+    uint32_t headerSize;
+
+    // SceneCacheKey, stored field by field so struct padding never reaches the file
+    uint64_t sourceHash;
+    int64_t sourceSize;
+    Matrix transform;
+    int32_t useHeightfield;
+    float requestedCellSize;
+    int32_t collisionLod;
+
+    // ModelInfo totals
+    BoundingBox bounds;
+    int32_t meshCount;
+    int32_t totalTriangles;
+    int32_t totalVertices;
+
+    // Acceleration structure
+    int32_t triangleCount;
+    int32_t nodeCount;
+
+    // Heightfield
+    float originX;
+    float originZ;
+    float cellSize;
+    int32_t width;
+    int32_t depth;
+    int32_t multiLayerSamples;
+
+    SceneCacheSection sections[SCENE_SECTION_COUNT];
+} SceneCacheHeader;
+
+// Function to hash a whole file, word by word with a fold so high bits reach the low ones
+unsigned long long HashSceneData(const unsigned char *data, size_t size) {
+    uint64_t hash = SCENE_CACHE_HASH_BASIS ^ (uint64_t)size;
+    size_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * SCENE_CACHE_HASH_PRIME;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * SCENE_CACHE_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+// Function to build the cache file name next to the model
+char *GetSceneCachePath(const char *modelPath) {
+    size_t length = strlen(modelPath);
+    size_t extension = strlen(SCENE_CACHE_EXTENSION);
+
+    char *path = (char *)malloc(length + extension + 1);
+    if (path == NULL) return NULL;
+
+    memcpy(path, modelPath, length);
+    memcpy(path + length, SCENE_CACHE_EXTENSION, extension + 1);
+    return path;
+}
+
+// Function to check a header against the key of the current run
+static bool IsSceneCacheCurrent(const SceneCacheHeader *header, SceneCacheKey key) {
+    return header->magic == SCENE_CACHE_MAGIC &&
+           header->version == SCENE_CACHE_VERSION &&
+           header->soupPadding == RAYKERNEL_MAX_WIDTH &&
+           header->headerSize == sizeof(SceneCacheHeader) &&
+           header->sourceHash == key.sourceHash &&
+           header->sourceSize == key.sourceSize &&
+           header->meshCount == key.meshCount &&
+           memcmp(&header->transform, &key.transform, sizeof(Matrix)) == 0 &&
+           header->useHeightfield == (key.useHeightfield ? 1 : 0) &&
+           header->requestedCellSize == key.heightfieldCellSize &&
+           header->collisionLod == key.collisionLod;
+}
+
+// Function to read one section into memory allocated by the caller
+static bool ReadSceneSection(FILE *file, const SceneCacheSection *section, void *data, size_t expectedSize) {
+    if (section->size != expectedSize) return false;
+    if (expectedSize == 0) return true;
+    if (fseek(file, (long)section->offset, SEEK_SET) != 0) return false;
+
+    return fread(data, 1, expectedSize, file) == expectedSize;
+}
+
+// Function to check that every node and triangle read from a cache stays inside the arrays it indexes
+// Children must come after their parent (depth-first order), so traversal always ends within the stack size
+static bool IsSceneCacheCollisionValid(const ModelCollision *collision) {
+    const TriangleSoup *soup = &collision->soup;
+    for (int i = 0; i < soup->count; i++) {
+        if (soup->meshIndex[i] < 0 || soup->meshIndex[i] >= collision->info.meshCount) return false;
+    }
+    if (collision->nodeCount == 0) return true;
+
+    int *depth = (int *)calloc((size_t)collision->nodeCount, sizeof(int));
+    if (depth == NULL) return false;
+
+    bool valid = true;
+    for (int i = 0; i < collision->nodeCount && valid; i++) {
+        const BVHNode *node = &collision->nodes[i];
+        if (node->count > 0) {
+            valid = node->rightOrFirst >= 0 && node->count <= soup->count - node->rightOrFirst;
+            continue;
+        }
+
+        int right = node->rightOrFirst;
+        valid = node->count == 0 && i + 1 < collision->nodeCount && right > i && right < collision->nodeCount &&
+                depth[i] + 1 < BVH_TRAVERSAL_STACK_SIZE;
+        if (!valid) break;
+        if (depth[i + 1] < depth[i] + 1) depth[i + 1] = depth[i] + 1;
+        if (depth[right] < depth[i] + 1) depth[right] = depth[i] + 1;
+    }
+
+    free(depth);
+    return valid;
+}
+
+// Function to load a cache, every size is checked against the header counts before trusting it
+bool LoadSceneCache(const char *path, SceneCacheKey key, ModelCollision *collision, Heightfield *heightfield) {
+    memset(collision, 0, sizeof(*collision));
+    memset(heightfield, 0, sizeof(*heightfield));
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return false;
+
+    SceneCacheHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || !IsSceneCacheCurrent(&header, key)) {
+        fclose(file);
+        return false;
+    }
+
+    if (header.meshCount < 0 || header.triangleCount < 0 || header.nodeCount < 0 ||
+        header.width < 0 || header.depth < 0) {
+        printf("Ignoring damaged scene cache: %s\n", path);
+        fclose(file);
+        return false;
+    }
+
+    size_t sampleCount = (size_t)header.width * (size_t)header.depth;
+    collision->transform = header.transform;
+    collision->info.meshCount = header.meshCount;
+    collision->info.bounds = header.bounds;
+    collision->info.totalTriangles = header.totalTriangles;
+    collision->info.totalVertices = header.totalVertices;
+    collision->info.meshes = (MeshInfo *)calloc((size_t)header.meshCount + 1, sizeof(MeshInfo));
+    collision->nodes = (BVHNode *)malloc(sizeof(BVHNode) * ((size_t)header.nodeCount + 1));
+    collision->nodeCount = header.nodeCount;
+    heightfield->heights = (float *)malloc(sizeof(float) * (sampleCount + 1));
+    heightfield->flags = (unsigned char *)malloc(sampleCount + 1);
+
+    bool ok = collision->info.meshes != NULL && collision->nodes != NULL &&
+              heightfield->heights != NULL && heightfield->flags != NULL &&
+              AllocTriangleSoup(&collision->soup, header.triangleCount);
+
+    ok = ok && ReadSceneSection(file, &header.sections[SCENE_SECTION_MESHES], collision->info.meshes,
+                                sizeof(MeshInfo) * (size_t)header.meshCount);
+    ok = ok && ReadSceneSection(file, &header.sections[SCENE_SECTION_SOUP], collision->soup.buffer,
+                                GetTriangleSoupBufferSize(header.triangleCount));
+    ok = ok && ReadSceneSection(file, &header.sections[SCENE_SECTION_NODES], collision->nodes,
+                                sizeof(BVHNode) * (size_t)header.nodeCount);
+    ok = ok && ReadSceneSection(file, &header.sections[SCENE_SECTION_HEIGHTS], heightfield->heights,
+                                sizeof(float) * sampleCount);
+    ok = ok && ReadSceneSection(file, &header.sections[SCENE_SECTION_FLAGS], heightfield->flags, sampleCount);
+    fclose(file);
+
+    // A damaged file can still have the right sizes, the indices are checked before any ray follows them
+    ok = ok && IsSceneCacheCollisionValid(collision);
+
+    if (!ok) {
+        printf("Ignoring damaged scene cache: %s\n", path);
+        UnloadModelCollision(collision);
+        UnloadHeightfield(heightfield);
+        memset(collision, 0, sizeof(*collision));
+        return false;
+    }
+
+    // An empty grid keeps the arrays NULL, like LoadHeightfield does
+    if (sampleCount > 0) {
+        heightfield->originX = header.originX;
+        heightfield->originZ = header.originZ;
+        heightfield->cellSize = header.cellSize;
+        heightfield->width = header.width;
+        heightfield->depth = header.depth;
+        heightfield->multiLayerSamples = header.multiLayerSamples;
+    } else {
+        UnloadHeightfield(heightfield);
+    }
+
+    return true;
+}
+
+// Function to write one section, padding the file up to its aligned offset first
+static bool WriteSceneSection(FILE *file, const SceneCacheSection *section, const void *data) {
+    static const unsigned char zeros[SCENE_CACHE_ALIGNMENT] = {0};
+
+    long position = ftell(file);
+    if (position < 0 || (uint64_t)position > section->offset) return false;
+
+    size_t padding = (size_t)(section->offset - (uint64_t)position);
+    if (padding > 0 && fwrite(zeros, 1, padding, file) != padding) return false;
+    if (section->size == 0) return true;
+
+    return fwrite(data, 1, (size_t)section->size, file) == section->size;
+}
+
+// Function to write a cache file atomically, a crash mid-write leaves only the temporary file behind
+bool SaveSceneCache(const char *path, SceneCacheKey key, const ModelCollision *collision, const Heightfield *heightfield) {
+    SceneCacheHeader header;
+    memset(&header, 0, sizeof(header));
+
+    header.magic = SCENE_CACHE_MAGIC;
+    header.version = SCENE_CACHE_VERSION;
+    header.soupPadding = RAYKERNEL_MAX_WIDTH;
+    header.headerSize = sizeof(SceneCacheHeader);
+    header.sourceHash = key.sourceHash;
+    header.sourceSize = key.sourceSize;
+    header.transform = key.transform;
+    header.useHeightfield = key.useHeightfield ? 1 : 0;
+    header.requestedCellSize = key.heightfieldCellSize;
+    header.collisionLod = key.collisionLod;
+
+    header.bounds = collision->info.bounds;
+    header.meshCount = collision->info.meshCount;
+    header.totalTriangles = collision->info.totalTriangles;
+    header.totalVertices = collision->info.totalVertices;
+    header.triangleCount = collision->soup.count;
+    header.nodeCount = collision->nodeCount;
+
+    header.originX = heightfield->originX;
+    header.originZ = heightfield->originZ;
+    header.cellSize = heightfield->cellSize;
+    header.width = heightfield->width;
+    header.depth = heightfield->depth;
+    header.multiLayerSamples = heightfield->multiLayerSamples;
+
+    size_t sampleCount = (size_t)heightfield->width * (size_t)heightfield->depth;
+    const void *data[SCENE_SECTION_COUNT] = {
+        collision->info.meshes, collision->soup.buffer, collision->nodes, heightfield->heights, heightfield->flags
+    };
+    uint64_t sizes[SCENE_SECTION_COUNT] = {
+        sizeof(MeshInfo) * (uint64_t)collision->info.meshCount,
+        (collision->soup.buffer != NULL) ? GetTriangleSoupBufferSize(collision->soup.count) : 0,
+        sizeof(BVHNode) * (uint64_t)collision->nodeCount,
+        sizeof(float) * (uint64_t)sampleCount,
+        (uint64_t)sampleCount
+    };
+
+    // A collision that failed to allocate has nothing worth caching
+    if (sizes[SCENE_SECTION_SOUP] == 0) return false;
+
+    uint64_t offset = sizeof(SceneCacheHeader);
+    for (int i = 0; i < SCENE_SECTION_COUNT; i++) {
+        offset = (offset + SCENE_CACHE_ALIGNMENT - 1) / SCENE_CACHE_ALIGNMENT * SCENE_CACHE_ALIGNMENT;
+        header.sections[i].offset = offset;
+        header.sections[i].size = sizes[i];
+        offset += sizes[i];
+    }
+
+    size_t length = strlen(path);
+    char *tempPath = (char *)malloc(length + 5);
+    if (tempPath == NULL) return false;
+    memcpy(tempPath, path, length);
+    memcpy(tempPath + length, ".tmp", 5);
+
+    FILE *file = fopen(tempPath, "wb");
+    if (file == NULL) {
+        printf("Failed to write scene cache: %s\n", tempPath);
+        free(tempPath);
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; i < SCENE_SECTION_COUNT && ok; i++) {
+        ok = WriteSceneSection(file, &header.sections[i], data[i]);
+    }
+    ok = (fclose(file) == 0) && ok;
+
+    // rename does not replace an existing file on Windows
+    if (ok) {
+        remove(path);
+        ok = rename(tempPath, path) == 0;
+    }
+    if (!ok) {
+        printf("Failed to write scene cache: %s\n", path);
+        remove(tempPath);
+    }
+
+    free(tempPath);
+    return ok;
+}
@@ -0,0 +1,39 @@
+#ifndef SCENECACHE_H
+#define SCENECACHE_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "collision.h"
+#include "heightfield.h"
+
+// Scene cache settings
+#define SCENE_CACHE_MAGIC 0x43565447u         // "GTVC" read as a little-endian int
+#define SCENE_CACHE_VERSION 2                 // Bump whenever a cached struct or the bake changes
+#define SCENE_CACHE_ALIGNMENT 64              // Section alignment inside the file
+#define SCENE_CACHE_EXTENSION ".cache"        // Appended to the model path
+
+// Everything the cached data depends on, a cache only loads when all of it matches
+typedef struct {
+    unsigned long long sourceHash;   // HashSceneData of the whole model file
+    long long sourceSize;
+    int meshCount;                   // Meshes raylib produced from the file
+    Matrix transform;                // Model transform the triangles were baked with
+    bool useHeightfield;
+    float heightfieldCellSize;       // Requested cell size (before any coarsening)
+    int collisionLod;                // Mesh LOD the triangles were baked from
+} SceneCacheKey;
+
+// 64-bit content hash of a model file, 8 bytes per step
+unsigned long long HashSceneData(const unsigned char *data, size_t size);
+
+// Path of the cache file that belongs to a model (free with free)
+char *GetSceneCachePath(const char *modelPath);
+
+// Load collision and heightfield from a cache file, returns false if it is missing, stale or damaged
+bool LoadSceneCache(const char *path, SceneCacheKey key, ModelCollision *collision, Heightfield *heightfield);
+
+// Write collision and heightfield to a cache file (written to a temporary file first, then renamed)
+bool SaveSceneCache(const char *path, SceneCacheKey key, const ModelCollision *collision, const Heightfield *heightfield);
+
+#endif // SCENECACHE_H
@@ -0,0 +1,232 @@
+#include "spatialgrid.h"
+#include <raymath.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+// Function to map an integer cell to its hash bucket
+static int GetSpatialGridBucket(const SpatialGrid *grid, int cellX, int cellZ) {
+    unsigned int h = ((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellZ * 19349663u);
+    return (int)(h & (unsigned int)(grid->bucketCount - 1));
+}
+
+// Function to convert a world coordinate to a cell coordinate
+static int GetSpatialGridCell(const SpatialGrid *grid, float value) {
+    return (int)floorf(value * grid->invCellSize);
+}
+
+// Function to create an empty grid
+SpatialGrid LoadSpatialGrid(float cellSize) {
+    SpatialGrid grid = {0};
+
+    grid.cellSize = (cellSize > 0.0f) ? cellSize : 1.0f;
+    grid.invCellSize = 1.0f / grid.cellSize;
+    grid.bucketCount = 1;  // Empty grid, every query sees one empty bucket
+
+    return grid;
+}
+
+// Function to release grid memory
+void UnloadSpatialGrid(SpatialGrid *grid) {
+    free(grid->bucketStart);
+    free(grid->bucketMinY);
+    free(grid->bucketMaxY);
+    free(grid->items);
+    free(grid->positions);
+    free(grid->cellX);
+    free(grid->cellZ);
+    free(grid->scratch);
+
+    *grid = LoadSpatialGrid(grid->cellSize);
+}
+
+// Function to grow the grid arrays, returns false if memory ran out
+static bool ReserveSpatialGrid(SpatialGrid *grid, int itemCount, int bucketCount) {
+    if (itemCount > grid->itemCapacity) {
+        int capacity = (grid->itemCapacity > 0) ? grid->itemCapacity : 256;
+        while (capacity < itemCount) capacity *= 2;
+
+        int *items = (int *)realloc(grid->items, sizeof(int) * capacity);
+        if (items) grid->items = items;
+        Vector3 *positions = (Vector3 *)realloc(grid->positions, sizeof(Vector3) * capacity);
+        if (positions) grid->positions = positions;
+        int *cellX = (int *)realloc(grid->cellX, sizeof(int) * capacity);
+        if (cellX) grid->cellX = cellX;
+        int *cellZ = (int *)realloc(grid->cellZ, sizeof(int) * capacity);
+        if (cellZ) grid->cellZ = cellZ;
+        int *scratch = (int *)realloc(grid->scratch, sizeof(int) * capacity);
+        if (scratch) grid->scratch = scratch;
+
+        if (!items || !positions || !cellX || !cellZ || !scratch) return false;
+        grid->itemCapacity = capacity;
+    }
+
+    if (bucketCount > grid->bucketCapacity) {
+        int *bucketStart = (int *)realloc(grid->bucketStart, sizeof(int) * (bucketCount + 1));
+        if (bucketStart) grid->bucketStart = bucketStart;
+        float *bucketMinY = (float *)realloc(grid->bucketMinY, sizeof(float) * bucketCount);
+        if (bucketMinY) grid->bucketMinY = bucketMinY;
+        float *bucketMaxY = (float *)realloc(grid->bucketMaxY, sizeof(float) * bucketCount);
+        if (bucketMaxY) grid->bucketMaxY = bucketMaxY;
+
+        if (!bucketStart || !bucketMinY || !bucketMaxY) return false;
+        grid->bucketCapacity = bucketCount;
+    }
+
+    return true;
+}
+
+// Function to rebuild the grid with a counting sort over the hash buckets
+void BuildSpatialGrid(SpatialGrid *grid, const int *items, const Vector3 *positions, int count) {
+    int bucketCount = SPATIAL_GRID_MIN_BUCKETS;
+    while (bucketCount < count * SPATIAL_GRID_LOAD_FACTOR) bucketCount *= 2;
+
+    if (!ReserveSpatialGrid(grid, count, bucketCount)) {
+        printf("Failed to allocate spatial grid for %d items\n", count);
+        grid->itemCount = 0;
+        return;
+    }
+
+    grid->itemCount = count;
+    grid->bucketCount = bucketCount;
+
+    // Count items per bucket
+    memset(grid->bucketStart, 0, sizeof(int) * (bucketCount + 1));
+    for (int b = 0; b < bucketCount; b++) {
+        grid->bucketMinY[b] = FLT_MAX;
+        grid->bucketMaxY[b] = -FLT_MAX;
+    }
+    grid->bounds.min = (Vector3){ FLT_MAX, FLT_MAX, FLT_MAX };
+    grid->bounds.max = (Vector3){ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (int i = 0; i < count; i++) {
+        int cellX = GetSpatialGridCell(grid, positions[i].x);
+        int cellZ = GetSpatialGridCell(grid, positions[i].z);
+        int bucket = GetSpatialGridBucket(grid, cellX, cellZ);
+
+        grid->scratch[i] = bucket;
+        grid->bucketStart[bucket + 1]++;
+        grid->bucketMinY[bucket] = fminf(grid->bucketMinY[bucket], positions[i].y);
+        grid->bucketMaxY[bucket] = fmaxf(grid->bucketMaxY[bucket], positions[i].y);
+        grid->bounds.min = Vector3Min(grid->bounds.min, positions[i]);
+        grid->bounds.max = Vector3Max(grid->bounds.max, positions[i]);
+    }
+
+    // Prefix sum turns counts into start offsets
+    for (int b = 0; b < bucketCount; b++) {
+        grid->bucketStart[b + 1] += grid->bucketStart[b];
+    }
+
+    // Scatter, using each bucket start as its write cursor ...
+    for (int i = 0; i < count; i++) {
+        int slot = grid->bucketStart[grid->scratch[i]]++;
+        grid->items[slot] = (items != NULL) ? items[i] : i;
+        grid->positions[slot] = positions[i];
+        grid->cellX[slot] = GetSpatialGridCell(grid, positions[i].x);
+        grid->cellZ[slot] = GetSpatialGridCell(grid, positions[i].z);
+    }
+
+    // ... which leaves every start at the next bucket's start, shift them back
+    for (int b = bucketCount; b > 0; b--) {
+        grid->bucketStart[b] = grid->bucketStart[b - 1];
+    }
+    grid->bucketStart[0] = 0;
+}
+
+// Function to check whether a point lies inside a box
+static bool IsInsideBox(Vector3 p, BoundingBox box) {
+    return p.x >= box.min.x && p.x <= box.max.x &&
+           p.y >= box.min.y && p.y <= box.max.y &&
+           p.z >= box.min.z && p.z <= box.max.z;
+}
+
+// Function to visit every item inside a box
+void VisitSpatialGridBox(const SpatialGrid *grid, BoundingBox box, SpatialGridVisitor visitor, void *userData) {
+    if (grid->itemCount == 0) return;
+
+    // Nothing lies outside the item bounds, so huge boxes (view frustums) only cost the occupied cells
+    box.min = Vector3Max(box.min, grid->bounds.min);
+    box.max = Vector3Min(box.max, grid->bounds.max);
+    if (box.min.x > box.max.x || box.min.y > box.max.y || box.min.z > box.max.z) return;
+
+    int minX = GetSpatialGridCell(grid, box.min.x);
+    int maxX = GetSpatialGridCell(grid, box.max.x);
+    int minZ = GetSpatialGridCell(grid, box.min.z);
+    int maxZ = GetSpatialGridCell(grid, box.max.z);
+    double cellCount = ((double)maxX - minX + 1.0) * ((double)maxZ - minZ + 1.0);
+
+    // Boxes covering more cells than there are items are cheaper to answer with a scan
+    if (cellCount > grid->itemCount) {
+        for (int i = 0; i < grid->itemCount; i++) {
+            if (IsInsideBox(grid->positions[i], box) && !visitor(grid->items[i], grid->positions[i], userData)) return;
+        }
+        return;
+    }
+
+    for (int cz = minZ; cz <= maxZ; cz++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            int bucket = GetSpatialGridBucket(grid, cx, cz);
+            if (grid->bucketMaxY[bucket] < box.min.y || grid->bucketMinY[bucket] > box.max.y) continue;
+
+            for (int i = grid->bucketStart[bucket]; i < grid->bucketStart[bucket + 1]; i++) {
+                // Other cells can share the bucket, only report items of this cell
+                if (grid->cellX[i] != cx || grid->cellZ[i] != cz) continue;
+                if (IsInsideBox(grid->positions[i], box) && !visitor(grid->items[i], grid->positions[i], userData)) return;
+            }
+        }
+    }
+}
+
+// State shared by the radius queries
+typedef struct {
+    Vector3 center;
+    float radiusSqr;
+    int excludeItem;
+    int *results;
+    int maxResults;
+    int count;
+} RadiusQuery;
+
+// Function to collect items within the query radius
+static bool CollectRadiusItem(int item, Vector3 position, void *userData) {
+    RadiusQuery *query = (RadiusQuery *)userData;
+    if (Vector3DistanceSqr(position, query->center) > query->radiusSqr) return true;
+
+    query->results[query->count++] = item;
+    return query->count < query->maxResults;
+}
+
+// Function to stop at the first item within the query radius
+static bool FindRadiusItem(int item, Vector3 position, void *userData) {
+    RadiusQuery *query = (RadiusQuery *)userData;
+    if (item == query->excludeItem || Vector3DistanceSqr(position, query->center) >= query->radiusSqr) return true;
+
+    query->count = 1;
+    return false;
+}
+
+// Function to get the box around a sphere query
+static BoundingBox GetRadiusBox(Vector3 center, float radius) {
+    return (BoundingBox){
+        (Vector3){ center.x - radius, center.y - radius, center.z - radius },
+        (Vector3){ center.x + radius, center.y + radius, center.z + radius }
+    };
+}
+
+// Function to collect the items within radius of a point
+int QuerySpatialGridRadius(const SpatialGrid *grid, Vector3 center, float radius, int *results, int maxResults) {
+    if (maxResults <= 0) return 0;
+
+    RadiusQuery query = { center, radius * radius, -1, results, maxResults, 0 };
+    VisitSpatialGridBox(grid, GetRadiusBox(center, radius), CollectRadiusItem, &query);
+    return query.count;
+}
+
+// Function to check for any neighbour within radius of a point
+bool HasSpatialGridNeighbor(const SpatialGrid *grid, Vector3 center, float radius, int excludeItem) {
+    RadiusQuery query = { center, radius * radius, excludeItem, NULL, 0, 0 };
+    VisitSpatialGridBox(grid, GetRadiusBox(center, radius), FindRadiusItem, &query);
+    return query.count > 0;
+}
@@ -0,0 +1,51 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <raylib.h>
+#include <stdbool.h>
+
+// Spatial grid settings
+#define SPATIAL_GRID_MIN_BUCKETS 64    // Hash table never shrinks below this
+#define SPATIAL_GRID_LOAD_FACTOR 2     // Buckets per item, rounded up to a power of two
+
+// Called for every item found by a grid query, return false to stop the query
+typedef bool (*SpatialGridVisitor)(int item, Vector3 position, void *userData);
+
+// Uniform XZ grid hashed into a fixed bucket table, rebuilt from scratch with a counting sort
+typedef struct {
+    float cellSize;
+    float invCellSize;
+    int bucketCount;           // Power of two
+    int *bucketStart;          // bucketCount + 1 offsets into the sorted arrays
+    float *bucketMinY;         // Height range of the items in each bucket
+    float *bucketMaxY;
+    int *items;                // Item ids sorted by bucket
+    Vector3 *positions;        // Item positions in the same order
+    int *cellX;                // Unhashed cell of each sorted item
+    int *cellZ;
+    int *scratch;              // Bucket of each input item during a build
+    BoundingBox bounds;        // Box around every item, queries are clamped to it
+    int itemCount;
+    int itemCapacity;
+    int bucketCapacity;
+} SpatialGrid;
+
+// Create an empty grid, cellSize should be about the usual query radius
+SpatialGrid LoadSpatialGrid(float cellSize);
+
+// Release grid memory
+void UnloadSpatialGrid(SpatialGrid *grid);
+
+// Replace the grid contents with count items; items[i] is the id reported for positions[i] (i when items is NULL)
+void BuildSpatialGrid(SpatialGrid *grid, const int *items, const Vector3 *positions, int count);
+
+// Visit every item inside the box (each item once, in bucket order), boxes may be unbounded
+void VisitSpatialGridBox(const SpatialGrid *grid, BoundingBox box, SpatialGridVisitor visitor, void *userData);
+
+// Collect up to maxResults items within radius of center, returns the number found
+int QuerySpatialGridRadius(const SpatialGrid *grid, Vector3 center, float radius, int *results, int maxResults);
+
+// Check for any item other than excludeItem within radius of center
+bool HasSpatialGridNeighbor(const SpatialGrid *grid, Vector3 center, float radius, int excludeItem);
+
+#endif // SPATIALGRID_H
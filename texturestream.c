@@ -0,0 +1,305 @@
+#include "texturestream.h"
+#include <rlgl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// KTX2 container
+#define KTX2_HEADER_SIZE 80                // Identifier, nine 32-bit fields and the data format/key-value/supercompression index
+#define KTX2_LEVEL_ENTRY_SIZE 24           // byteOffset, byteLength, uncompressedByteLength (64-bit each)
+
+static const unsigned char ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// Vulkan format of a KTX2 file and the raylib pixel format that uploads it unchanged
+typedef struct {
+    unsigned int vkFormat;
+    int format;
+    int blockSize;             // Block width and height in pixels, 1 for uncompressed formats
+    int blockBytes;
+} Ktx2Format;
+
+// UNORM and SRGB variants share a raylib format, raylib samples both as linear like its PNG textures
+static const Ktx2Format ktx2Formats[] = {
+    { 37, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1, 4 },      // VK_FORMAT_R8G8B8A8_UNORM
+    { 43, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1, 4 },      // VK_FORMAT_R8G8B8A8_SRGB
+    { 131, PIXELFORMAT_COMPRESSED_DXT1_RGB, 4, 8 },       // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    { 132, PIXELFORMAT_COMPRESSED_DXT1_RGB, 4, 8 },
+    { 133, PIXELFORMAT_COMPRESSED_DXT1_RGBA, 4, 8 },      // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    { 134, PIXELFORMAT_COMPRESSED_DXT1_RGBA, 4, 8 },
+    { 135, PIXELFORMAT_COMPRESSED_DXT3_RGBA, 4, 16 },     // VK_FORMAT_BC2_UNORM_BLOCK
+    { 136, PIXELFORMAT_COMPRESSED_DXT3_RGBA, 4, 16 },
+    { 137, PIXELFORMAT_COMPRESSED_DXT5_RGBA, 4, 16 },     // VK_FORMAT_BC3_UNORM_BLOCK
+    { 138, PIXELFORMAT_COMPRESSED_DXT5_RGBA, 4, 16 },
+    { 147, PIXELFORMAT_COMPRESSED_ETC2_RGB, 4, 8 },       // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+    { 148, PIXELFORMAT_COMPRESSED_ETC2_RGB, 4, 8 },
+    { 151, PIXELFORMAT_COMPRESSED_ETC2_EAC_RGBA, 4, 16 }, // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+    { 152, PIXELFORMAT_COMPRESSED_ETC2_EAC_RGBA, 4, 16 },
+    { 157, PIXELFORMAT_COMPRESSED_ASTC_4x4_RGBA, 4, 16 }, // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+    { 158, PIXELFORMAT_COMPRESSED_ASTC_4x4_RGBA, 4, 16 },
+    { 171, PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA, 8, 16 }, // VK_FORMAT_ASTC_8x8_UNORM_BLOCK
+    { 172, PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA, 8, 16 },
+};
+
+#define KTX2_FORMAT_COUNT ((int)(sizeof(ktx2Formats) / sizeof(ktx2Formats[0])))
+
+// Function to read a little-endian 32-bit word
+static unsigned int ReadU32(const unsigned char *p) {
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+// Function to read a little-endian 64-bit word
+static unsigned long long ReadU64(const unsigned char *p) {
+    return (unsigned long long)ReadU32(p) | ((unsigned long long)ReadU32(p + 4) << 32);
+}
+
+// Function to probe which pixel formats the driver uploads
+unsigned int GetSupportedTextureFormats(void) {
+    unsigned int formats = 1u << PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    unsigned int probed = formats;
+    unsigned char block[16] = {0};
+
+    // rlgl refuses formats whose extension is missing before it creates a texture, so one block per format tells
+    for (int i = 0; i < KTX2_FORMAT_COUNT; i++) {
+        const Ktx2Format *format = &ktx2Formats[i];
+        if ((probed & (1u << format->format)) != 0) continue;
+        probed |= 1u << format->format;
+
+        unsigned int id = rlLoadTexture(block, format->blockSize, format->blockSize, format->format, 1);
+        if (id != 0) {
+            formats |= 1u << format->format;
+            rlUnloadTexture(id);
+        }
+    }
+
+    return formats;
+}
+
+// Function to compute the bytes of one mip level
+static size_t GetKtx2LevelBytes(const Ktx2Format *format, int width, int height) {
+    size_t blocksX = (size_t)(width + format->blockSize - 1) / format->blockSize;
+    size_t blocksY = (size_t)(height + format->blockSize - 1) / format->blockSize;
+    return blocksX * blocksY * format->blockBytes;
+}
+
+// Function to validate a KTX2 file
+bool ParseKtx2(const unsigned char *data, size_t size, Ktx2Info *info) {
+    memset(info, 0, sizeof(*info));
+    if (size < KTX2_HEADER_SIZE || memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) != 0) return false;
+
+    unsigned int vkFormat = ReadU32(data + 12);
+    unsigned int width = ReadU32(data + 20);
+    unsigned int height = ReadU32(data + 24);
+    unsigned int depth = ReadU32(data + 28);
+    unsigned int layers = ReadU32(data + 32);
+    unsigned int faces = ReadU32(data + 36);
+    unsigned int levels = ReadU32(data + 40);
+    unsigned int supercompression = ReadU32(data + 44);
+
+    // Basis Universal files are VK_FORMAT_UNDEFINED (UASTC) or BasisLZ supercompressed (ETC1S), neither maps to a GPU format
+    const Ktx2Format *format = NULL;
+    for (int i = 0; i < KTX2_FORMAT_COUNT; i++) {
+        if (ktx2Formats[i].vkFormat == vkFormat) format = &ktx2Formats[i];
+    }
+    if (format == NULL || supercompression != 0) return false;
+
+    // Plain 2D textures only: no arrays, cube maps or volumes
+    if (levels == 0) levels = 1;
+    if (width == 0 || height == 0 || width > 32768 || height > 32768 || depth > 1 || layers > 1 || faces != 1 ||
+        levels > TEXTURE_STREAM_MAX_LEVELS || size < KTX2_HEADER_SIZE + (size_t)levels * KTX2_LEVEL_ENTRY_SIZE) {
+        return false;
+    }
+
+    info->format = format->format;
+    info->width = (int)width;
+    info->height = (int)height;
+    info->levelCount = (int)levels;
+    for (int level = 0; level < info->levelCount; level++) {
+        const unsigned char *entry = data + KTX2_HEADER_SIZE + (size_t)level * KTX2_LEVEL_ENTRY_SIZE;
+        unsigned long long offset = ReadU64(entry);
+        unsigned long long length = ReadU64(entry + 8);
+        int levelWidth = (info->width >> level) > 0 ? (info->width >> level) : 1;
+        int levelHeight = (info->height >> level) > 0 ? (info->height >> level) : 1;
+
+        if (offset > size || length > size - offset || length != GetKtx2LevelBytes(format, levelWidth, levelHeight)) return false;
+        info->levelOffset[level] = (size_t)offset;
+        info->levelSize[level] = (size_t)length;
+    }
+
+    return true;
+}
+
+// Function to add a KTX2 file to the stream
+int AddStreamedTexture(TextureStream *stream, const unsigned char *data, size_t size) {
+    Ktx2Info info;
+    if (!ParseKtx2(data, size, &info)) return -1;
+
+    StreamedTexture *textures = (StreamedTexture *)realloc(stream->textures, sizeof(StreamedTexture) * (stream->textureCount + 1));
+    if (textures == NULL) return -1;
+    stream->textures = textures;
+
+    StreamedTexture *texture = &stream->textures[stream->textureCount];
+    memset(texture, 0, sizeof(*texture));
+    texture->data = (unsigned char *)malloc(size);
+    if (texture->data == NULL) {
+        printf("Failed to allocate %zu bytes for a KTX2 texture\n", size);
+        return -1;
+    }
+    memcpy(texture->data, data, size);
+    texture->size = size;
+    texture->info = info;
+    texture->residentLevel = info.levelCount;
+
+    return stream->textureCount++;
+}
+
+// Function to attach a streamed texture to a material map
+void BindStreamedTexture(TextureStream *stream, int texture, int material, int map) {
+    TextureBinding *bindings = (TextureBinding *)realloc(stream->bindings, sizeof(TextureBinding) * (stream->bindingCount + 1));
+    if (bindings == NULL) return;
+
+    stream->bindings = bindings;
+    stream->bindings[stream->bindingCount++] = (TextureBinding){ texture, material, map };
+}
+
+// Function to count the levels uploaded together with level, 1 when rlgl can't size the rest of the chain
+static int GetUploadMipmaps(const Ktx2Info *info, int level) {
+    int largest = (info->width > info->height) ? info->width : info->height;
+    int fullChain = 1;
+    while ((largest >> fullChain) > 0) fullChain++;
+
+    // rlLoadTexture walks the chain with rlGetPixelDataSize, which is only exact for whole blocks (and the
+    // last 1-2 pixel levels); a partial chain would leave the GL texture incomplete, so those get one level
+    if (info->levelCount != fullChain) return 1;
+    for (int l = level; l < info->levelCount; l++) {
+        int width = (info->width >> l) > 0 ? (info->width >> l) : 1;
+        int height = (info->height >> l) > 0 ? (info->height >> l) : 1;
+        if ((size_t)rlGetPixelDataSize(width, height, info->format) != info->levelSize[l]) return 1;
+    }
+    return info->levelCount - level;
+}
+
+// Function to count the bytes uploaded for a texture based at level
+static size_t GetUploadBytes(const Ktx2Info *info, int level) {
+    size_t bytes = 0;
+    int mipmaps = GetUploadMipmaps(info, level);
+    for (int l = level; l < level + mipmaps; l++) bytes += info->levelSize[l];
+    return bytes;
+}
+
+// Function to pick the level every texture starts at
+static int GetFirstStreamLevel(const Ktx2Info *info) {
+    int level = 0;
+    while (level + 1 < info->levelCount &&
+           ((info->width >> level) > TEXTURE_STREAM_FIRST_SIZE || (info->height >> level) > TEXTURE_STREAM_FIRST_SIZE)) {
+        level++;
+    }
+    return level;
+}
+
+// Function to replace a streamed texture with one based at a finer level
+static void UploadStreamedTexture(TextureStream *stream, int index, Model *model, int level) {
+    StreamedTexture *streamed = &stream->textures[index];
+    const Ktx2Info *info = &streamed->info;
+    int mipmaps = GetUploadMipmaps(info, level);
+    size_t bytes = GetUploadBytes(info, level);
+
+    // KTX2 stores the smallest level first, rlgl wants the chain from the base level down
+    unsigned char *chain = (unsigned char *)malloc(bytes);
+    if (chain == NULL) {
+        printf("Failed to allocate %zu bytes for a texture upload\n", bytes);
+        return;
+    }
+    size_t offset = 0;
+    for (int l = level; l < level + mipmaps; l++) {
+        memcpy(chain + offset, streamed->data + info->levelOffset[l], info->levelSize[l]);
+        offset += info->levelSize[l];
+    }
+
+    Texture2D texture = { 0 };
+    texture.width = (info->width >> level) > 0 ? (info->width >> level) : 1;
+    texture.height = (info->height >> level) > 0 ? (info->height >> level) : 1;
+    texture.mipmaps = mipmaps;
+    texture.format = info->format;
+    texture.id = rlLoadTexture(chain, texture.width, texture.height, texture.format, texture.mipmaps);
+    free(chain);
+
+    if (texture.id == 0) {
+        // Keep whatever is resident and stop streaming this one
+        printf("Failed to upload KTX2 texture level %d (%dx%d)\n", level, texture.width, texture.height);
+        streamed->residentLevel = 0;
+    } else {
+        if (texture.mipmaps > 1) SetTextureFilter(texture, TEXTURE_FILTER_TRILINEAR);
+
+        for (int i = 0; i < stream->bindingCount; i++) {
+            const TextureBinding *binding = &stream->bindings[i];
+            if (binding->texture != index || binding->material >= model->materialCount) continue;
+            model->materials[binding->material].maps[binding->map].texture = texture;
+        }
+
+        if (streamed->texture.id != 0) {
+            rlUnloadTexture(streamed->texture.id);
+            stream->residentBytes -= GetUploadBytes(info, streamed->residentLevel);
+        }
+        streamed->texture = texture;
+        streamed->residentLevel = level;
+        stream->residentBytes += bytes;
+    }
+
+    if (streamed->residentLevel == 0) {
+        free(streamed->data);
+        streamed->data = NULL;
+    }
+}
+
+// Function to stream the next mips
+bool UpdateTextureStream(TextureStream *stream, Model *model, size_t byteBudget) {
+    size_t uploaded = 0;
+    bool done = true;
+
+    for (int i = 0; i < stream->textureCount; i++) {
+        StreamedTexture *streamed = &stream->textures[i];
+        if (streamed->residentLevel == 0) continue;
+
+        // Nothing is shown until the first mip is in, so that one ignores the budget
+        int level;
+        if (byteBudget == 0) {
+            level = 0;
+        } else if (streamed->texture.id == 0) {
+            level = GetFirstStreamLevel(&streamed->info);
+        } else {
+            level = streamed->residentLevel - 1;
+            if (uploaded > 0 && uploaded + GetUploadBytes(&streamed->info, level) > byteBudget) {
+                done = false;
+                continue;
+            }
+        }
+
+        uploaded += GetUploadBytes(&streamed->info, level);
+        UploadStreamedTexture(stream, i, model, level);
+        if (streamed->residentLevel > 0) done = false;
+    }
+
+    return done;
+}
+
+// Function to release the streamed textures
+void UnloadTextureStream(TextureStream *stream, Model *model) {
+    Texture2D fallback = { rlGetTextureIdDefault(), 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+
+    for (int i = 0; i < stream->bindingCount; i++) {
+        const TextureBinding *binding = &stream->bindings[i];
+        if (model == NULL || binding->material >= model->materialCount) continue;
+
+        Texture2D *texture = &model->materials[binding->material].maps[binding->map].texture;
+        if (texture->id == stream->textures[binding->texture].texture.id) *texture = fallback;
+    }
+
+    for (int i = 0; i < stream->textureCount; i++) {
+        if (stream->textures[i].texture.id != 0) rlUnloadTexture(stream->textures[i].texture.id);
+        free(stream->textures[i].data);
+    }
+
+    free(stream->textures);
+    free(stream->bindings);
+    memset(stream, 0, sizeof(*stream));
+}
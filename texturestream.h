@@ -0,0 +1,68 @@
+#ifndef TEXTURESTREAM_H
+#define TEXTURESTREAM_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Texture streaming settings
+#define TEXTURE_STREAM_MAX_LEVELS 16           // Mip levels kept per KTX2 file, enough for 32768 pixel textures
+#define TEXTURE_STREAM_FIRST_SIZE 64           // Largest side of the mip every texture shows first
+#define TEXTURE_STREAM_FRAME_BYTES (8 * 1024 * 1024)  // Texture data uploaded per frame once the first mips are in
+
+// Mip chain of a 2D KTX2 file
+typedef struct {
+    int format;                                // raylib PixelFormat
+    int width;                                 // Of level 0
+    int height;
+    int levelCount;
+    size_t levelOffset[TEXTURE_STREAM_MAX_LEVELS];
+    size_t levelSize[TEXTURE_STREAM_MAX_LEVELS];
+} Ktx2Info;
+
+// KTX2 image uploaded coarsest mip first
+typedef struct {
+    unsigned char *data;       // Whole KTX2 file, freed once level 0 is resident
+    size_t size;
+    Ktx2Info info;
+    int residentLevel;         // Finest level on the GPU, levelCount while nothing is
+    Texture2D texture;
+} StreamedTexture;
+
+// Material map showing a streamed texture
+typedef struct {
+    int texture;               // Index into TextureStream.textures
+    int material;              // raylib material index (glTF material + 1, raylib adds a default material first)
+    int map;                   // MATERIAL_MAP_*
+} TextureBinding;
+
+// Material textures that come from KTX2 files instead of raylib's PNG/JPEG decoding
+typedef struct {
+    StreamedTexture *textures;
+    int textureCount;
+    TextureBinding *bindings;
+    int bindingCount;
+    size_t residentBytes;      // Texture data currently on the GPU
+} TextureStream;
+
+// Pixel formats the driver accepts as textures, one bit per PixelFormat (requires the window thread)
+unsigned int GetSupportedTextureFormats(void);
+
+// Read the header and level index of a KTX2 file, false unless it is a plain 2D texture raylib can upload
+// (Basis Universal and supercompressed files need a transcoder and are rejected)
+bool ParseKtx2(const unsigned char *data, size_t size, Ktx2Info *info);
+
+// Copy a KTX2 file into the stream, returns its texture index or -1 (CPU only, safe on a worker thread)
+int AddStreamedTexture(TextureStream *stream, const unsigned char *data, size_t size);
+
+// Show a streamed texture on a material map once it is uploaded
+void BindStreamedTexture(TextureStream *stream, int texture, int material, int map);
+
+// Upload the next finer mips within byteBudget, every texture gets its first mip regardless (0 uploads the full chains)
+// Returns true once every texture is complete
+bool UpdateTextureStream(TextureStream *stream, Model *model, size_t byteBudget);
+
+// Release the streamed textures, their material maps go back to raylib's default texture so UnloadModel skips them
+void UnloadTextureStream(TextureStream *stream, Model *model);
+
+#endif // TEXTURESTREAM_H
@@ -0,0 +1,484 @@
+#include "tilescene.h"
+#include <raymath.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scenecache.h"
+
+// Function to resolve a manifest tile path, relative paths start in the manifest's directory (free with free)
+static char *GetTilePath(const char *manifestPath, const char *tilePath) {
+    bool absolute = tilePath[0] == '/' || tilePath[0] == '\\' || (tilePath[0] != '\0' && tilePath[1] == ':');
+    const char *slash = strrchr(manifestPath, '/');
+    const char *backslash = strrchr(manifestPath, '\\');
+    if (slash == NULL || (backslash != NULL && backslash > slash)) slash = backslash;
+
+    size_t directoryLength = (absolute || slash == NULL) ? 0 : (size_t)(slash - manifestPath) + 1;
+    size_t length = strlen(tilePath);
+    char *path = (char *)malloc(directoryLength + length + 1);
+    if (path == NULL) return NULL;
+    memcpy(path, manifestPath, directoryLength);
+    memcpy(path + directoryLength, tilePath, length + 1);
+    return path;
+}
+
+// Function to append a tile, taking ownership of path
+static bool AddSceneTile(TileScene *scene, int *capacity, char *path, Vector3 position, float radius) {
+    if (scene->tileCount == *capacity) {
+        int newCapacity = (*capacity > 0) ? *capacity * 2 : 16;
+        SceneTile *tiles = (SceneTile *)realloc(scene->tiles, sizeof(SceneTile) * newCapacity);
+        if (tiles == NULL) return false;
+        scene->tiles = tiles;
+        *capacity = newCapacity;
+    }
+
+    SceneTile *tile = &scene->tiles[scene->tileCount++];
+    memset(tile, 0, sizeof(*tile));
+    tile->path = path;
+    tile->position = position;
+    tile->radius = fmaxf(radius, 0.0f);
+    tile->state = TILE_UNLOADED;
+
+    // Missing files keep a zero estimate and fail once they are in range
+    int fileSize = FileExists(path) ? GetFileLength(path) : 0;
+    tile->bytes = (size_t)fileSize * TILE_SCENE_FILE_BYTES_FACTOR;
+    return true;
+}
+
+// Function to read a scene manifest
+bool LoadTileScene(TileScene *scene, const char *path, unsigned int textureFormats, bool useSceneCache) {
+    memset(scene, 0, sizeof(*scene));
+    scene->loadDistance = TILE_SCENE_DEFAULT_LOAD_DISTANCE;
+    scene->unloadDistance = TILE_SCENE_DEFAULT_UNLOAD_DISTANCE;
+    scene->memoryBudget = (size_t)TILE_SCENE_DEFAULT_BUDGET_MB * 1024 * 1024;
+    scene->textureFormats = textureFormats;
+    scene->useSceneCache = useSceneCache;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Failed to open scene manifest: %s\n", path);
+        return false;
+    }
+
+    // Started once, so evicting or finishing a read never waits for threads to exit
+    for (int i = 0; i < TILE_SCENE_MAX_LOADS; i++) {
+        InitJobSystem(&scene->decoders[i], TILE_SCENE_DECODE_WORKERS);
+    }
+
+    char line[TILE_SCENE_MAX_LINE];
+    char tilePath[TILE_SCENE_MAX_LINE];
+    int capacity = 0;
+    int lineNumber = 0;
+    bool hasStart = false;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        line[strcspn(line, "#\r\n")] = '\0';
+
+        char keyword[32];
+        if (sscanf(line, "%31s", keyword) != 1) continue;
+
+        Vector3 position;
+        float value;
+        if (strcmp(keyword, "tile") == 0 &&
+            sscanf(line, "%*s %1023s %f %f %f %f", tilePath, &position.x, &position.y, &position.z, &value) == 5) {
+            char *resolved = GetTilePath(path, tilePath);
+            if (resolved == NULL || !AddSceneTile(scene, &capacity, resolved, position, value)) {
+                printf("Failed to allocate scene tiles\n");
+                free(resolved);
+                ok = false;
+            }
+        } else if (strcmp(keyword, "load_distance") == 0 && sscanf(line, "%*s %f", &value) == 1 && value > 0.0f) {
+            scene->loadDistance = value;
+        } else if (strcmp(keyword, "unload_distance") == 0 && sscanf(line, "%*s %f", &value) == 1 && value > 0.0f) {
+            scene->unloadDistance = value;
+        } else if (strcmp(keyword, "budget_mb") == 0 && sscanf(line, "%*s %f", &value) == 1 && value > 0.0f) {
+            scene->memoryBudget = (size_t)(value * 1024.0 * 1024.0);
+        } else if (strcmp(keyword, "start") == 0 &&
+                   sscanf(line, "%*s %f %f %f", &position.x, &position.y, &position.z) == 3) {
+            scene->start = position;
+            hasStart = true;
+        } else {
+            printf("Skipping scene manifest line %d: %s\n", lineNumber, line);
+        }
+    }
+    fclose(file);
+
+    if (ok && scene->tileCount == 0) {
+        printf("Scene manifest lists no tiles: %s\n", path);
+        ok = false;
+    }
+    if (!ok) {
+        UnloadTileScene(scene);
+        return false;
+    }
+
+    // Tiles between the two distances stay as they are, so one step across the edge doesn't reload them
+    if (scene->unloadDistance < scene->loadDistance) scene->unloadDistance = scene->loadDistance;
+
+    if (!hasStart) {
+        Vector3 minPosition = scene->tiles[0].position;
+        Vector3 maxPosition = minPosition;
+        for (int i = 1; i < scene->tileCount; i++) {
+            minPosition = Vector3Min(minPosition, scene->tiles[i].position);
+            maxPosition = Vector3Max(maxPosition, scene->tiles[i].position);
+        }
+        scene->start = Vector3Scale(Vector3Add(minPosition, maxPosition), 0.5f);
+    }
+
+    printf("Scene: %d tiles, loaded within %.0f, unloaded beyond %.0f, budget %.0f MB\n", scene->tileCount,
+           scene->loadDistance, scene->unloadDistance, scene->memoryBudget / (1024.0 * 1024.0));
+    return true;
+}
+
+// Function to measure the ground distance from a point to the edge of a tile's footprint
+static float GetTileDistance(const SceneTile *tile, Vector3 point) {
+    float dx = tile->position.x - point.x;
+    float dz = tile->position.z - point.z;
+    return fmaxf(sqrtf(dx * dx + dz * dz) - tile->radius, 0.0f);
+}
+
+// Function to add up the vertex and index data uploaded for a model
+static size_t GetModelMeshBytes(Model model) {
+    size_t bytes = 0;
+    for (int i = 0; i < model.meshCount; i++) {
+        const Mesh *mesh = &model.meshes[i];
+        size_t vertexCount = (size_t)mesh->vertexCount;
+        if (mesh->vertices != NULL) bytes += vertexCount * 3 * sizeof(float);
+        if (mesh->normals != NULL) bytes += vertexCount * 3 * sizeof(float);
+        if (mesh->texcoords != NULL) bytes += vertexCount * 2 * sizeof(float);
+        if (mesh->texcoords2 != NULL) bytes += vertexCount * 2 * sizeof(float);
+        if (mesh->tangents != NULL) bytes += vertexCount * 4 * sizeof(float);
+        if (mesh->colors != NULL) bytes += vertexCount * 4;
+        if (mesh->indices != NULL) bytes += (size_t)mesh->triangleCount * 3 * sizeof(unsigned short);
+    }
+    return bytes;
+}
+
+// Function to add up the resident memory of a drawn tile
+static size_t GetTileBytes(const SceneTile *tile) {
+    const ModelCollision *collision = &tile->collision;
+    size_t bytes = tile->meshBytes + tile->textures.residentBytes;
+    bytes += sizeof(MeshInfo) * collision->info.meshCount;
+    if (collision->soup.count > 0) bytes += GetTriangleSoupBufferSize(collision->soup.count);
+    bytes += sizeof(BVHNode) * collision->nodeCount;
+    return bytes;
+}
+
+// Function to replace a tile's share of the resident bytes
+static void SetTileBytes(TileScene *scene, SceneTile *tile, size_t bytes) {
+    scene->residentBytes = scene->residentBytes - tile->bytes + bytes;
+    tile->bytes = bytes;
+}
+
+// Function to find a decoder no read is using, -1 if all are busy
+static int FindFreeDecoder(const TileScene *scene) {
+    for (int i = 0; i < TILE_SCENE_MAX_LOADS; i++) {
+        if (!scene->decoderBusy[i]) return i;
+    }
+    return -1;
+}
+
+// Function to start reading a tile on a background thread, its estimate is reserved until it is measured
+static void BeginTileLoad(TileScene *scene, SceneTile *tile, int decoder) {
+    tile->decoder = decoder;
+    scene->decoderBusy[decoder] = true;
+    BeginModelFileLoad(&tile->load, tile->path, &scene->decoders[decoder], scene->textureFormats);
+    tile->state = TILE_READING;
+    scene->loadingTiles++;
+    scene->residentBytes += tile->bytes;
+}
+
+// Function to hand a tile whose collision is complete to the top-level structure
+static void MakeTileResident(TileScene *scene, SceneTile *tile) {
+    // Rays only read the baked soup from here, like the single-model viewer without --keep-mesh-data
+    ReleaseModelMeshData(&tile->model, NULL);
+    tile->state = TILE_RESIDENT;
+    scene->loadingTiles--;
+    SetTileBytes(scene, tile, GetTileBytes(tile));
+}
+
+// Function to upload a tile that was read and start its collision build (scene cache hits are resident right away)
+static void FinishTileRead(TileScene *scene, SceneTile *tile) {
+    SceneCacheKey cacheKey = { tile->load.hash, tile->load.size, 0, MatrixIdentity(), false, 0.0f, 0 };
+    Model model = FinishModelFileLoad(&tile->load, &tile->textures);
+    scene->decoderBusy[tile->decoder] = false;
+
+    if (model.meshCount == 0) {
+        printf("Failed to load scene tile: %s\n", tile->path);
+        UnloadModel(model);
+        tile->state = TILE_FAILED;
+        scene->loadingTiles--;
+        SetTileBytes(scene, tile, 0);
+        return;
+    }
+
+    model.transform = MatrixTranslate(tile->position.x, tile->position.y, tile->position.z);
+    tile->model = model;
+    tile->meshBytes = GetModelMeshBytes(model);
+    tile->texturesStreamed = (tile->textures.textureCount == 0);
+    SetTileBytes(scene, tile, GetTileBytes(tile));
+
+    // Cached per manifest entry, a GLB placed several times gets a cache file for each placement
+    char *cachePath = NULL;
+    size_t nameLength = strlen(tile->path) + 24;
+    char *tileName = scene->useSceneCache ? (char *)malloc(nameLength) : NULL;
+    if (tileName != NULL) {
+        snprintf(tileName, nameLength, "%s.tile%d", tile->path, (int)(tile - scene->tiles));
+        cachePath = GetSceneCachePath(tileName);
+        free(tileName);
+    }
+    cacheKey.meshCount = model.meshCount;
+    cacheKey.transform = model.transform;
+
+    Heightfield heightfield;
+    if (cachePath != NULL && LoadSceneCache(cachePath, cacheKey, &tile->collision, &heightfield)) {
+        UnloadHeightfield(&heightfield);
+        MakeTileResident(scene, tile);
+    } else {
+        tile->collision.transform = model.transform;
+        tile->collision.info = LoadModelInfo(model);
+        BeginCollisionBuild(&tile->build, model, cacheKey, cachePath, true, false, false);
+        tile->state = TILE_BUILDING;
+    }
+    free(cachePath);
+}
+
+// Function to take a finished collision build, returns false while it is still running (unless wait is set)
+static bool FinishTileBuild(TileScene *scene, SceneTile *tile, bool wait) {
+    ModelCollision collision;
+    Heightfield heightfield;
+    ModelLod lod;
+    if (!FinishCollisionBuild(&tile->build, wait, &collision, &heightfield, &lod)) return false;
+
+    // Replaces the mesh bounds the tile was culled with while building
+    UnloadModelCollision(&tile->collision);
+    tile->collision = collision;
+    UnloadHeightfield(&heightfield);
+    UnloadModelLod(&lod);
+    MakeTileResident(scene, tile);
+    return true;
+}
+
+// Function to free an uploaded tile, it can be loaded again later
+static void FreeTile(TileScene *scene, SceneTile *tile) {
+    UnloadTextureStream(&tile->textures, &tile->model);
+    UnloadModel(tile->model);
+    UnloadModelCollision(&tile->collision);
+    memset(&tile->model, 0, sizeof(tile->model));
+
+    // The measured size stays as the estimate of the next load
+    scene->residentBytes -= tile->bytes;
+    tile->state = TILE_UNLOADED;
+}
+
+// Function to evict a tile; reads and builds can't be stopped, so those tiles are freed once the work is done
+// instead of blocking the frame on it, and keep their bytes counted until then
+static void EvictTile(TileScene *scene, SceneTile *tile) {
+    if (tile->state == TILE_READING || tile->state == TILE_BUILDING) {
+        tile->evictedState = tile->state;
+        tile->state = TILE_EVICTING;
+        scene->loadingTiles--;
+    } else if (tile->state == TILE_RESIDENT) {
+        FreeTile(scene, tile);
+    }
+}
+
+// Function to free an evicted tile once its read or build is done, returns false while it is still running
+static bool CollectEvictedTile(TileScene *scene, SceneTile *tile, bool wait) {
+    if (tile->evictedState == TILE_READING) {
+        if (!wait && !IsModelFileLoadDone(&tile->load)) return false;
+        CancelModelFileLoad(&tile->load);
+        scene->decoderBusy[tile->decoder] = false;
+        scene->residentBytes -= tile->bytes;
+        tile->state = TILE_UNLOADED;
+        return true;
+    }
+
+    // Builds only read the model, it goes away with their results
+    ModelCollision collision;
+    Heightfield heightfield;
+    ModelLod lod;
+    if (!FinishCollisionBuild(&tile->build, wait, &collision, &heightfield, &lod)) return false;
+    UnloadModelCollision(&collision);
+    UnloadHeightfield(&heightfield);
+    UnloadModelLod(&lod);
+    FreeTile(scene, tile);
+    return true;
+}
+
+// Function to start loading the nearest tiles in range, farther resident tiles are evicted to fit the budget
+static bool StartTileLoads(TileScene *scene, bool *changed) {
+    bool started = false;
+    while (scene->loadingTiles < TILE_SCENE_MAX_LOADS) {
+        SceneTile *next = NULL;
+        for (int i = 0; i < scene->tileCount; i++) {
+            SceneTile *tile = &scene->tiles[i];
+            if (tile->state != TILE_UNLOADED || tile->distance > scene->loadDistance) continue;
+            if (next == NULL || tile->distance < next->distance) next = tile;
+        }
+        int decoder = FindFreeDecoder(scene);
+        if (next == NULL || decoder < 0) break;
+
+        while (scene->residentBytes + next->bytes > scene->memoryBudget) {
+            SceneTile *farthest = NULL;
+            for (int i = 0; i < scene->tileCount; i++) {
+                SceneTile *tile = &scene->tiles[i];
+                if (tile->state != TILE_RESIDENT || tile->distance <= next->distance) continue;
+                if (farthest == NULL || tile->distance > farthest->distance) farthest = tile;
+            }
+            if (farthest == NULL) break;
+            EvictTile(scene, farthest);
+            *changed = true;
+        }
+
+        // Nearer tiles fill the budget; a single tile larger than the budget still loads on its own
+        if (scene->residentBytes > 0 && scene->residentBytes + next->bytes > scene->memoryBudget) break;
+
+        BeginTileLoad(scene, next, decoder);
+        started = true;
+    }
+    return started;
+}
+
+// Function to move the loading tiles on by one stage, parsing at most one file per call unless wait is set
+static void AdvanceTileLoads(TileScene *scene, bool wait, bool *changed) {
+    bool parsed = false;
+    for (int i = 0; i < scene->tileCount; i++) {
+        SceneTile *tile = &scene->tiles[i];
+        if (tile->state == TILE_READING && (wait || !parsed)) {
+            if (!wait && !IsModelFileLoadDone(&tile->load)) continue;
+            FinishTileRead(scene, tile);
+            parsed = true;
+            if (tile->state == TILE_RESIDENT) *changed = true;
+        }
+        if (tile->state == TILE_BUILDING && FinishTileBuild(scene, tile, wait)) {
+            *changed = true;
+        }
+    }
+}
+
+// Function to rebuild the top-level collision structure over the resident tiles
+static void RebuildTileSceneCollision(TileScene *scene) {
+    UnloadCollisionScene(&scene->collision);
+
+    const ModelCollision **instances = (const ModelCollision **)malloc(sizeof(*instances) * scene->tileCount);
+    if (instances == NULL) {
+        printf("Failed to allocate the scene collision structure\n");
+        return;
+    }
+
+    int instanceCount = 0;
+    for (int i = 0; i < scene->tileCount; i++) {
+        if (scene->tiles[i].state == TILE_RESIDENT) instances[instanceCount++] = &scene->tiles[i].collision;
+    }
+    scene->collision = LoadCollisionScene(instances, instanceCount);
+    free(instances);
+}
+
+// Function to stream the tiles around a focus point
+bool UpdateTileScene(TileScene *scene, Vector3 focus, bool wait) {
+    bool changed = false;
+    for (int i = 0; i < scene->tileCount; i++) {
+        scene->tiles[i].distance = GetTileDistance(&scene->tiles[i], focus);
+    }
+
+    // Tiles evicted earlier are freed once their background work is done, then the ones that left the unload
+    // distance are evicted
+    for (int i = 0; i < scene->tileCount; i++) {
+        SceneTile *tile = &scene->tiles[i];
+        if (tile->state == TILE_EVICTING) CollectEvictedTile(scene, tile, wait);
+        if (tile->distance <= scene->unloadDistance) continue;
+        if (tile->state == TILE_RESIDENT) changed = true;
+        EvictTile(scene, tile);
+    }
+
+    // With wait every load started is finished before the next ones start
+    bool started;
+    do {
+        started = StartTileLoads(scene, &changed);
+        AdvanceTileLoads(scene, wait, &changed);
+    } while (wait && started);
+
+    // KTX2 textures sharpen over the next frames like the single model's (wait uploads them whole)
+    scene->residentTiles = 0;
+    scene->meshCount = 0;
+    scene->triangleCount = 0;
+    scene->vertexCount = 0;
+    for (int i = 0; i < scene->tileCount; i++) {
+        SceneTile *tile = &scene->tiles[i];
+        if (tile->state != TILE_BUILDING && tile->state != TILE_RESIDENT) continue;
+
+        if (!tile->texturesStreamed) {
+            tile->texturesStreamed = UpdateTextureStream(&tile->textures, &tile->model, wait ? 0 : TEXTURE_STREAM_FRAME_BYTES);
+            SetTileBytes(scene, tile, GetTileBytes(tile));
+        }
+        scene->residentTiles++;
+        scene->meshCount += tile->collision.info.meshCount;
+        scene->triangleCount += tile->collision.info.totalTriangles;
+        scene->vertexCount += tile->collision.info.totalVertices;
+    }
+
+    if (changed) RebuildTileSceneCollision(scene);
+    return changed;
+}
+
+// Function to check for tiles that are still loading or waiting to be freed
+bool IsTileSceneBusy(const TileScene *scene) {
+    if (scene->loadingTiles > 0) return true;
+    for (int i = 0; i < scene->tileCount; i++) {
+        const SceneTile *tile = &scene->tiles[i];
+        if (tile->state == TILE_EVICTING || (tile->state == TILE_RESIDENT && !tile->texturesStreamed)) return true;
+    }
+    return false;
+}
+
+// Function to draw the meshes of the drawn tiles that touch the view frustum
+int DrawTileScene(const TileScene *scene, const Frustum *frustum, int *trianglesDrawn) {
+    int meshesDrawn = 0;
+    for (int i = 0; i < scene->tileCount; i++) {
+        const SceneTile *tile = &scene->tiles[i];
+        if (tile->state != TILE_BUILDING && tile->state != TILE_RESIDENT) continue;
+
+        const Model *model = &tile->model;
+        for (int m = 0; m < model->meshCount; m++) {
+            if (frustum != NULL && !IsBoxInFrustum(frustum, tile->collision.info.meshes[m].bounds)) continue;
+            DrawMesh(model->meshes[m], model->materials[model->meshMaterial[m]], model->transform);
+            *trianglesDrawn += model->meshes[m].triangleCount;
+            meshesDrawn++;
+        }
+    }
+    return meshesDrawn;
+}
+
+// Function to frame the tile nearest to the start
+BoundingBox GetTileSceneStartBounds(const TileScene *scene) {
+    const SceneTile *nearest = NULL;
+    float nearestDistance = 0.0f;
+    for (int i = 0; i < scene->tileCount; i++) {
+        float distance = Vector3Distance(scene->tiles[i].position, scene->start);
+        if (nearest == NULL || distance < nearestDistance) {
+            nearest = &scene->tiles[i];
+            nearestDistance = distance;
+        }
+    }
+    if (nearest == NULL) return (BoundingBox){ scene->start, scene->start };
+
+    Vector3 extent = { nearest->radius, 0.0f, nearest->radius };
+    return (BoundingBox){ Vector3Subtract(nearest->position, extent), Vector3Add(nearest->position, extent) };
+}
+
+// Function to release every tile and the manifest
+void UnloadTileScene(TileScene *scene) {
+    for (int i = 0; i < scene->tileCount; i++) {
+        EvictTile(scene, &scene->tiles[i]);
+        if (scene->tiles[i].state == TILE_EVICTING) CollectEvictedTile(scene, &scene->tiles[i], true);
+        free(scene->tiles[i].path);
+    }
+    free(scene->tiles);
+    for (int i = 0; i < TILE_SCENE_MAX_LOADS; i++) {
+        CloseJobSystem(&scene->decoders[i]);
+    }
+    UnloadCollisionScene(&scene->collision);
+    memset(scene, 0, sizeof(*scene));
+}
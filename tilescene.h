@@ -0,0 +1,93 @@
+#ifndef TILESCENE_H
+#define TILESCENE_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "collision.h"
+#include "frustum.h"
+#include "jobs.h"
+#include "modelloader.h"
+#include "texturestream.h"
+
+// Tiled scene settings
+#define TILE_SCENE_DEFAULT_LOAD_DISTANCE 250.0f    // Tiles whose footprint comes this close to the focus are loaded
+#define TILE_SCENE_DEFAULT_UNLOAD_DISTANCE 350.0f  // and evicted once it is further away than this
+#define TILE_SCENE_DEFAULT_BUDGET_MB 1024          // Memory of the loaded tiles, farther tiles make room for nearer ones
+#define TILE_SCENE_MAX_LOADS 2                     // Tiles read or built in the background at once
+#define TILE_SCENE_DECODE_WORKERS 2                // Threads helping each reader decode its compressed buffers
+#define TILE_SCENE_FILE_BYTES_FACTOR 2             // Resident bytes per file byte assumed until a tile was loaded once
+#define TILE_SCENE_MAX_LINE 1024                   // Longest manifest line
+
+// Stage of one tile
+typedef enum {
+    TILE_UNLOADED,
+    TILE_READING,              // File is read on a background thread
+    TILE_BUILDING,             // Drawn, its collision BVH builds on a background thread
+    TILE_RESIDENT,             // Drawn and part of the top-level collision structure
+    TILE_EVICTING,             // Out of range while reading or building, freed once that work is done
+    TILE_FAILED                // Could not be loaded, not retried
+} TileState;
+
+// GLB placed in the scene by the manifest
+typedef struct {
+    char *path;
+    Vector3 position;          // Translation of the model
+    float radius;              // Footprint around position on the ground plane, distances are measured to its edge
+    int state;                 // TileState
+    int evictedState;          // TILE_READING or TILE_BUILDING, the work an evicting tile waits for
+    float distance;            // From the focus, updated every UpdateTileScene
+    size_t bytes;              // Resident memory: GPU meshes, textures and collision (an estimate until loaded once)
+    size_t meshBytes;          // Vertex and index data uploaded for the model
+    int decoder;               // Scene decoder used while the tile is read
+    ModelFileLoad load;
+    CollisionBuild build;
+    Model model;
+    TextureStream textures;
+    bool texturesStreamed;
+    ModelCollision collision;  // Mesh bounds only until the build is done
+} SceneTile;
+
+// Tiles streamed in and out around a focus point (the camera target)
+typedef struct {
+    SceneTile *tiles;
+    int tileCount;
+    Vector3 start;             // Focus the camera starts on, the centre of the tiles unless the manifest sets it
+    float loadDistance;
+    float unloadDistance;
+    size_t memoryBudget;       // In bytes
+    size_t residentBytes;      // Tiles loaded, being loaded or waiting to be freed
+    int residentTiles;         // Tiles being drawn
+    int loadingTiles;          // Tiles being read or built
+    unsigned int textureFormats;   // GetSupportedTextureFormats bits KTX2 tile textures may use
+    JobSystem decoders[TILE_SCENE_MAX_LOADS];   // One per read in flight, the shared job system runs unit steps
+    bool decoderBusy[TILE_SCENE_MAX_LOADS];     // Held by a reading tile until its read is done or abandoned
+    bool useSceneCache;
+    CollisionScene collision;  // Top-level structure over the resident tiles' BVHs
+    int meshCount;             // Totals of the drawn tiles
+    int triangleCount;
+    int vertexCount;
+} TileScene;
+
+// Read a scene manifest, relative tile paths are relative to it; returns false if it can't be read or lists no tiles
+// Lines: "tile <path> <x> <y> <z> <radius>", "load_distance <d>", "unload_distance <d>", "budget_mb <mb>",
+// "start <x> <y> <z>"; # starts a comment
+bool LoadTileScene(TileScene *scene, const char *path, unsigned int textureFormats, bool useSceneCache);
+
+// Load tiles around focus on background threads and evict the far ones, must not run while a unit step reads the collision
+// Returns true when the top-level collision structure changed; wait finishes every load within the call (benchmarks, recordings)
+bool UpdateTileScene(TileScene *scene, Vector3 focus, bool wait);
+
+// Whether a tile is still being loaded, freed or streaming its textures
+bool IsTileSceneBusy(const TileScene *scene);
+
+// Draw the meshes of the loaded tiles inside frustum (NULL draws all), returns the meshes drawn
+int DrawTileScene(const TileScene *scene, const Frustum *frustum, int *trianglesDrawn);
+
+// Box around the footprint of the tile nearest to the start, for framing the camera
+BoundingBox GetTileSceneStartBounds(const TileScene *scene);
+
+// Release every tile, waiting for background work (requires the window thread)
+void UnloadTileScene(TileScene *scene);
+
+#endif // TILESCENE_H
@@ -0,0 +1,382 @@
+#include "unitpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Function to resize one pool array, returns it untouched and clears ok if memory ran out
+static void *GrowArray(void *array, size_t elementSize, int capacity, bool *ok) {
+    if (!*ok) return array;
+
+    void *grown = realloc(array, elementSize * capacity);
+    if (grown == NULL) {
+        *ok = false;
+        return array;
+    }
+    return grown;
+}
+
+// Function to grow the per-unit arrays, returns false if memory ran out
+static bool ReserveUnits(UnitPool *pool, int count) {
+    if (count <= pool->capacity) return true;
+
+    int capacity = (pool->capacity > 0) ? pool->capacity : UNIT_POOL_INITIAL_CAPACITY;
+    while (capacity < count) capacity *= 2;
+
+    int oldWords = pool->capacity / UNIT_BITS_PER_WORD;
+    int words = capacity / UNIT_BITS_PER_WORD;
+
+    bool ok = true;
+    pool->position = GrowArray(pool->position, sizeof(Vector3), capacity, &ok);
+    pool->velocity = GrowArray(pool->velocity, sizeof(Vector3), capacity, &ok);
+    pool->targetPosition = GrowArray(pool->targetPosition, sizeof(Vector3), capacity, &ok);
+    pool->commandTarget = GrowArray(pool->commandTarget, sizeof(Vector3), capacity, &ok);
+    pool->commandField = GrowArray(pool->commandField, sizeof(int), capacity, &ok);
+    pool->rotation = GrowArray(pool->rotation, sizeof(float), capacity, &ok);
+    pool->moveTimer = GrowArray(pool->moveTimer, sizeof(float), capacity, &ok);
+    pool->rngState = GrowArray(pool->rngState, sizeof(unsigned int), capacity, &ok);
+    pool->probeOrigin = GrowArray(pool->probeOrigin, sizeof(Vector3), capacity, &ok);
+    pool->probeDirection = GrowArray(pool->probeDirection, sizeof(Vector3), capacity, &ok);
+    pool->probeDistance = GrowArray(pool->probeDistance, sizeof(float), capacity, &ok);
+    pool->nextPosition = GrowArray(pool->nextPosition, sizeof(Vector3), capacity, &ok);
+    pool->nextRotation = GrowArray(pool->nextRotation, sizeof(float), capacity, &ok);
+    pool->nextCommandBits = GrowArray(pool->nextCommandBits, sizeof(unsigned int), words, &ok);
+    pool->previousPosition = GrowArray(pool->previousPosition, sizeof(Vector3), capacity, &ok);
+    pool->previousRotation = GrowArray(pool->previousRotation, sizeof(float), capacity, &ok);
+    pool->drawPosition = GrowArray(pool->drawPosition, sizeof(Vector3), capacity, &ok);
+    pool->drawRotation = GrowArray(pool->drawRotation, sizeof(float), capacity, &ok);
+    pool->size = GrowArray(pool->size, sizeof(float), capacity, &ok);
+    pool->color = GrowArray(pool->color, sizeof(Color), capacity, &ok);
+    pool->groupId = GrowArray(pool->groupId, sizeof(int), capacity, &ok);
+    pool->selectedBits = GrowArray(pool->selectedBits, sizeof(unsigned int), words, &ok);
+    pool->commandBits = GrowArray(pool->commandBits, sizeof(unsigned int), words, &ok);
+    pool->unitSlot = GrowArray(pool->unitSlot, sizeof(int), capacity, &ok);
+    for (int g = 1; g < UNIT_GROUP_COUNT; g++) {
+        pool->groupBits[g] = GrowArray(pool->groupBits[g], sizeof(unsigned int), words, &ok);
+    }
+    if (!ok) return false;
+
+    // Bits past count are always clear
+    memset(pool->selectedBits + oldWords, 0, sizeof(unsigned int) * (words - oldWords));
+    memset(pool->commandBits + oldWords, 0, sizeof(unsigned int) * (words - oldWords));
+    memset(pool->nextCommandBits + oldWords, 0, sizeof(unsigned int) * (words - oldWords));
+    for (int g = 1; g < UNIT_GROUP_COUNT; g++) {
+        memset(pool->groupBits[g] + oldWords, 0, sizeof(unsigned int) * (words - oldWords));
+    }
+
+    pool->capacity = capacity;
+    return true;
+}
+
+// Function to grow the slot table, returns false if memory ran out
+static bool ReserveSlots(UnitPool *pool, int count) {
+    if (count <= pool->slotCapacity) return true;
+
+    int capacity = (pool->slotCapacity > 0) ? pool->slotCapacity : UNIT_POOL_INITIAL_CAPACITY;
+    while (capacity < count) capacity *= 2;
+
+    bool ok = true;
+    pool->slotUnit = GrowArray(pool->slotUnit, sizeof(int), capacity, &ok);
+    pool->slotGeneration = GrowArray(pool->slotGeneration, sizeof(unsigned int), capacity, &ok);
+    pool->freeSlots = GrowArray(pool->freeSlots, sizeof(int), capacity, &ok);
+    if (!ok) return false;
+
+    pool->slotCapacity = capacity;
+    return true;
+}
+
+// Function to create an empty pool
+UnitPool LoadUnitPool(int capacity) {
+    UnitPool pool = {0};
+
+    if (!ReserveUnits(&pool, capacity) || !ReserveSlots(&pool, capacity)) {
+        printf("Failed to allocate unit pool for %d units\n", capacity);
+    }
+
+    return pool;
+}
+
+// Function to release pool memory
+void UnloadUnitPool(UnitPool *pool) {
+    free(pool->position);
+    free(pool->velocity);
+    free(pool->targetPosition);
+    free(pool->commandTarget);
+    free(pool->commandField);
+    free(pool->rotation);
+    free(pool->moveTimer);
+    free(pool->rngState);
+    free(pool->probeOrigin);
+    free(pool->probeDirection);
+    free(pool->probeDistance);
+    free(pool->nextPosition);
+    free(pool->nextRotation);
+    free(pool->nextCommandBits);
+    free(pool->previousPosition);
+    free(pool->previousRotation);
+    free(pool->drawPosition);
+    free(pool->drawRotation);
+    free(pool->size);
+    free(pool->color);
+    free(pool->groupId);
+    free(pool->selectedBits);
+    free(pool->commandBits);
+    free(pool->unitSlot);
+    for (int g = 1; g < UNIT_GROUP_COUNT; g++) {
+        free(pool->groupBits[g]);
+    }
+    free(pool->slotUnit);
+    free(pool->slotGeneration);
+    free(pool->freeSlots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+// Function to add a unit to the end of the dense arrays
+UnitHandle AddUnit(UnitPool *pool, Unit unit) {
+    if (!ReserveUnits(pool, pool->count + 1)) return UNIT_HANDLE_NONE;
+
+    // Reuse a freed slot before growing the table
+    int slot;
+    if (pool->freeCount > 0) {
+        slot = pool->freeSlots[--pool->freeCount];
+    } else {
+        if (!ReserveSlots(pool, pool->slotCount + 1)) return UNIT_HANDLE_NONE;
+        slot = pool->slotCount++;
+        pool->slotGeneration[slot] = 0;
+    }
+
+    int index = pool->count++;
+    pool->position[index] = unit.position;
+    pool->velocity[index] = unit.velocity;
+    pool->targetPosition[index] = unit.targetPosition;
+    pool->commandTarget[index] = unit.commandTarget;
+    pool->commandField[index] = unit.commandField;
+    pool->rotation[index] = unit.rotation;
+    pool->moveTimer[index] = unit.moveTimer;
+    pool->rngState[index] = (unit.seed != 0) ? unit.seed : 0x9E3779B9u;  // Xorshift state must not be zero
+    pool->probeOrigin[index] = unit.position;
+    pool->probeDirection[index] = (Vector3){ 0, 0, 0 };
+    pool->probeDistance[index] = 0.0f;
+    pool->previousPosition[index] = unit.position;
+    pool->previousRotation[index] = unit.rotation;
+    pool->drawPosition[index] = unit.position;
+    pool->drawRotation[index] = unit.rotation;
+    pool->size[index] = unit.size;
+    pool->color[index] = unit.color;
+    pool->groupId[index] = 0;
+    SetUnitGroup(pool, index, unit.groupId);
+    SetUnitSelected(pool, index, unit.selected);
+    SetUnitCommand(pool, index, unit.hasCommand);
+
+    pool->unitSlot[index] = slot;
+    pool->slotUnit[slot] = index;
+
+    return (UnitHandle){ slot, pool->slotGeneration[slot] };
+}
+
+// Function to remove the unit at a dense index by moving the last unit into it
+void RemoveUnitAt(UnitPool *pool, int index) {
+    if (index < 0 || index >= pool->count) return;
+
+    int slot = pool->unitSlot[index];
+    int last = --pool->count;
+
+    // The removed unit leaves the selection and its group, so the counters stay exact
+    SetUnitSelected(pool, index, false);
+    SetUnitGroup(pool, index, 0);
+
+    if (index != last) {
+        pool->position[index] = pool->position[last];
+        pool->velocity[index] = pool->velocity[last];
+        pool->targetPosition[index] = pool->targetPosition[last];
+        pool->commandTarget[index] = pool->commandTarget[last];
+        pool->commandField[index] = pool->commandField[last];
+        pool->rotation[index] = pool->rotation[last];
+        pool->moveTimer[index] = pool->moveTimer[last];
+        pool->rngState[index] = pool->rngState[last];
+        pool->probeOrigin[index] = pool->probeOrigin[last];
+        pool->probeDirection[index] = pool->probeDirection[last];
+        pool->probeDistance[index] = pool->probeDistance[last];
+        pool->previousPosition[index] = pool->previousPosition[last];
+        pool->previousRotation[index] = pool->previousRotation[last];
+        pool->drawPosition[index] = pool->drawPosition[last];
+        pool->drawRotation[index] = pool->drawRotation[last];
+        pool->size[index] = pool->size[last];
+        pool->color[index] = pool->color[last];
+        SetUnitGroup(pool, index, pool->groupId[last]);
+        SetUnitSelected(pool, index, IsUnitSelected(pool, last));
+        SetUnitCommand(pool, index, HasUnitCommand(pool, last));
+
+        pool->unitSlot[index] = pool->unitSlot[last];
+        pool->slotUnit[pool->unitSlot[index]] = index;
+    }
+
+    SetUnitSelected(pool, last, false);
+    SetUnitCommand(pool, last, false);
+    SetUnitGroup(pool, last, 0);
+
+    // Stale handles to this slot stop resolving
+    pool->slotUnit[slot] = -1;
+    pool->slotGeneration[slot]++;
+    pool->freeSlots[pool->freeCount++] = slot;
+}
+
+// Function to remove the unit a handle refers to
+bool RemoveUnit(UnitPool *pool, UnitHandle handle) {
+    int index = GetUnitIndex(pool, handle);
+    if (index < 0) return false;
+
+    RemoveUnitAt(pool, index);
+    return true;
+}
+
+// Function to remove every unit
+void ClearUnitPool(UnitPool *pool) {
+    while (pool->count > 0) RemoveUnitAt(pool, pool->count - 1);
+}
+
+// Function to resolve a handle to a dense index
+int GetUnitIndex(const UnitPool *pool, UnitHandle handle) {
+    if (handle.slot < 0 || handle.slot >= pool->slotCount) return -1;
+    if (pool->slotGeneration[handle.slot] != handle.generation) return -1;
+
+    return pool->slotUnit[handle.slot];
+}
+
+// Function to get the handle of a live unit
+UnitHandle GetUnitHandle(const UnitPool *pool, int index) {
+    if (index < 0 || index >= pool->count) return UNIT_HANDLE_NONE;
+
+    int slot = pool->unitSlot[index];
+    return (UnitHandle){ slot, pool->slotGeneration[slot] };
+}
+
+// Function to rotate the state buffers: next becomes current, current becomes previous
+// The old previous buffers are free to receive the next step
+void SwapUnitBuffers(UnitPool *pool) {
+    Vector3 *position = pool->previousPosition;
+    pool->previousPosition = pool->position;
+    pool->position = pool->nextPosition;
+    pool->nextPosition = position;
+
+    float *rotation = pool->previousRotation;
+    pool->previousRotation = pool->rotation;
+    pool->rotation = pool->nextRotation;
+    pool->nextRotation = rotation;
+
+    unsigned int *commandBits = pool->commandBits;
+    pool->commandBits = pool->nextCommandBits;
+    pool->nextCommandBits = commandBits;
+}
+
+// Function to blend the previous and current state into the draw state
+void InterpolateUnits(UnitPool *pool, float alpha) {
+    // Positions are packed floats, so they blend as one flat loop
+    const float *previous = (const float *)pool->previousPosition;
+    const float *current = (const float *)pool->position;
+    float *drawn = (float *)pool->drawPosition;
+    for (int i = 0; i < pool->count * 3; i++) {
+        drawn[i] = previous[i] + (current[i] - previous[i]) * alpha;
+    }
+
+    // Turn the short way round
+    for (int i = 0; i < pool->count; i++) {
+        float turn = remainderf(pool->rotation[i] - pool->previousRotation[i], 2.0f * PI);
+        pool->drawRotation[i] = pool->previousRotation[i] + turn * alpha;
+    }
+}
+
+// Function to invalidate every cached look-ahead ray
+void ResetUnitProbes(UnitPool *pool) {
+    if (pool->count > 0) memset(pool->probeDirection, 0, sizeof(Vector3) * pool->count);
+}
+
+// Function to draw the next number of a unit's xorshift32 sequence
+int GetUnitRandomValue(UnitPool *pool, int index, int min, int max) {
+    unsigned int x = pool->rngState[index];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pool->rngState[index] = x;
+
+    if (min > max) {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    return min + (int)(x % (unsigned int)(max - min + 1));
+}
+
+// Function to deselect every unit
+void ClearUnitSelection(UnitPool *pool) {
+    int words = (pool->count + UNIT_BITS_PER_WORD - 1) / UNIT_BITS_PER_WORD;
+    memset(pool->selectedBits, 0, sizeof(unsigned int) * words);
+    pool->selectedCount = 0;
+}
+
+// Function to get the number of selected units
+int CountSelectedUnits(const UnitPool *pool) {
+    return pool->selectedCount;
+}
+
+// Function to move a unit between control group bitsets
+void SetUnitGroup(UnitPool *pool, int index, int group) {
+    if (group < 0 || group >= UNIT_GROUP_COUNT) group = 0;
+
+    int oldGroup = pool->groupId[index];
+    if (oldGroup == group) return;
+
+    if (oldGroup > 0 && oldGroup < UNIT_GROUP_COUNT) {
+        SetUnitBit(pool->groupBits[oldGroup], index, false);
+        pool->groupCount[oldGroup]--;
+    }
+    if (group > 0) {
+        SetUnitBit(pool->groupBits[group], index, true);
+        pool->groupCount[group]++;
+    }
+    pool->groupId[index] = group;
+}
+
+// Function to empty a control group
+void ClearUnitGroup(UnitPool *pool, int group) {
+    if (group <= 0 || group >= UNIT_GROUP_COUNT) return;
+
+    for (int i = FindNextUnitBit(pool, pool->groupBits[group], 0); i >= 0; i = FindNextUnitBit(pool, pool->groupBits[group], i + 1)) {
+        pool->groupId[i] = 0;
+    }
+
+    int words = (pool->count + UNIT_BITS_PER_WORD - 1) / UNIT_BITS_PER_WORD;
+    if (words > 0) memset(pool->groupBits[group], 0, sizeof(unsigned int) * words);
+    pool->groupCount[group] = 0;
+}
+
+// Function to select exactly the members of a control group, one word at a time
+void SelectUnitGroup(UnitPool *pool, int group) {
+    int words = (pool->count + UNIT_BITS_PER_WORD - 1) / UNIT_BITS_PER_WORD;
+    if (words == 0) return;
+
+    if (group <= 0 || group >= UNIT_GROUP_COUNT) {
+        ClearUnitSelection(pool);
+        return;
+    }
+    memcpy(pool->selectedBits, pool->groupBits[group], sizeof(unsigned int) * words);
+    pool->selectedCount = pool->groupCount[group];
+}
+
+// Function to find the next set bit, skipping empty words
+int FindNextUnitBit(const UnitPool *pool, const unsigned int *bits, int start) {
+    if (start < 0) start = 0;
+    if (start >= pool->count) return -1;
+
+    int word = start / UNIT_BITS_PER_WORD;
+    int words = (pool->count + UNIT_BITS_PER_WORD - 1) / UNIT_BITS_PER_WORD;
+    unsigned int remaining = bits[word] & (~0u << (start % UNIT_BITS_PER_WORD));
+
+    while (remaining == 0) {
+        if (++word >= words) return -1;
+        remaining = bits[word];
+    }
+
+    // Bits past count are always clear
+    return word * UNIT_BITS_PER_WORD + __builtin_ctz(remaining);
+}
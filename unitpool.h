@@ -0,0 +1,166 @@
+#ifndef UNITPOOL_H
+#define UNITPOOL_H
+
+#include <raylib.h>
+#include <stdbool.h>
+
+// Unit pool settings
+#define UNIT_POOL_INITIAL_CAPACITY 256  // Power of two, capacity doubles from here
+#define UNIT_BITS_PER_WORD 32
+#define UNIT_GROUP_COUNT 10             // Control group ids, 0 means no group and 1-9 are groups
+
+// Initial state of a unit, scattered into the pool arrays by AddUnit
+typedef struct {
+    Vector3 position;
+    Vector3 velocity;
+    Vector3 targetPosition;
+    Vector3 commandTarget;  // Target set by player command
+    bool hasCommand;        // Whether unit has a player command
+    int commandField;       // Flow field goal cell of the command, -1 steers straight at the target
+    float rotation;
+    float moveTimer;
+    float size;
+    Color color;
+    bool selected;
+    int groupId;  // Control group ID (0 = no group, 1-9 = groups)
+    unsigned int seed;  // Start of the unit's own random sequence
+} Unit;
+
+// Stable reference to a unit, goes stale when the unit is removed
+typedef struct {
+    int slot;
+    unsigned int generation;
+} UnitHandle;
+
+#define UNIT_HANDLE_NONE ((UnitHandle){ -1, 0 })
+
+// Growable unit storage in structure-of-arrays layout
+// Live units stay packed in [0, count), handles go through a slot table
+// The simulation step writes the next* buffers while the current ones are drawn, then they swap
+// Drawing uses draw* positions, interpolated between the previous* and current step
+typedef struct {
+    // Hot simulation data, touched by every update
+    Vector3 *position;
+    Vector3 *velocity;
+    Vector3 *targetPosition;
+    Vector3 *commandTarget;
+    int *commandField;
+    float *rotation;
+    float *moveTimer;
+    unsigned int *rngState;        // Per-unit random state, so results do not depend on threads
+
+    // Last look-ahead ray of each unit, reused while the unit stays on it
+    Vector3 *probeOrigin;
+    Vector3 *probeDirection;       // Zero until the first probe
+    float *probeDistance;          // Closest hit, or the full probe length when nothing was hit
+
+    // Simulation output, swapped with the current state once a step completes
+    Vector3 *nextPosition;
+    float *nextRotation;
+    unsigned int *nextCommandBits;
+
+    // State before the last completed step, and the blend of both that is drawn
+    Vector3 *previousPosition;
+    float *previousRotation;
+    Vector3 *drawPosition;
+    float *drawRotation;
+
+    // Cold presentation data
+    float *size;
+    Color *color;
+    int *groupId;
+
+    // State flags, one bit per unit
+    unsigned int *selectedBits;
+    unsigned int *commandBits;
+    unsigned int *groupBits[UNIT_GROUP_COUNT];   // Members of each control group (NULL for group 0), mirrors groupId
+    int selectedCount;             // Set selection bits, kept by SetUnitSelected
+    int groupCount[UNIT_GROUP_COUNT];
+
+    int *unitSlot;                 // Slot of each live unit
+    int count;
+    int capacity;
+
+    int *slotUnit;                 // Dense index of each slot, -1 when free
+    unsigned int *slotGeneration;  // Bumped every time the slot is freed
+    int *freeSlots;                // Stack of free slots
+    int freeCount;
+    int slotCount;
+    int slotCapacity;
+} UnitPool;
+
+// Create an empty pool with room for capacity units
+UnitPool LoadUnitPool(int capacity);
+
+// Release pool memory
+void UnloadUnitPool(UnitPool *pool);
+
+// Add a unit, returns UNIT_HANDLE_NONE if memory ran out
+UnitHandle AddUnit(UnitPool *pool, Unit unit);
+
+// Remove a unit; the last live unit moves into its dense index
+bool RemoveUnit(UnitPool *pool, UnitHandle handle);
+
+// Remove the unit at a dense index (same reordering as RemoveUnit)
+void RemoveUnitAt(UnitPool *pool, int index);
+
+// Remove every unit, all existing handles go stale
+void ClearUnitPool(UnitPool *pool);
+
+// Resolve a handle to its dense index, or -1 if the unit no longer exists
+int GetUnitIndex(const UnitPool *pool, UnitHandle handle);
+
+// Handle of the unit at a dense index
+UnitHandle GetUnitHandle(const UnitPool *pool, int index);
+
+// Make the completed simulation output current, the current state becomes the previous one
+void SwapUnitBuffers(UnitPool *pool);
+
+// Fill the draw state, alpha 0 is the previous step and 1 the current one
+void InterpolateUnits(UnitPool *pool, float alpha);
+
+// Forget every unit's look-ahead ray, needed whenever the collision geometry changes
+void ResetUnitProbes(UnitPool *pool);
+
+// Random integer in [min, max] from the unit's own sequence (like GetRandomValue)
+int GetUnitRandomValue(UnitPool *pool, int index, int min, int max);
+
+// Deselect every unit
+void ClearUnitSelection(UnitPool *pool);
+
+// Number of selected units
+int CountSelectedUnits(const UnitPool *pool);
+
+// Move a unit into a control group (0 takes it out of its group)
+void SetUnitGroup(UnitPool *pool, int index, int group);
+
+// Take every member out of a control group
+void ClearUnitGroup(UnitPool *pool, int group);
+
+// Replace the selection with the members of a control group
+void SelectUnitGroup(UnitPool *pool, int group);
+
+// Dense index of the first set bit at or after start, -1 past the last unit
+int FindNextUnitBit(const UnitPool *pool, const unsigned int *bits, int start);
+
+// Flag accessors, cheap enough to call from the update loop
+static inline bool GetUnitBit(const unsigned int *bits, int index) {
+    return (bits[index / UNIT_BITS_PER_WORD] >> (index % UNIT_BITS_PER_WORD)) & 1u;
+}
+
+static inline void SetUnitBit(unsigned int *bits, int index, bool value) {
+    unsigned int mask = 1u << (index % UNIT_BITS_PER_WORD);
+    if (value) bits[index / UNIT_BITS_PER_WORD] |= mask;
+    else bits[index / UNIT_BITS_PER_WORD] &= ~mask;
+}
+
+static inline bool IsUnitSelected(const UnitPool *pool, int index) { return GetUnitBit(pool->selectedBits, index); }
+static inline void SetUnitSelected(UnitPool *pool, int index, bool selected) {
+    if (IsUnitSelected(pool, index) == selected) return;
+    SetUnitBit(pool->selectedBits, index, selected);
+    pool->selectedCount += selected ? 1 : -1;
+}
+static inline bool HasUnitCommand(const UnitPool *pool, int index) { return GetUnitBit(pool->commandBits, index); }
+static inline void SetUnitCommand(UnitPool *pool, int index, bool hasCommand) { SetUnitBit(pool->commandBits, index, hasCommand); }
+
+#endif // UNITPOOL_H
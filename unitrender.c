@@ -0,0 +1,380 @@
+#include "unitrender.h"
+#include "frustum.h"
+#include <rlgl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+// Unit cube in local space [-0.5, 0.5], placed by the per-instance transform
+static const char *unitVertexShader =
+    "#version 330\n"
+    "in vec3 vertexPosition;\n"
+    "in mat4 instanceTransform;\n"
+    "in vec4 instanceColor;\n"
+    "in float instanceFlags;\n"
+    "uniform mat4 mvp;\n"
+    "out vec3 fragLocal;\n"
+    "out vec4 fragColor;\n"
+    "flat out float fragFlags;\n"
+    "void main() {\n"
+    "    fragLocal = vertexPosition;\n"
+    "    fragColor = instanceColor;\n"
+    "    fragFlags = instanceFlags;\n"
+    "    gl_Position = mvp * instanceTransform * vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+// Cube edges are where two local coordinates are within a pixel of a face, like DrawCubeWires
+static const char *unitFragmentShader =
+    "#version 330\n"
+    "in vec3 fragLocal;\n"
+    "in vec4 fragColor;\n"
+    "flat in float fragFlags;\n"
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "    vec3 pixels = (0.5 - abs(fragLocal)) / max(fwidth(fragLocal), vec3(1e-6));\n"
+    "    float nearFaces = dot(vec3(lessThan(pixels, vec3(1.0))), vec3(1.0));\n"
+    "    bool edge = nearFaces >= 2.0;\n"
+    "    if (fragFlags > 1.5) {\n"
+    "        finalColor = fragColor;\n"
+    "    } else if (fragFlags > 0.5) {\n"
+    "        if (!edge) discard;\n"
+    "        finalColor = fragColor;\n"
+    "    } else {\n"
+    "        finalColor = edge ? vec4(0.0, 0.0, 0.0, 1.0) : fragColor;\n"
+    "    }\n"
+    "}\n";
+
+// Function to attach a fresh instance attribute buffer to a batch's mesh VAO
+static void LoadInstanceBuffer(UnitInstanceBatch *batch, int colorLoc, int flagsLoc) {
+    rlEnableVertexArray(batch->mesh.vaoId);
+
+    batch->instanceVbo = rlLoadVertexBuffer(NULL, batch->capacity * (int)sizeof(UnitInstance), true);
+    rlEnableVertexBuffer(batch->instanceVbo);
+
+    rlSetVertexAttribute(colorLoc, 4, RL_UNSIGNED_BYTE, true, sizeof(UnitInstance), offsetof(UnitInstance, color));
+    rlSetVertexAttributeDivisor(colorLoc, 1);
+    rlEnableVertexAttribute(colorLoc);
+
+    rlSetVertexAttribute(flagsLoc, 1, RL_FLOAT, false, sizeof(UnitInstance), offsetof(UnitInstance, flags));
+    rlSetVertexAttributeDivisor(flagsLoc, 1);
+    rlEnableVertexAttribute(flagsLoc);
+
+    rlDisableVertexBuffer();
+    rlDisableVertexArray();
+}
+
+// Function to make room for count instances, returns false if memory ran out
+static bool ReserveInstanceBatch(UnitInstanceBatch *batch, int count, int colorLoc, int flagsLoc) {
+    if (count <= batch->capacity) return true;
+
+    int capacity = (batch->capacity > 0) ? batch->capacity : UNIT_POOL_INITIAL_CAPACITY;
+    while (capacity < count) capacity *= 2;
+
+    Matrix *transforms = (Matrix *)realloc(batch->transforms, sizeof(Matrix) * capacity);
+    if (transforms == NULL) {
+        printf("Failed to allocate %d unit instances\n", capacity);
+        return false;
+    }
+    batch->transforms = transforms;
+
+    UnitInstance *instances = (UnitInstance *)realloc(batch->instances, sizeof(UnitInstance) * capacity);
+    if (instances == NULL) {
+        printf("Failed to allocate %d unit instances\n", capacity);
+        return false;
+    }
+    batch->instances = instances;
+    batch->capacity = capacity;
+
+    // Buffer storage cannot grow in place, replace it and re-point the attributes
+    if (batch->instanceVbo != 0) rlUnloadVertexBuffer(batch->instanceVbo);
+    LoadInstanceBuffer(batch, colorLoc, flagsLoc);
+
+    return true;
+}
+
+// Function to append one instance (capacity must already be reserved)
+static void PushInstance(UnitInstanceBatch *batch, Matrix transform, Color color, float flags) {
+    batch->transforms[batch->count] = transform;
+    batch->instances[batch->count] = (UnitInstance){ color, flags };
+    batch->count++;
+}
+
+// Function to build the transform of an axis-aligned cube
+static Matrix GetCubeTransform(Vector3 center, float size) {
+    return (Matrix){
+        size, 0.0f, 0.0f, center.x,
+        0.0f, size, 0.0f, center.y,
+        0.0f, 0.0f, size, center.z,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+}
+
+// Function to stretch the unit cube into a thin box from start to end, returns false for zero length
+static bool GetSegmentTransform(Vector3 start, Vector3 end, float thickness, Matrix *transform) {
+    Vector3 axis = { end.x - start.x, end.y - start.y, end.z - start.z };
+    float length = sqrtf(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    if (length < 1e-6f) return false;
+
+    Vector3 dir = { axis.x / length, axis.y / length, axis.z / length };
+    Vector3 up = (fabsf(dir.y) < 0.99f) ? (Vector3){ 0, 1, 0 } : (Vector3){ 1, 0, 0 };
+
+    // side = normalize(dir x up), normal = side x dir, both scaled to the thickness
+    Vector3 side = { dir.y * up.z - dir.z * up.y, dir.z * up.x - dir.x * up.z, dir.x * up.y - dir.y * up.x };
+    float sideLength = sqrtf(side.x * side.x + side.y * side.y + side.z * side.z);
+    side = (Vector3){ side.x / sideLength, side.y / sideLength, side.z / sideLength };
+    Vector3 normal = { side.y * dir.z - side.z * dir.y, side.z * dir.x - side.x * dir.z, side.x * dir.y - side.y * dir.x };
+
+    *transform = (Matrix){
+        axis.x, normal.x * thickness, side.x * thickness, (start.x + end.x) * 0.5f,
+        axis.y, normal.y * thickness, side.y * thickness, (start.y + end.y) * 0.5f,
+        axis.z, normal.z * thickness, side.z * thickness, (start.z + end.z) * 0.5f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    return true;
+}
+
+// Function to upload a batch's instance attributes and draw it
+static void DrawInstanceBatch(const UnitRenderer *renderer, const UnitInstanceBatch *batch) {
+    if (batch->count == 0) return;
+
+    rlUpdateVertexBuffer(batch->instanceVbo, batch->instances, batch->count * (int)sizeof(UnitInstance), 0);
+    DrawMeshInstanced(batch->mesh, renderer->material, batch->transforms, batch->count);
+}
+
+// Function to compile the instancing shader and create the cube meshes
+UnitRenderer LoadUnitRenderer(void) {
+    UnitRenderer renderer = {0};
+
+    Shader shader = LoadShaderFromMemory(unitVertexShader, unitFragmentShader);
+    shader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(shader, "mvp");
+    shader.locs[SHADER_LOC_VERTEX_INSTANCE_TX] = GetShaderLocationAttrib(shader, "instanceTransform");
+    renderer.colorLoc = GetShaderLocationAttrib(shader, "instanceColor");
+    renderer.flagsLoc = GetShaderLocationAttrib(shader, "instanceFlags");
+
+    // A failed compile hands back the default shader, which has none of the instance attributes
+    if (!IsShaderValid(shader) || shader.locs[SHADER_LOC_VERTEX_INSTANCE_TX] < 0 ||
+        renderer.colorLoc < 0 || renderer.flagsLoc < 0) {
+        printf("Failed to load unit instancing shader, drawing units one by one\n");
+        UnloadShader(shader);
+        return renderer;
+    }
+
+    renderer.material = LoadMaterialDefault();
+    renderer.material.shader = shader;
+    renderer.bodies.mesh = GenMeshCube(1.0f, 1.0f, 1.0f);
+    renderer.overlays.mesh = GenMeshCube(1.0f, 1.0f, 1.0f);
+    renderer.ready = true;
+
+    return renderer;
+}
+
+// Function to release a batch
+static void UnloadInstanceBatch(UnitInstanceBatch *batch) {
+    if (batch->instanceVbo != 0) rlUnloadVertexBuffer(batch->instanceVbo);
+    UnloadMesh(batch->mesh);
+    free(batch->transforms);
+    free(batch->instances);
+}
+
+// Function to release the renderer
+void UnloadUnitRenderer(UnitRenderer *renderer) {
+    if (renderer->ready) {
+        UnloadInstanceBatch(&renderer->bodies);
+        UnloadInstanceBatch(&renderer->overlays);
+        UnloadMaterial(renderer->material);  // Also unloads the shader
+    }
+    *renderer = (UnitRenderer){0};
+}
+
+// Function to draw the listed units with two instanced calls
+void DrawUnitsInstanced(UnitRenderer *renderer, const UnitPool *pool, const int *units, int unitCount) {
+    if (!renderer->ready || unitCount == 0) return;
+
+    // Bodies: one per unit; overlays: a direction line per unit, plus outline and command line when selected
+    if (!ReserveInstanceBatch(&renderer->bodies, unitCount, renderer->colorLoc, renderer->flagsLoc) ||
+        !ReserveInstanceBatch(&renderer->overlays, unitCount * 3, renderer->colorLoc, renderer->flagsLoc)) {
+        return;
+    }
+    renderer->bodies.count = 0;
+    renderer->overlays.count = 0;
+
+    for (int k = 0; k < unitCount; k++) {
+        int i = units[k];
+        Vector3 position = pool->drawPosition[i];
+        float size = pool->size[i];
+        float thickness = size * UNIT_RENDER_LINE_WIDTH;
+        bool selected = IsUnitSelected(pool, i);
+        bool hasCommand = HasUnitCommand(pool, i);
+        Matrix line;
+
+        // Change color based on state
+        Color unitColor = pool->color[i];
+        if (selected) {
+            unitColor = hasCommand ? SKYBLUE : LIME;
+        }
+        PushInstance(&renderer->bodies, GetCubeTransform(position, size), unitColor, UNIT_INSTANCE_SOLID_EDGES);
+
+        // Direction indicator
+        Vector3 front = {
+            position.x + cosf(pool->drawRotation[i]) * size,
+            position.y,
+            position.z + sinf(pool->drawRotation[i]) * size
+        };
+        if (GetSegmentTransform(position, front, thickness, &line)) {
+            PushInstance(&renderer->overlays, line, RED, UNIT_INSTANCE_SOLID);
+        }
+
+        // Selection outline and command target line
+        if (selected) {
+            PushInstance(&renderer->overlays, GetCubeTransform(position, size * UNIT_RENDER_OUTLINE_SCALE),
+                         GREEN, UNIT_INSTANCE_EDGES_ONLY);
+
+            if (hasCommand && GetSegmentTransform(position, pool->commandTarget[i], thickness, &line)) {
+                PushInstance(&renderer->overlays, line, Fade(GREEN, 0.3f), UNIT_INSTANCE_SOLID);
+            }
+        }
+    }
+
+    DrawInstanceBatch(renderer, &renderer->bodies);
+
+    // Outline edges on the far side show through the discarded faces, so keep back faces
+    rlDisableBackfaceCulling();
+    DrawInstanceBatch(renderer, &renderer->overlays);
+    rlEnableBackfaceCulling();
+}
+
+// Function to bake the digits of the default font into a single texture
+UnitLabelBatch LoadUnitLabels(void) {
+    UnitLabelBatch labels = {0};
+
+    Image image = GenImageColor(10 * UNIT_LABEL_GLYPH_WIDTH, UNIT_LABEL_GLYPH_HEIGHT, BLANK);
+    for (int d = 0; d < 10; d++) {
+        char text[2] = { (char)('0' + d), '\0' };
+        ImageDrawText(&image, text, d * UNIT_LABEL_GLYPH_WIDTH, 0, UNIT_LABEL_GLYPH_HEIGHT, WHITE);
+    }
+    labels.atlas = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    return labels;
+}
+
+// Function to release the label atlas and buffers
+void UnloadUnitLabels(UnitLabelBatch *labels) {
+    if (labels->atlas.id != 0) UnloadTexture(labels->atlas);
+    free(labels->worldX);  // All float arrays share one allocation
+    free(labels->digit);
+    *labels = (UnitLabelBatch){0};
+}
+
+// Function to make room for count labels plus block padding, returns false if memory ran out
+static bool ReserveUnitLabels(UnitLabelBatch *labels, int count) {
+    int padded = (count + UNIT_LABEL_BLOCK - 1) / UNIT_LABEL_BLOCK * UNIT_LABEL_BLOCK;
+    if (padded <= labels->capacity) return true;
+
+    int capacity = (labels->capacity > 0) ? labels->capacity : UNIT_POOL_INITIAL_CAPACITY;
+    while (capacity < padded) capacity *= 2;
+
+    // Contents are rebuilt every frame, so nothing needs to be copied
+    float *data = (float *)malloc(sizeof(float) * 6 * capacity);
+    int *digit = (int *)malloc(sizeof(int) * capacity);
+    if (data == NULL || digit == NULL) {
+        printf("Failed to allocate %d unit labels\n", capacity);
+        free(data);
+        free(digit);
+        return false;
+    }
+
+    free(labels->worldX);
+    free(labels->digit);
+    labels->worldX = data;
+    labels->worldY = data + capacity;
+    labels->worldZ = data + 2 * capacity;
+    labels->screenX = data + 3 * capacity;
+    labels->screenY = data + 4 * capacity;
+    labels->clipW = data + 5 * capacity;
+    labels->digit = digit;
+    labels->capacity = capacity;
+
+    return true;
+}
+
+// Function to project one block of label anchors to screen space
+// Fixed-size blocks with restrict pointers let the compiler vectorize this at -O2
+static void ProjectLabelBlock(const float *restrict x, const float *restrict y, const float *restrict z,
+                              float *restrict screenX, float *restrict screenY, float *restrict clipW,
+                              Matrix m, float halfWidth, float halfHeight) {
+    for (int i = 0; i < UNIT_LABEL_BLOCK; i++) {
+        float cx = m.m0 * x[i] + m.m4 * y[i] + m.m8 * z[i] + m.m12;
+        float cy = m.m1 * x[i] + m.m5 * y[i] + m.m9 * z[i] + m.m13;
+        float cw = m.m3 * x[i] + m.m7 * y[i] + m.m11 * z[i] + m.m15;
+        float invW = 1.0f / cw;  // Meaningless behind the camera, those are culled on clipW
+
+        screenX[i] = (cx * invW + 1.0f) * halfWidth;
+        screenY[i] = (1.0f - cy * invW) * halfHeight;
+        clipW[i] = cw;
+    }
+}
+
+// Function to draw all group numbers in one textured quad batch
+void DrawUnitLabels(UnitLabelBatch *labels, const UnitPool *pool, const int *units, int unitCount,
+                    Camera3D camera, int width, int height) {
+    if (labels->atlas.id == 0 || unitCount == 0) return;
+    if (!ReserveUnitLabels(labels, unitCount)) return;
+
+    // Gather the anchor above every grouped unit
+    labels->count = 0;
+    for (int k = 0; k < unitCount; k++) {
+        int i = units[k];
+        if (pool->groupId[i] <= 0) continue;
+
+        int n = labels->count++;
+        labels->worldX[n] = pool->drawPosition[i].x;
+        labels->worldY[n] = pool->drawPosition[i].y + pool->size[i];
+        labels->worldZ[n] = pool->drawPosition[i].z;
+        labels->digit[n] = pool->groupId[i] % 10;
+    }
+    if (labels->count == 0) return;
+
+    int padded = (labels->count + UNIT_LABEL_BLOCK - 1) / UNIT_LABEL_BLOCK * UNIT_LABEL_BLOCK;
+    for (int n = labels->count; n < padded; n++) {
+        labels->worldX[n] = labels->worldY[n] = labels->worldZ[n] = 0.0f;
+    }
+
+    // Same projection GetWorldToScreen builds, computed once for all labels
+    Matrix viewProjection = GetCameraViewProjection(camera, (double)width / (double)height);
+
+    for (int n = 0; n < padded; n += UNIT_LABEL_BLOCK) {
+        ProjectLabelBlock(labels->worldX + n, labels->worldY + n, labels->worldZ + n,
+                          labels->screenX + n, labels->screenY + n, labels->clipW + n,
+                          viewProjection, width * 0.5f, height * 0.5f);
+    }
+
+    float glyphU = 1.0f / 10.0f;
+
+    rlSetTexture(labels->atlas.id);
+    rlBegin(RL_QUADS);
+        rlColor4ub(YELLOW.r, YELLOW.g, YELLOW.b, YELLOW.a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+
+        for (int n = 0; n < labels->count; n++) {
+            if (labels->clipW[n] <= 0.0f) continue;
+
+            // Same placement as DrawText at the projected point, offset by (-5, -10)
+            float x = (float)(int)(labels->screenX[n] - 5.0f);
+            float y = (float)(int)(labels->screenY[n] - 10.0f);
+            if (x + UNIT_LABEL_GLYPH_WIDTH < 0.0f || x > width || y + UNIT_LABEL_GLYPH_HEIGHT < 0.0f || y > height) continue;
+
+            float u = labels->digit[n] * glyphU;
+            rlTexCoord2f(u, 0.0f);
+            rlVertex2f(x, y);
+            rlTexCoord2f(u, 1.0f);
+            rlVertex2f(x, y + UNIT_LABEL_GLYPH_HEIGHT);
+            rlTexCoord2f(u + glyphU, 1.0f);
+            rlVertex2f(x + UNIT_LABEL_GLYPH_WIDTH, y + UNIT_LABEL_GLYPH_HEIGHT);
+            rlTexCoord2f(u + glyphU, 0.0f);
+            rlVertex2f(x + UNIT_LABEL_GLYPH_WIDTH, y);
+        }
+    rlEnd();
+    rlSetTexture(0);
+}
@@ -0,0 +1,81 @@
+#ifndef UNITRENDER_H
+#define UNITRENDER_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include "unitpool.h"
+
+// Instanced unit rendering settings
+#define UNIT_RENDER_LINE_WIDTH 0.04f     // Thickness of direction and command lines, relative to unit size
+#define UNIT_RENDER_OUTLINE_SCALE 1.5f   // Selection outline size, relative to unit size
+
+// Group label settings
+#define UNIT_LABEL_GLYPH_WIDTH 8         // Atlas cell of one digit, in pixels
+#define UNIT_LABEL_GLYPH_HEIGHT 10       // Also the font size the digits are baked at
+#define UNIT_LABEL_BLOCK 8               // Labels per step of the projection loop
+
+// Shading mode of an instance, read by the fragment shader
+#define UNIT_INSTANCE_SOLID_EDGES 0.0f   // Filled cube with black edges (unit body)
+#define UNIT_INSTANCE_EDGES_ONLY 1.0f    // Edges only, faces discarded (selection outline)
+#define UNIT_INSTANCE_SOLID 2.0f         // Filled, no edges (direction and command lines)
+
+// Per-instance attributes next to the transform raylib uploads
+typedef struct {
+    Color color;
+    float flags;               // UNIT_INSTANCE_*
+} UnitInstance;
+
+// One DrawMeshInstanced call: a cube mesh with its own instance attribute buffer
+typedef struct {
+    Mesh mesh;
+    unsigned int instanceVbo;  // UnitInstance per instance, attached to the mesh VAO
+    Matrix *transforms;
+    UnitInstance *instances;
+    int count;
+    int capacity;
+} UnitInstanceBatch;
+
+// Draws every unit in two instanced calls: bodies, then outlines and lines
+typedef struct {
+    Material material;         // Default material with the instancing shader
+    int colorLoc;              // Attribute locations of the UnitInstance fields
+    int flagsLoc;
+    UnitInstanceBatch bodies;
+    UnitInstanceBatch overlays;
+    bool ready;                // False when the shader failed, callers fall back to DrawUnit
+} UnitRenderer;
+
+// Group numbers of every labeled unit, projected together and drawn as one textured batch
+typedef struct {
+    Texture2D atlas;           // Digits 0-9 in a row, white on transparent, tinted when drawn
+    float *worldX;             // Label anchor above each labeled unit, padded to a whole block
+    float *worldY;
+    float *worldZ;
+    float *screenX;            // Projected anchor, valid where clipW > 0
+    float *screenY;
+    float *clipW;
+    int *digit;
+    int count;
+    int capacity;              // Multiple of UNIT_LABEL_BLOCK
+} UnitLabelBatch;
+
+// Compile the instancing shader and create the cube meshes (requires an open window)
+UnitRenderer LoadUnitRenderer(void);
+
+// Release GPU and CPU resources
+void UnloadUnitRenderer(UnitRenderer *renderer);
+
+// Fill the instance buffers from the listed units and draw them (call inside BeginMode3D)
+void DrawUnitsInstanced(UnitRenderer *renderer, const UnitPool *pool, const int *units, int unitCount);
+
+// Bake the digit atlas (requires an open window)
+UnitLabelBatch LoadUnitLabels(void);
+
+// Release the atlas and label buffers
+void UnloadUnitLabels(UnitLabelBatch *labels);
+
+// Draw the group number of every listed grouped unit that is on screen (call after EndMode3D)
+void DrawUnitLabels(UnitLabelBatch *labels, const UnitPool *pool, const int *units, int unitCount,
+                    Camera3D camera, int width, int height);
+
+#endif // UNITRENDER_H